@@ -0,0 +1,142 @@
+/*
+ *  GECO — Grid Engine Cgroup Orchestrator
+ *  exec-overhead-test.c
+ *  
+ *  Standalone program that benchmarks the cost of fork/exec/wait with and
+ *  without the GECO LD_PRELOAD library in the child's environment.
+ *
+ *  Copyright © 2015
+ *  Dr. Jeffrey Frey, University of Delaware
+ *
+ *  $Id$
+ */
+
+#include "GECO.h"
+#include <sys/wait.h>
+
+//
+
+#ifndef EXECOVERHEADTEST_DEFAULT_COUNT
+#define EXECOVERHEADTEST_DEFAULT_COUNT    1000
+#endif
+
+//
+// By default the child is a shell that exec's /bin/true, so with the preload
+// in place both the library load and the wrapped execve() are measured:
+//
+static char *const execoverheadtest_default_argv[] = { "/bin/sh", "-c", "exec /bin/true", NULL };
+
+//
+
+double
+execoverheadtest_elapsed(
+  struct timespec   *t0,
+  struct timespec   *t1
+)
+{
+  return (t1->tv_sec - t0->tv_sec) + 1e-9 * (t1->tv_nsec - t0->tv_nsec);
+}
+
+//
+
+char**
+execoverheadtest_environment(
+  const char        *preloadPath
+)
+{
+  extern char       **environ;
+  char              **env, **p = environ;
+  int               count = 0, i = 0;
+  
+  while ( *p++ ) count++;
+  env = malloc((count + 2) * sizeof(char*));
+  if ( env ) {
+    p = environ;
+    while ( *p ) {
+      if ( strncmp(*p, "LD_PRELOAD=", 11) ) env[i++] = *p;
+      p++;
+    }
+    if ( preloadPath ) env[i++] = GECO_apathcatm("LD_PRELOAD=", preloadPath, NULL);
+    env[i] = NULL;
+  }
+  return env;
+}
+
+//
+
+bool
+execoverheadtest_run(
+  const char        *label,
+  long int          count,
+  char *const       *argv,
+  char *const       *envp,
+  double            *perExec
+)
+{
+  struct timespec   t0, t1;
+  long int          i;
+  
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for ( i = 0; i < count; i++ ) {
+    pid_t           child = fork();
+    int             status;
+    
+    if ( child == 0 ) {
+      execve(argv[0], argv, envp);
+      _exit(127);
+    }
+    if ( child < 0 ) {
+      fprintf(stderr, "ERROR:  fork failed (errno = %d)\n", errno);
+      return false;
+    }
+    if ( (waitpid(child, &status, 0) != child) || ! WIFEXITED(status) || (WEXITSTATUS(status) != 0) ) {
+      fprintf(stderr, "ERROR:  child %s exited abnormally (status = %d)\n", argv[0], status);
+      return false;
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  *perExec = 1e6 * execoverheadtest_elapsed(&t0, &t1) / count;
+  printf("%-12s %8ld execs %10.2lf us/exec\n", label, count, *perExec);
+  return true;
+}
+
+//
+
+int
+main(
+  int         argc,
+  char        **argv
+)
+{
+  long int              count = EXECOVERHEADTEST_DEFAULT_COUNT;
+  const char            *preloadPath;
+  char *const           *childArgv = execoverheadtest_default_argv;
+  char                  **plainEnv, **preloadEnv;
+  double                plain, preload;
+  
+  if ( (argc < 2) || ((argc > 2) && (! GECO_strtol(argv[2], &count, NULL) || (count <= 0))) ) {
+    fprintf(stderr, "usage:\n\n  %s <preload-library> {<exec-count> {<command> {<arg> ..}}}\n\n  (default exec count is %d, default command is %s %s '%s')\n\n",
+        argv[0], EXECOVERHEADTEST_DEFAULT_COUNT,
+        execoverheadtest_default_argv[0], execoverheadtest_default_argv[1], execoverheadtest_default_argv[2]
+      );
+    return EINVAL;
+  }
+  preloadPath = argv[1];
+  if ( argc > 3 ) childArgv = argv + 3;
+  
+  plainEnv = execoverheadtest_environment(NULL);
+  preloadEnv = execoverheadtest_environment(preloadPath);
+  if ( ! plainEnv || ! preloadEnv ) {
+    fprintf(stderr, "ERROR:  unable to allocate child environment\n");
+    return ENOMEM;
+  }
+  
+  // One untimed round of each to warm the page cache:
+  if ( ! execoverheadtest_run("warmup", 1, childArgv, plainEnv, &plain) || ! execoverheadtest_run("warmup", 1, childArgv, preloadEnv, &preload) ) return 1;
+  
+  if ( ! execoverheadtest_run("no-preload", count, childArgv, plainEnv, &plain) ) return 1;
+  if ( ! execoverheadtest_run("preload", count, childArgv, preloadEnv, &preload) ) return 1;
+  printf("%-12s %25.2lf us/exec\n", "overhead", preload - plain);
+  
+  return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ *  GECO — Grid Engine Cgroup Orchestrator
+ *  geco-preload-compile.c
+ *  
+ *  Standalone program that compiles the LD_PRELOAD library's configuration
+ *  file into the binary form the library memory-maps at startup
+ *
+ *  Copyright © 2015
+ *  Dr. Jeffrey Frey, University of Delaware
+ *
+ *  $Id$
+ */
+
+#include "GECOPreloadConfig.h"
+#include "GECOLog.h"
+#include <getopt.h>
+
+const struct option geco_cli_options[] = {
+                  { "help",                 no_argument,          NULL,         'h' },
+                  { "verbose",              no_argument,          NULL,         'v' },
+                  { "quiet",                no_argument,          NULL,         'q' },
+                  { "config",               required_argument,    NULL,         'c' },
+                  { "output",               required_argument,    NULL,         'o' },
+                  { "print",                no_argument,          NULL,         'p' },
+                  { NULL,                   0,                    0,             0  }
+                };
+
+//
+
+void
+usage(
+  const char    *exe
+)
+{
+  printf(
+      "usage:\n\n"
+      "  %s {options}\n\n"
+      " options:\n\n"
+      "  -h/--help                    show this information\n"
+      "  -v/--verbose                 increase the verbosity level (may be used\n"
+      "                                 multiple times)\n"
+      "  -q/--quiet                   decrease the verbosity level (may be used\n"
+      "                                 multiple times)\n"
+      "  -c/--config [path]           read configuration from the given file\n"
+      "                                 (default: %s/%s)\n"
+      "  -o/--output [path]           write the compiled configuration to the\n"
+      "                                 given file (default: %s/%s)\n"
+      "  -p/--print                   display a summary of the compiled file after\n"
+      "                                 it has been written\n"
+      "\n"
+      " $Id$\n"
+      "\n"
+      ,
+      exe,
+      GECODirectoryEtc, GECOPreloadConfigFileName,
+      GECODirectoryEtc, GECOPreloadConfigCompiledFileName
+    );
+}
+
+//
+////
+//
+
+int
+main(
+  int         argc,
+  char        **argv
+)
+{
+  const char                  *exe = argv[0];
+  int                         optch;
+  
+  const char                  *configPath = NULL;
+  const char                  *outputPath = NULL;
+  bool                        shouldPrint = false;
+  GECOPreloadConfig           config;
+  
+  // Check for arguments:
+  while ( (optch = getopt_long(argc, argv, "hvqc:o:p", geco_cli_options, NULL)) != -1 ) {
+    switch ( optch ) {
+      
+      case 'h':
+        usage(exe);
+        exit(0);
+      
+      case 'v':
+        GECOLogIncLevel(GECOLogGetDefault());
+        break;
+      
+      case 'q':
+        GECOLogDecLevel(GECOLogGetDefault());
+        break;
+      
+      case 'c':
+        if ( optarg && *optarg ) {
+          configPath = optarg;
+        } else {
+          fprintf(stderr, "ERROR:  no path provided with -c/--config option\n");
+          return EINVAL;
+        }
+        break;
+      
+      case 'o':
+        if ( optarg && *optarg ) {
+          outputPath = optarg;
+        } else {
+          fprintf(stderr, "ERROR:  no path provided with -o/--output option\n");
+          return EINVAL;
+        }
+        break;
+      
+      case 'p':
+        shouldPrint = true;
+        break;
+    
+    }
+  }
+  if ( ! configPath ) {
+    configPath = GECO_apathcatm(GECODirectoryEtc, GECOPreloadConfigFileName, NULL);
+    if ( ! configPath ) {
+      GECO_ERROR("failure in GECO_apathcatm()");
+      return ENOMEM;
+    }
+  }
+  if ( ! outputPath ) {
+    outputPath = GECO_apathcatm(GECODirectoryEtc, GECOPreloadConfigCompiledFileName, NULL);
+    if ( ! outputPath ) {
+      GECO_ERROR("failure in GECO_apathcatm()");
+      return ENOMEM;
+    }
+  }
+  
+  GECOPreloadConfigInitDefaults(&config);
+  if ( ! GECOPreloadConfigParseFile(&config, configPath) ) {
+    GECO_ERROR("unable to parse configuration file %s (errno = %d)", configPath, errno);
+    return errno;
+  }
+  if ( ! GECOPreloadConfigWriteCompiledFile(&config, outputPath) ) {
+    GECO_ERROR("unable to write compiled configuration file %s (errno = %d)", outputPath, errno);
+    return errno;
+  }
+  GECO_INFO("compiled %s to %s", configPath, outputPath);
+  
+  if ( shouldPrint ) {
+    GECOPreloadConfig         compiled;
+    
+    GECOPreloadConfigInitDefaults(&compiled);
+    if ( ! GECOPreloadConfigMapCompiledFile(&compiled, outputPath, NULL) ) {
+      GECO_ERROR("unable to read back compiled configuration file %s (errno = %d)", outputPath, errno);
+      return EINVAL;
+    }
+    GECOPreloadConfigSummarizeToStream(&compiled, stdout);
+  }
+  
+  return 0;
+}
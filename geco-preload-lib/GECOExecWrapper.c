@@ -15,8 +15,7 @@
 #include "GECOLog.h"
 #include "GECOIntegerSet.h"
 #include "GECOQuarantine.h"
-
-#include "confuse.h"
+#include "GECOPreloadConfig.h"
 
 #include <signal.h>
 #include <pwd.h>
@@ -91,7 +90,7 @@ static const char         *GECODDefaultQuarantineSocket = GECOD_QUARANTINE_SOCKE
 
 static bool               GECOExecWrapperIsInited = false;
 
-static cfg_bool_t         GECOExecWrapperShouldQuarantineSSH = cfg_true;
+static bool               GECOExecWrapperShouldQuarantineSSH = true;
 
 static GECOIntegerSetRef  GECOExecWrapperAllowedUids = NULL;
 static GECOIntegerSetRef  GECOExecWrapperAllowedGids = NULL;
@@ -139,6 +138,98 @@ GECOExecWrapperReadCommForPid(
 
 //
 
+typedef enum {
+  GECOExecWrapperProcessCommSGEExecd = 0,
+  GECOExecWrapperProcessCommSGEShepherd,
+  GECOExecWrapperProcessCommSSHD,
+  GECOExecWrapperProcessCommUnhandled
+} GECOExecWrapperProcessComm;
+
+const char* GECOExecWrapperProcessCommString[] = {
+                  "sge_execd",
+                  "sge_shepherd",
+                  "sshd"
+                };
+
+GECOExecWrapperProcessComm
+GECOExecWrapperProcessCommForName(
+  const char          *name,
+  size_t              nameLen
+)
+{
+  GECOExecWrapperProcessComm      procComm = GECOExecWrapperProcessCommSGEShepherd;
+  
+  while ( procComm < GECOExecWrapperProcessCommUnhandled ) {
+    if ( (nameLen == strlen(GECOExecWrapperProcessCommString[procComm])) && (strncmp(name, GECOExecWrapperProcessCommString[procComm], nameLen) == 0) ) break;
+    procComm++;
+  }
+  return procComm;
+}
+
+//
+
+GECOExecWrapperProcessComm
+GECOExecWrapperProcessCommForPid(
+  pid_t               aPid
+)
+{
+  GECOExecWrapperProcessComm      procComm = GECOExecWrapperProcessCommUnhandled;
+  char                            comm[64];
+  int                             commFd;
+  
+  snprintf(comm, sizeof(comm), "/proc/%ld/comm", (long int)aPid);
+  commFd = open(comm, O_RDONLY);
+  if ( commFd >= 0 ) {
+    ssize_t             count = read(commFd, comm, sizeof(comm));
+    
+    close(commFd);
+    if ( count > 0 ) {
+      char              *s = comm + ( (count < sizeof(comm)) ? count : --count );
+      
+      *s = '\0';
+      while ( isspace(*(--s)) ) {
+        *s = '\0';
+        count--;
+      }
+      
+      procComm = GECOExecWrapperProcessCommForName(comm, count);
+    }
+  }
+  return procComm;
+}
+
+//
+
+static pid_t                      GECOExecWrapperParentPid = -1;
+static GECOExecWrapperProcessComm GECOExecWrapperParentComm = GECOExecWrapperProcessCommUnhandled;
+
+GECOExecWrapperProcessComm
+GECOExecWrapperProcessCommForParent(void)
+{
+  pid_t         ppid = getppid();
+  
+  // The parent can only change if we're reparented, so repeat lookups are
+  // answered from the cache:
+  if ( ppid != GECOExecWrapperParentPid ) {
+    GECOExecWrapperParentComm = GECOExecWrapperProcessCommForPid(ppid);
+    GECOExecWrapperParentPid = ppid;
+  }
+  return GECOExecWrapperParentComm;
+}
+
+//
+
+const char*
+GECOExecWrapperReadCommForParent(void)
+{
+  GECOExecWrapperProcessComm    procComm = GECOExecWrapperProcessCommForParent();
+  
+  if ( procComm != GECOExecWrapperProcessCommUnhandled ) return GECOExecWrapperProcessCommString[procComm];
+  return GECOExecWrapperReadCommForPid(getppid());
+}
+
+//
+
 GECOLogRef
 GECOExecWrapperOpenLogFile(
   const char      *commName
@@ -158,7 +249,7 @@ GECOExecWrapperOpenLogFile(
         }
         else if ( strncmp(s, "${PARENT_COMMAND}", strlen("${PARENT_COMMAND}")) == 0 ) {
           s += strlen("${PARENT_COMMAND}");
-          const char    *parentCommand = GECOExecWrapperReadCommForPid(getppid());
+          const char    *parentCommand = GECOExecWrapperReadCommForParent();
           
           if ( parentCommand ) {
             pathLen += snprintf(path + pathLen, sizeof(path) - pathLen, "%s", parentCommand);
@@ -238,165 +329,68 @@ GECOExecWrapperIsGidWhitelisted(
   return ( GECOExecWrapperAllowedGids && GECOIntegerSetContains(GECOExecWrapperAllowedGids, theGid) ) ? true : false;
 }
 
-//
-
-int
-__GECOExecWrapperCfgParseLogLevelCallback(
-  cfg_t       *cfg,
-  cfg_opt_t   *opt,
-  const char  *value,
-  void        *result
+static inline bool
+GECOExecWrapperIsAnyGidWhitelisted(
+  int       ngroups,
+  gid_t     *groupList,
+  gid_t     *theGid
 )
 {
-  long int    *outValue = (long int*)result;
+  GECOIntegerSetRef   groupSet;
+  bool                rc = false;
   
-  if ( (*value == '\0') || (strcasecmp(value, "NONE") == 0) )
-    *outValue = GECOLogLevelQuiet;
-  else if ( strcasecmp(value, "ERROR") == 0 )
-    *outValue = GECOLogLevelError;
-  else if ( strcasecmp(value, "WARN") == 0 )
-    *outValue = GECOLogLevelWarn;
-  else if ( strcasecmp(value, "INFO") == 0 )
-    *outValue = GECOLogLevelInfo;
-  else if ( strcasecmp(value, "DEBUG") == 0 )
-    *outValue = GECOLogLevelDebug;
-  else
-    return -1;
+  if ( GECOExecWrapperAllowedGids && (ngroups > 0) && (groupSet = GECOIntegerSetCreateWithCapacity(ngroups)) ) {
+    GECOInteger       commonGid;
     
-  return 0;
+    while ( ngroups-- > 0 ) GECOIntegerSetAddInteger(groupSet, (GECOInteger)groupList[ngroups]);
+    if ( (rc = GECOIntegerSetIntersectsAny(GECOExecWrapperAllowedGids, groupSet, &commonGid)) && theGid ) *theGid = (gid_t)commonGid;
+    GECOIntegerSetDestroy(groupSet);
+  }
+  return rc;
 }
 
+//
+// Configuration is loaded on demand by GECOExecWrapperQuarantine() rather
+// than when the library is loaded:  only exec's whose parent is one of the
+// daemons we care about ever need it.
+//
+
 bool
 GECOExecWrapperInit(void)
 {
-  char                path[PATH_MAX];
-  int                 pathLen;
+  char                path[PATH_MAX], compiledPath[PATH_MAX];
+  int                 pathLen, compiledPathLen;
+  GECOPreloadConfig   config;
   
-  cfg_opt_t           cfg_logging_opts[] = {
-                          CFG_STR("path", NULL, CFGF_NODEFAULT),
-                          CFG_INT_CB("level", GECOLogLevelQuiet, CFGF_NONE, __GECOExecWrapperCfgParseLogLevelCallback),
-                          CFG_INT("mode", 0644, CFGF_NONE),
-                          CFG_END()
-                        };
-  cfg_opt_t           cfg_whitelist_opts[] = {
-                          CFG_INT_LIST("uids", NULL, CFGF_NODEFAULT ),
-                          CFG_INT_LIST("gids", NULL, CFGF_NODEFAULT ),
-                          CFG_END()
-                        };
-  cfg_opt_t           cfg_quarantine_opts[] = {
-                          CFG_STR("socket", (char*)GECODDefaultQuarantineSocket, CFGF_NONE ),
-                          CFG_INT("send_timeout", 60, CFGF_NONE ),
-                          CFG_INT("recv_timeout", 60, CFGF_NONE ),
-                          CFG_INT("retry", 2, CFGF_NONE ),
-                          CFG_END()
-                        };
-  cfg_opt_t           cfg_opts[] = {
-                          CFG_SEC("whitelist", cfg_whitelist_opts, CFGF_NONE ),
-                          CFG_SEC("quarantine", cfg_quarantine_opts, CFGF_NONE ),
-                          CFG_INT("sge_execd_uid", -1, CFGF_NODEFAULT),
-                          CFG_SEC("logging", cfg_logging_opts, CFGF_NONE),
-                        	CFG_SIMPLE_BOOL("enable_sshd_quarantine", &GECOExecWrapperShouldQuarantineSSH),
-                          CFG_END()
-                        };
-  GECOIntegerSetRef   uidSet = NULL, gidSet = NULL;
+  if ( GECOExecWrapperIsInited ) return true;
   
   GECOExecWrapperTmpDebug("%d:%d enter\n", getpid(), getppid());
   
-  // Create uid/gid allow sets:
-  if ( ! (uidSet = GECOIntegerSetCreate()) ) {
-    errno = ENOMEM;
-    return false;
-  }
-  GECOExecWrapperTmpDebug("%d:%d uidset created\n", getpid(), getppid());
-  if ( ! (gidSet = GECOIntegerSetCreate()) ) {
-    errno = ENOMEM;
-    GECOIntegerSetDestroy(uidSet);
+  GECOPreloadConfigInitDefaults(&config);
+  pathLen = snprintf(path, sizeof(path), "%s/%s", GECODirectoryEtc, GECOPreloadConfigFileName);
+  compiledPathLen = snprintf(compiledPath, sizeof(compiledPath), "%s/%s", GECODirectoryEtc, GECOPreloadConfigCompiledFileName);
+  
+  //
+  // Prefer the compiled configuration (one open and mmap, pages shared by every
+  // process on the node) and fall back to parsing the text file:
+  //
+  if ( (compiledPathLen > 0) && (compiledPathLen < sizeof(compiledPath)) && GECOPreloadConfigMapCompiledFile(&config, compiledPath, ((pathLen > 0) && (pathLen < sizeof(path))) ? path : NULL) ) {
+    GECOExecWrapperTmpDebug("%d:%d mapped %s\n", getpid(), getppid(), compiledPath);
+  } else if ( ! GECOPreloadConfigParseFile(&config, ((pathLen > 0) && (pathLen < sizeof(path))) ? path : NULL) ) {
     return false;
   }
-
-  GECOExecWrapperTmpDebug("%d:%d gidset created\n", getpid(), getppid());
-  GECOIntegerSetAddIntegerRange(uidSet, 0, 499);
-  GECOIntegerSetAddIntegerRange(gidSet, 0, 499);
-  
-  // Check for our configuration file:
-  pathLen = snprintf(path, sizeof(path), "%s/geco-preload-lib.conf", GECODirectoryEtc);
-  if ( pathLen > 0 && pathLen < sizeof(path) && GECOIsFile(path) ) {
-    cfg_t               *cfg = cfg_init(cfg_opts, CFGF_NONE);
-    
-    if ( cfg ) {
-      int               rc = cfg_parse(cfg, path);
-      
-      if ( rc == CFG_SUCCESS ) {
-        unsigned int    i, iMax;
-        long int        v;
-        
-        // Add any whitelisted uids/gids:
-        cfg_t           *whitelistCfg = cfg_getsec(cfg, "whitelist");
-        
-        if ( whitelistCfg ) {
-          i = 0; iMax = cfg_size(whitelistCfg, "uids");
-          while ( i < iMax ) {
-            GECOExecWrapperTmpDebug("%d added to uidset\n", cfg_getnint(whitelistCfg, "uids", i));
-            GECOIntegerSetAddInteger(uidSet, cfg_getnint(whitelistCfg, "uids", i++));
-          }
-          
-          // Add any whitelisted gids that were specified:
-          i = 0; iMax = cfg_size(whitelistCfg, "gids");
-          while ( i < iMax ) {
-            GECOExecWrapperTmpDebug("%d added to gidset\n", cfg_getnint(whitelistCfg, "gids", i));
-            GECOIntegerSetAddInteger(gidSet, cfg_getnint(whitelistCfg, "gids", i++));
-          }
-        }
-        
-        // Quarantine items::
-        cfg_t           *quarantineCfg = cfg_getsec(cfg, "quarantine");
-        
-        if ( quarantineCfg ) {
-          char          *socketAddr = cfg_getstr(quarantineCfg, "socket");
-          
-          if ( socketAddr ) GECOExecWrapperQuarantineSocketAddr = strdup(socketAddr);
-          
-          v = cfg_getint(quarantineCfg, "send_timeout");
-          if ( v >= 0 && v < UINT_MAX ) GECOExecWrapperQuarantineSendTimeout = v;
-          
-          v = cfg_getint(quarantineCfg, "recv_timeout");
-          if ( v >= 0 && v < UINT_MAX ) GECOExecWrapperQuarantineRecvTimeout = v;
-          
-          v = cfg_getint(quarantineCfg, "retry");
-          if ( v >= 0 && v < UINT_MAX ) GECOExecWrapperQuarantineRetryCount = v;
-        }
-        
-        // What uid is sge_execd expected to run as?
-        if ( (v = cfg_getint(cfg, "sge_execd_uid")) >= 0 ) {
-          if ( v < INT_MAX ) GECOExecWrapperExecdUser = v;
-        }
-        
-        // Should we setup some logging?
-        cfg_t           *loggingCfg = cfg_getsec(cfg, "logging");
-        
-        if ( loggingCfg ) {
-          GECOLogLevel  logLevel = cfg_getint(loggingCfg, "level");
-          
-          if ( logLevel > GECOLogLevelQuiet ) {
-            GECOExecWrapperLogLevel = logLevel;
-            
-            // Check for a file path format string:
-            char        *pathFormat = cfg_getstr(loggingCfg, "path");
-            
-            if ( pathFormat && *pathFormat && (strcasecmp(pathFormat, ":stderr:") != 0) ) {
-              GECOExecWrapperLogPathFormat = strdup(pathFormat);
-              
-              GECOExecWrapperLogFileModeMask = cfg_getint(loggingCfg, "mode");
-            }
-          }
-        }
-      }
-      cfg_free(cfg);
-    }
-  }
   
-  GECOExecWrapperAllowedUids = GECOIntegerSetCreateConstantCopy(uidSet); GECOIntegerSetDestroy(uidSet);
-  GECOExecWrapperAllowedGids = GECOIntegerSetCreateConstantCopy(gidSet); GECOIntegerSetDestroy(gidSet);
+  GECOExecWrapperShouldQuarantineSSH = config.shouldQuarantineSSH;
+  if ( (config.execdUid >= 0) && (config.execdUid < INT_MAX) ) GECOExecWrapperExecdUser = config.execdUid;
+  GECOExecWrapperLogLevel = config.logLevel;
+  GECOExecWrapperLogFileModeMask = config.logFileModeMask;
+  GECOExecWrapperLogPathFormat = config.logPathFormat;
+  GECOExecWrapperQuarantineSocketAddr = config.quarantineSocketAddr;
+  GECOExecWrapperQuarantineSendTimeout = config.quarantineSendTimeout;
+  GECOExecWrapperQuarantineRecvTimeout = config.quarantineRecvTimeout;
+  GECOExecWrapperQuarantineRetryCount = config.quarantineRetryCount;
+  GECOExecWrapperAllowedUids = config.allowedUids;
+  GECOExecWrapperAllowedGids = config.allowedGids;
   
   GECOExecWrapperIsInited = true;
   
@@ -507,51 +501,73 @@ GECOExecWrapperEnvironmentRemoveLDPRELOAD(
 
 //
 
-typedef enum {
-  GECOExecWrapperProcessCommSGEExecd = 0,
-  GECOExecWrapperProcessCommSGEShepherd,
-  GECOExecWrapperProcessCommSSHD,
-  GECOExecWrapperProcessCommUnhandled
-} GECOExecWrapperProcessComm;
-
-const char* GECOExecWrapperProcessCommString[] = {
-                  "sge_execd",
-                  "sge_shepherd",
-                  "sshd"
-                };
-
-GECOExecWrapperProcessComm
-GECOExecWrapperProcessCommForPid(
-  pid_t               aPid
+bool
+GECOExecWrapperQuarantineJobStarted(
+  long int            jobId,
+  long int            taskId
 )
 {
-  GECOExecWrapperProcessComm      procComm = GECOExecWrapperProcessCommUnhandled;
-  char                            comm[64];
-  int                             commFd;
-  
-  snprintf(comm, sizeof(comm), "/proc/%ld/comm", (long int)aPid);
-  commFd = open(comm, O_RDONLY);
-  if ( commFd >= 0 ) {
-    ssize_t             count = read(commFd, comm, sizeof(comm));
+  GECOQuarantineSocket  theSocket;
+  bool                  rc;
+  
+  GECOQuarantineSocketInitWithFd(-1, &theSocket);
+  rc = GECOQuarantineSocketOpenClient(
+              GECOQuarantineSocketTypeInferred,
+              ( GECOExecWrapperQuarantineSocketAddr ? GECOExecWrapperQuarantineSocketAddr : GECODDefaultQuarantineSocket ),
+              GECOExecWrapperQuarantineRetryCount,
+              GECOExecWrapperQuarantineRecvTimeout,
+              GECOExecWrapperQuarantineSendTimeout,
+              &theSocket
+            );
+  if ( rc ) {
+    GECOQuarantineCommandRef  quarantineCommand = GECOQuarantineCommandJobStartedCreate(jobId, taskId, getpid());
     
-    close(commFd);
-    if ( count > 0 ) {
-      char              *s = comm + ( (count < sizeof(comm)) ? count : --count );
-      
-      *s = '\0';
-      while ( isspace(*(--s)) ) {
-        *s = '\0';
-        count--;
-      }
-      
-      procComm = GECOExecWrapperProcessCommSGEShepherd;
-      while ( procComm < GECOExecWrapperProcessCommUnhandled ) {
-        if ( (count == strlen(GECOExecWrapperProcessCommString[procComm])) && (strncmp(comm, GECOExecWrapperProcessCommString[procComm], count) == 0) ) break;
-        procComm++;
+    if ( quarantineCommand ) {
+      rc = GECOQuarantineSocketSendCommand(&theSocket, quarantineCommand);
+      GECOQuarantineCommandDestroy(quarantineCommand);
+      quarantineCommand = NULL;
+      if ( rc ) {
+        rc = GECOQuarantineSocketRecvCommand(&theSocket, &quarantineCommand);
+        if ( rc ) {
+          if ( GECOQuarantineCommandGetCommandId(quarantineCommand) == GECOQuarantineCommandIdAckJobStarted ) {
+            long int      ackJobId = GECOQuarantineCommandAckJobStartedGetJobId(quarantineCommand);
+            long int      ackTaskId = GECOQuarantineCommandAckJobStartedGetTaskId(quarantineCommand);
+            
+            if ( ackJobId == jobId && ackTaskId == taskId ) {
+              rc = GECOQuarantineCommandAckJobStartedGetSuccess(quarantineCommand);
+              GECO_INFO("Received acknowledgement from gecod:  job %ld.%ld (pid %ld) was%s quarantined",
+                    jobId, taskId, (long int)getpid(),
+                    ( rc ? "" : " not" )
+                  );
+            } else {
+              GECO_ERROR("Expected job-started acknowledgement for %ld.%ld (pid %ld), got acknowledgement for %ld.%ld", jobId, taskId, (long int)getpid(), ackJobId, ackTaskId);
+              rc = false;
+            }
+          } else {
+            GECO_ERROR("Expected job-started acknowledgement for %ld.%ld (pid %ld), got wrong command (%u) from server", jobId, taskId, (long int)getpid(),
+                GECOQuarantineCommandGetCommandId(quarantineCommand)
+              );
+            rc = false;
+          }
+        } else {
+          GECO_ERROR("Failed to receive job-started acknowledgement for %ld.%ld (pid %ld)", jobId, taskId, (long int)getpid());
+        }
+        GECOQuarantineCommandDestroy(quarantineCommand);
+      } else {
+        GECO_ERROR("Failed to send job-started quarantine command for %ld.%ld (pid %ld) (errno = %d)", jobId, taskId, (long int)getpid(), errno);
       }
+    } else {
+      GECO_ERROR("Could not create job-started quarantine command for %ld.%ld (pid %ld)", jobId, taskId, (long int)getpid());
+      rc = false;
     }
+  } else {
+    GECO_ERROR("Could not open client socket '%s' to perform quarantine operations for %ld.%ld (pid %ld)",
+        ( GECOExecWrapperQuarantineSocketAddr ? GECOExecWrapperQuarantineSocketAddr : GECODDefaultQuarantineSocket ),
+        jobId, taskId, (long int)getpid()
+      );
   }
-  return procComm;
+  if ( theSocket.socketFd >= 0 ) GECOQuarantineSocketClose(&theSocket);
+  return rc;
 }
 
 //
@@ -563,10 +579,15 @@ GECOExecWrapperQuarantine(
   char *const         **outEnvP
 )
 {
-  if ( ! GECOExecWrapperIsInited ) exit(EINVAL);
+  // What kind of process was my parent?  The vast majority of exec's do not
+  // descend from a daemon we care about, so they're whitelisted before any
+  // configuration or logging is loaded:
+  GECOExecWrapperProcessComm    parentCommand = GECOExecWrapperProcessCommForParent();
+  
+  if ( parentCommand == GECOExecWrapperProcessCommUnhandled ) return true;
+  if ( ! GECOExecWrapperInit() ) exit(EINVAL);
   
   // Isolate the basename of the command we wish to exec:
-  GECOExecWrapperProcessComm    parentCommand = GECOExecWrapperProcessCommForPid(getppid());
   long int                      jobId = GECOUnknownJobId, taskId = GECOUnknownJobId;
   const char                    *nextCommand = nextExec + strlen(nextExec);
   
@@ -582,7 +603,6 @@ GECOExecWrapperQuarantine(
   GECOLogRef                    defaultLog = NULL;
   bool                          rc = false;
   
-  // What kind of process was my parent?
   switch ( parentCommand ) {
     
     case GECOExecWrapperProcessCommSGEExecd: {
@@ -637,7 +657,7 @@ GECOExecWrapperQuarantine(
       rc = true;
       
       // Are we doing quarantine?
-      if ( GECOExecWrapperShouldQuarantineSSH != cfg_true ) {
+      if ( ! GECOExecWrapperShouldQuarantineSSH ) {
         GECO_DEBUG("sshd quarantine is disabled");
         goto early_exit;
       }
@@ -663,13 +683,11 @@ GECOExecWrapperQuarantine(
         if ( (getgrouplist(passwdRec->pw_name, passwdRec->pw_gid, NULL, &ngroups) == -1) && (ngroups > 1) ) {
           gid_t         groupList[ngroups];
           
-          if ( getgrouplist(passwdRec->pw_name, passwdRec->pw_gid, groupList, &ngroups) != -1 ) {
-            while ( ngroups-- > 0 ) {
-              if ( GECOExecWrapperIsGidWhitelisted(groupList[ngroups]) ) {
-                GECO_INFO("sshd running as uid(%d) is member of whitelisted gid(%d)", getuid(), groupList[ngroups]);
-                goto early_exit;
-              }
-            }
+          gid_t         whitelistedGid;
+          
+          if ( (getgrouplist(passwdRec->pw_name, passwdRec->pw_gid, groupList, &ngroups) != -1) && GECOExecWrapperIsAnyGidWhitelisted(ngroups, groupList, &whitelistedGid) ) {
+            GECO_INFO("sshd running as uid(%d) is member of whitelisted gid(%d)", getuid(), whitelistedGid);
+            goto early_exit;
           }
         }
       }
@@ -711,63 +729,7 @@ GECOExecWrapperQuarantine(
     }
     
     // Now we've got the job id.  Let's try to inform gecod:
-    GECOQuarantineSocket      theSocket;
-    
-    rc = GECOQuarantineSocketOpenClient(
-                GECOQuarantineSocketTypeInferred,
-                ( GECOExecWrapperQuarantineSocketAddr ? GECOExecWrapperQuarantineSocketAddr : GECODDefaultQuarantineSocket ),
-                GECOExecWrapperQuarantineRetryCount,
-                GECOExecWrapperQuarantineRecvTimeout,
-                GECOExecWrapperQuarantineSendTimeout,
-                &theSocket
-              );
-    if ( rc ) {
-      GECOQuarantineCommandRef  quarantineCommand = GECOQuarantineCommandJobStartedCreate(jobId, taskId, getpid());
-      
-      if ( quarantineCommand ) {
-        rc = GECOQuarantineSocketSendCommand(&theSocket, quarantineCommand);
-        GECOQuarantineCommandDestroy(quarantineCommand);
-        quarantineCommand = NULL;
-        if ( rc ) {
-          rc = GECOQuarantineSocketRecvCommand(&theSocket, &quarantineCommand);
-          if ( rc ) {
-            if ( GECOQuarantineCommandGetCommandId(quarantineCommand) == GECOQuarantineCommandIdAckJobStarted ) {
-              long int      ackJobId = GECOQuarantineCommandAckJobStartedGetJobId(quarantineCommand);
-              long int      ackTaskId = GECOQuarantineCommandAckJobStartedGetTaskId(quarantineCommand);
-              
-              if ( ackJobId == jobId && ackTaskId == taskId ) {
-                rc = GECOQuarantineCommandAckJobStartedGetSuccess(quarantineCommand);
-                GECO_INFO("Received acknowledgement from gecod:  job %ld.%ld (pid %ld) was%s quarantined",
-                      jobId, taskId, (long int)getpid(),
-                      ( rc ? "" : " not" )
-                    );
-              } else {
-                GECO_ERROR("Expected job-started acknowledgement for %ld.%ld (pid %ld), got acknowledgement for %ld.%ld", jobId, taskId, (long int)getpid(), ackJobId, ackTaskId);
-                rc = false;
-              }
-            } else {
-              GECO_ERROR("Expected job-started acknowledgement for %ld.%ld (pid %ld), got wrong command (%u) from server", jobId, taskId, (long int)getpid(),
-                  GECOQuarantineCommandGetCommandId(quarantineCommand)
-                );
-              rc = false;
-            }
-          } else {
-            GECO_ERROR("Failed to receive job-started acknowledgement for %ld.%ld (pid %ld)", jobId, taskId, (long int)getpid());
-          }
-          GECOQuarantineCommandDestroy(quarantineCommand);
-        } else {
-          GECO_ERROR("Failed to send job-started quarantine command for %ld.%ld (pid %ld) (errno = %d)", jobId, taskId, (long int)getpid(), errno);
-        }
-      } else {
-        GECO_ERROR("Could not create job-started quarantine command for %ld.%ld (pid %ld)", jobId, taskId, (long int)getpid());
-        rc = false;
-      }
-    } else {
-      GECO_ERROR("Could not open client socket '%s' to perform quarantine operations for %ld.%ld (pid %ld)",
-          ( GECOExecWrapperQuarantineSocketAddr ? GECOExecWrapperQuarantineSocketAddr : GECODDefaultQuarantineSocket ),
-          jobId, taskId, (long int)getpid()
-        );
-    }
+    rc = GECOExecWrapperQuarantineJobStarted(jobId, taskId);
   }
   
 early_exit:
@@ -949,21 +911,13 @@ execve(
   
   GECOExecWrapperTmpDebug("%d:%d execve(%s, ...)\n", getpid(), getppid(), filename);
   
-  // Pare the command we wish to execute down to its basename:
-  const char    *nextCommand = filename + strlen(filename);
-  
-  while ( nextCommand-- > filename ) {
-    if ( *nextCommand == '/' ) {
-      nextCommand++;
-      break;
-    }
-  }
-  
   char *const   *cleanEnvP = NULL;
   
-  if ( GECOExecWrapperQuarantine(nextCommand, envp, &cleanEnvP) ) {
+  // GECOExecWrapperQuarantine() pares the command down to its basename:
+  if ( GECOExecWrapperQuarantine(filename, envp, &cleanEnvP) ) {
     if ( GECOOriginalSymbol_execve ) {
-      return GECOOriginalSymbol_execve(filename, argv, (cleanEnvP ? cleanEnvP : envp ));
+      // Only returns on failure:
+      GECOOriginalSymbol_execve(filename, argv, (cleanEnvP ? cleanEnvP : envp ));
     } else {
       errno = ENOSYS;
     }
@@ -1004,7 +958,8 @@ execvpe(
   
   if ( GECOExecWrapperQuarantine(file, envp, &cleanEnvP) ) {
     if ( GECOOriginalSymbol_execvpe ) {
-      return GECOOriginalSymbol_execvpe(file, argv, (cleanEnvP ? cleanEnvP : envp ));
+      // Only returns on failure:
+      GECOOriginalSymbol_execvpe(file, argv, (cleanEnvP ? cleanEnvP : envp ));
     } else {
       errno = ENOSYS;
     }
@@ -1033,7 +988,8 @@ fexecve(
   
   if ( GECOExecWrapperQuarantine("unknown", envp, &cleanEnvP) ) {
     if ( GECOOriginalSymbol_fexecve ) {
-      return GECOOriginalSymbol_fexecve(fd, argv, (cleanEnvP ? cleanEnvP : envp ));
+      // Only returns on failure:
+      GECOOriginalSymbol_fexecve(fd, argv, (cleanEnvP ? cleanEnvP : envp ));
     } else {
       errno = ENOSYS;
     }
@@ -0,0 +1,505 @@
+/*
+ *  GECO — Grid Engine Cgroup Orchestrator
+ *  GECOPreloadConfig.c
+ *
+ *  Configuration of the LD_PRELOAD library, either parsed from the
+ *  geco-preload-lib.conf file or memory-mapped from its compiled form.
+ *
+ *  Copyright © 2015
+ *  Dr. Jeffrey Frey, University of Delaware
+ *
+ *  $Id$
+ */
+
+#include "GECOPreloadConfig.h"
+
+#include "confuse.h"
+
+#include <sys/mman.h>
+
+//
+
+const char *GECOPreloadConfigFileName = "geco-preload-lib.conf";
+const char *GECOPreloadConfigCompiledFileName = "geco-preload-lib.bin";
+
+#ifndef GECOD_QUARANTINE_SOCKET
+#define GECOD_QUARANTINE_SOCKET     "path:/tmp/gecod_quarantine"
+#endif
+
+//
+// uid/gid values at or below this are always whitelisted:
+//
+#ifndef GECOPRELOADCONFIG_SYSTEM_ID_MAX
+#define GECOPRELOADCONFIG_SYSTEM_ID_MAX   499
+#endif
+
+//
+#if 0
+#pragma mark -
+#endif
+//
+// Compiled file layout (host byte order; the file is only meaningful on the
+// architecture that produced it):
+//
+//   GECOPreloadConfigHeader
+//   uid ranges:  uidRangeCount (low, high) GECOInteger pairs
+//   gid ranges:  gidRangeCount (low, high) GECOInteger pairs
+//   strings:     NUL-terminated, referenced by offset (zero = not present)
+//
+// All offsets are relative to the start of the file.  The checksum covers every
+// byte following the header.
+//
+
+#define GECOPRELOADCONFIG_MAGIC     0x4f434547    /* "GECO" */
+#define GECOPRELOADCONFIG_VERSION   1
+
+enum {
+  GECOPreloadConfigFlagShouldQuarantineSSH = 1 << 0
+};
+
+typedef struct {
+  uint32_t          magic;
+  uint32_t          version;
+  uint64_t          byteSize;
+  uint32_t          checksum;
+  uint32_t          flags;
+  int64_t           execdUid;
+  int32_t           logLevel;
+  uint32_t          logFileModeMask;
+  uint32_t          quarantineSendTimeout;
+  uint32_t          quarantineRecvTimeout;
+  uint32_t          quarantineRetryCount;
+  uint32_t          uidRangeCount;
+  uint32_t          gidRangeCount;
+  uint32_t          reserved;
+  uint64_t          uidRangeOffset;
+  uint64_t          gidRangeOffset;
+  uint64_t          logPathFormatOffset;
+  uint64_t          quarantineSocketAddrOffset;
+} GECOPreloadConfigHeader;
+
+//
+
+uint32_t
+__GECOPreloadConfigChecksum(
+  const void        *bytes,
+  size_t            byteCount
+)
+{
+  const uint8_t     *p = (const uint8_t*)bytes;
+  uint32_t          hash = 2166136261U;
+  
+  // FNV-1a:
+  while ( byteCount-- ) {
+    hash ^= *p++;
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+//
+#if 0
+#pragma mark -
+#endif
+//
+
+void
+GECOPreloadConfigInitDefaults(
+  GECOPreloadConfig   *aConfig
+)
+{
+  aConfig->shouldQuarantineSSH = true;
+  aConfig->execdUid = -1;
+  aConfig->logLevel = GECOLogLevelQuiet;
+  aConfig->logFileModeMask = 0644;
+  aConfig->logPathFormat = NULL;
+  aConfig->quarantineSocketAddr = NULL;
+  aConfig->quarantineSendTimeout = 0;
+  aConfig->quarantineRecvTimeout = 0;
+  aConfig->quarantineRetryCount = 0;
+  aConfig->allowedUids = NULL;
+  aConfig->allowedGids = NULL;
+}
+
+//
+
+int
+__GECOPreloadConfigParseLogLevelCallback(
+  cfg_t       *cfg,
+  cfg_opt_t   *opt,
+  const char  *value,
+  void        *result
+)
+{
+  long int    *outValue = (long int*)result;
+  
+  if ( (*value == '\0') || (strcasecmp(value, "NONE") == 0) )
+    *outValue = GECOLogLevelQuiet;
+  else if ( strcasecmp(value, "ERROR") == 0 )
+    *outValue = GECOLogLevelError;
+  else if ( strcasecmp(value, "WARN") == 0 )
+    *outValue = GECOLogLevelWarn;
+  else if ( strcasecmp(value, "INFO") == 0 )
+    *outValue = GECOLogLevelInfo;
+  else if ( strcasecmp(value, "DEBUG") == 0 )
+    *outValue = GECOLogLevelDebug;
+  else
+    return -1;
+    
+  return 0;
+}
+
+//
+
+bool
+GECOPreloadConfigParseFile(
+  GECOPreloadConfig   *aConfig,
+  const char          *path
+)
+{
+  cfg_bool_t          shouldQuarantineSSH = aConfig->shouldQuarantineSSH ? cfg_true : cfg_false;
+  cfg_opt_t           cfg_logging_opts[] = {
+                          CFG_STR("path", NULL, CFGF_NODEFAULT),
+                          CFG_INT_CB("level", GECOLogLevelQuiet, CFGF_NONE, __GECOPreloadConfigParseLogLevelCallback),
+                          CFG_INT("mode", 0644, CFGF_NONE),
+                          CFG_END()
+                        };
+  cfg_opt_t           cfg_whitelist_opts[] = {
+                          CFG_INT_LIST("uids", NULL, CFGF_NODEFAULT ),
+                          CFG_INT_LIST("gids", NULL, CFGF_NODEFAULT ),
+                          CFG_END()
+                        };
+  cfg_opt_t           cfg_quarantine_opts[] = {
+                          CFG_STR("socket", GECOD_QUARANTINE_SOCKET, CFGF_NONE ),
+                          CFG_INT("send_timeout", 60, CFGF_NONE ),
+                          CFG_INT("recv_timeout", 60, CFGF_NONE ),
+                          CFG_INT("retry", 2, CFGF_NONE ),
+                          CFG_END()
+                        };
+  cfg_opt_t           cfg_opts[] = {
+                          CFG_SEC("whitelist", cfg_whitelist_opts, CFGF_NONE ),
+                          CFG_SEC("quarantine", cfg_quarantine_opts, CFGF_NONE ),
+                          CFG_INT("sge_execd_uid", -1, CFGF_NODEFAULT),
+                          CFG_SEC("logging", cfg_logging_opts, CFGF_NONE),
+                        	CFG_SIMPLE_BOOL("enable_sshd_quarantine", &shouldQuarantineSSH),
+                          CFG_END()
+                        };
+  GECOIntegerSetRef   uidSet = NULL, gidSet = NULL;
+  
+  // Create uid/gid allow sets:
+  if ( ! (uidSet = GECOIntegerSetCreate()) ) {
+    errno = ENOMEM;
+    return false;
+  }
+  if ( ! (gidSet = GECOIntegerSetCreate()) ) {
+    errno = ENOMEM;
+    GECOIntegerSetDestroy(uidSet);
+    return false;
+  }
+  GECOIntegerSetAddIntegerRange(uidSet, 0, GECOPRELOADCONFIG_SYSTEM_ID_MAX);
+  GECOIntegerSetAddIntegerRange(gidSet, 0, GECOPRELOADCONFIG_SYSTEM_ID_MAX);
+  
+  // Check for our configuration file:
+  if ( path && GECOIsFile(path) ) {
+    cfg_t               *cfg = cfg_init(cfg_opts, CFGF_NONE);
+    
+    if ( cfg ) {
+      int               rc = cfg_parse(cfg, path);
+      
+      if ( rc == CFG_SUCCESS ) {
+        unsigned int    i, iMax;
+        long int        v;
+        
+        // Add any whitelisted uids/gids:
+        cfg_t           *whitelistCfg = cfg_getsec(cfg, "whitelist");
+        
+        if ( whitelistCfg ) {
+          i = 0; iMax = cfg_size(whitelistCfg, "uids");
+          while ( i < iMax ) GECOIntegerSetAddInteger(uidSet, cfg_getnint(whitelistCfg, "uids", i++));
+          
+          // Add any whitelisted gids that were specified:
+          i = 0; iMax = cfg_size(whitelistCfg, "gids");
+          while ( i < iMax ) GECOIntegerSetAddInteger(gidSet, cfg_getnint(whitelistCfg, "gids", i++));
+        }
+        
+        // Quarantine items::
+        cfg_t           *quarantineCfg = cfg_getsec(cfg, "quarantine");
+        
+        if ( quarantineCfg ) {
+          char          *socketAddr = cfg_getstr(quarantineCfg, "socket");
+          
+          if ( socketAddr ) aConfig->quarantineSocketAddr = strdup(socketAddr);
+          
+          v = cfg_getint(quarantineCfg, "send_timeout");
+          if ( v >= 0 && v < UINT_MAX ) aConfig->quarantineSendTimeout = v;
+          
+          v = cfg_getint(quarantineCfg, "recv_timeout");
+          if ( v >= 0 && v < UINT_MAX ) aConfig->quarantineRecvTimeout = v;
+          
+          v = cfg_getint(quarantineCfg, "retry");
+          if ( v >= 0 && v < UINT_MAX ) aConfig->quarantineRetryCount = v;
+        }
+        
+        // What uid is sge_execd expected to run as?
+        if ( (v = cfg_getint(cfg, "sge_execd_uid")) >= 0 ) {
+          if ( v < INT_MAX ) aConfig->execdUid = v;
+        }
+        
+        // Should we setup some logging?
+        cfg_t           *loggingCfg = cfg_getsec(cfg, "logging");
+        
+        if ( loggingCfg ) {
+          GECOLogLevel  logLevel = cfg_getint(loggingCfg, "level");
+          
+          if ( logLevel > GECOLogLevelQuiet ) {
+            aConfig->logLevel = logLevel;
+            
+            // Check for a file path format string:
+            char        *pathFormat = cfg_getstr(loggingCfg, "path");
+            
+            if ( pathFormat && *pathFormat && (strcasecmp(pathFormat, ":stderr:") != 0) ) {
+              aConfig->logPathFormat = strdup(pathFormat);
+              
+              aConfig->logFileModeMask = cfg_getint(loggingCfg, "mode");
+            }
+          }
+        }
+        aConfig->shouldQuarantineSSH = ( shouldQuarantineSSH == cfg_true );
+      }
+      cfg_free(cfg);
+    }
+  }
+  
+  aConfig->allowedUids = GECOIntegerSetCreateConstantCopy(uidSet); GECOIntegerSetDestroy(uidSet);
+  aConfig->allowedGids = GECOIntegerSetCreateConstantCopy(gidSet); GECOIntegerSetDestroy(gidSet);
+  return true;
+}
+
+//
+#if 0
+#pragma mark -
+#endif
+//
+
+bool
+GECOPreloadConfigWriteCompiledFile(
+  GECOPreloadConfig   *aConfig,
+  const char          *path
+)
+{
+  GECOPreloadConfigHeader header;
+  unsigned int        uidRangeCount = aConfig->allowedUids ? GECOIntegerSetGetRanges(aConfig->allowedUids, NULL, 0) : 0;
+  unsigned int        gidRangeCount = aConfig->allowedGids ? GECOIntegerSetGetRanges(aConfig->allowedGids, NULL, 0) : 0;
+  size_t              logPathFormatLen = aConfig->logPathFormat ? strlen(aConfig->logPathFormat) + 1 : 0;
+  size_t              quarantineSocketAddrLen = aConfig->quarantineSocketAddr ? strlen(aConfig->quarantineSocketAddr) + 1 : 0;
+  size_t              byteSize;
+  void                *bytes;
+  char                tmpPath[PATH_MAX];
+  int                 fd;
+  bool                rc = false;
+  
+  memset(&header, 0, sizeof(header));
+  header.magic = GECOPRELOADCONFIG_MAGIC;
+  header.version = GECOPRELOADCONFIG_VERSION;
+  header.flags = aConfig->shouldQuarantineSSH ? GECOPreloadConfigFlagShouldQuarantineSSH : 0;
+  header.execdUid = aConfig->execdUid;
+  header.logLevel = aConfig->logLevel;
+  header.logFileModeMask = aConfig->logFileModeMask;
+  header.quarantineSendTimeout = aConfig->quarantineSendTimeout;
+  header.quarantineRecvTimeout = aConfig->quarantineRecvTimeout;
+  header.quarantineRetryCount = aConfig->quarantineRetryCount;
+  header.uidRangeCount = uidRangeCount;
+  header.gidRangeCount = gidRangeCount;
+  header.uidRangeOffset = sizeof(header);
+  header.gidRangeOffset = header.uidRangeOffset + 2 * uidRangeCount * sizeof(GECOInteger);
+  byteSize = header.gidRangeOffset + 2 * gidRangeCount * sizeof(GECOInteger);
+  if ( logPathFormatLen ) {
+    header.logPathFormatOffset = byteSize;
+    byteSize += logPathFormatLen;
+  }
+  if ( quarantineSocketAddrLen ) {
+    header.quarantineSocketAddrOffset = byteSize;
+    byteSize += quarantineSocketAddrLen;
+  }
+  header.byteSize = byteSize;
+  
+  if ( ! (bytes = calloc(1, byteSize)) ) return false;
+  if ( uidRangeCount ) GECOIntegerSetGetRanges(aConfig->allowedUids, bytes + header.uidRangeOffset, uidRangeCount);
+  if ( gidRangeCount ) GECOIntegerSetGetRanges(aConfig->allowedGids, bytes + header.gidRangeOffset, gidRangeCount);
+  if ( logPathFormatLen ) memcpy(bytes + header.logPathFormatOffset, aConfig->logPathFormat, logPathFormatLen);
+  if ( quarantineSocketAddrLen ) memcpy(bytes + header.quarantineSocketAddrOffset, aConfig->quarantineSocketAddr, quarantineSocketAddrLen);
+  header.checksum = __GECOPreloadConfigChecksum(bytes + sizeof(header), byteSize - sizeof(header));
+  memcpy(bytes, &header, sizeof(header));
+  
+  //
+  // Write to a temporary file and rename it into place:
+  //
+  if ( snprintf(tmpPath, sizeof(tmpPath), "%s.XXXXXX", path) < sizeof(tmpPath) ) {
+    if ( (fd = mkstemp(tmpPath)) >= 0 ) {
+      const void      *p = bytes;
+      size_t          remain = byteSize;
+      
+      while ( remain ) {
+        ssize_t       count = write(fd, p, remain);
+        
+        if ( count <= 0 ) {
+          if ( (count < 0) && (errno == EINTR) ) continue;
+          break;
+        }
+        p += count;
+        remain -= count;
+      }
+      if ( (remain == 0) && (fchmod(fd, 0644) == 0) && (fsync(fd) == 0) ) rc = true;
+      if ( close(fd) != 0 ) rc = false;
+      if ( rc && (rename(tmpPath, path) != 0) ) rc = false;
+      if ( ! rc ) unlink(tmpPath);
+    }
+  } else {
+    errno = ENAMETOOLONG;
+  }
+  free(bytes);
+  return rc;
+}
+
+//
+
+bool
+__GECOPreloadConfigIsValidString(
+  const void        *bytes,
+  size_t            byteSize,
+  uint64_t          offset
+)
+{
+  if ( offset == 0 ) return true;
+  if ( (offset < sizeof(GECOPreloadConfigHeader)) || (offset >= byteSize) ) return false;
+  return ( memchr(bytes + offset, '\0', byteSize - offset) != NULL );
+}
+
+//
+
+bool
+__GECOPreloadConfigIsValidRanges(
+  size_t            byteSize,
+  uint64_t          offset,
+  uint32_t          rangeCount
+)
+{
+  if ( (offset < sizeof(GECOPreloadConfigHeader)) || (offset % sizeof(GECOInteger)) || (offset > byteSize) ) return false;
+  return ( (uint64_t)rangeCount * 2 * sizeof(GECOInteger) <= byteSize - offset );
+}
+
+//
+
+bool
+GECOPreloadConfigMapCompiledFile(
+  GECOPreloadConfig   *aConfig,
+  const char          *path,
+  const char          *sourcePath
+)
+{
+  struct stat         finfo, sourceFinfo;
+  int                 fd = open(path, O_RDONLY | O_CLOEXEC);
+  void                *bytes;
+  const GECOPreloadConfigHeader *header;
+  GECOIntegerSetRef   uidSet, gidSet;
+  
+  if ( fd < 0 ) return false;
+  if ( (fstat(fd, &finfo) != 0) || (finfo.st_size < sizeof(GECOPreloadConfigHeader)) ) {
+    close(fd);
+    return false;
+  }
+  
+  // Ignore a compiled file that predates the text configuration file:
+  if ( sourcePath && (stat(sourcePath, &sourceFinfo) == 0) ) {
+    if ( (sourceFinfo.st_mtim.tv_sec > finfo.st_mtim.tv_sec) || ((sourceFinfo.st_mtim.tv_sec == finfo.st_mtim.tv_sec) && (sourceFinfo.st_mtim.tv_nsec > finfo.st_mtim.tv_nsec)) ) {
+      close(fd);
+      return false;
+    }
+  }
+  
+  bytes = mmap(NULL, finfo.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if ( bytes == MAP_FAILED ) return false;
+  
+  header = (const GECOPreloadConfigHeader*)bytes;
+  if (  (header->magic != GECOPRELOADCONFIG_MAGIC) ||
+        (header->version != GECOPRELOADCONFIG_VERSION) ||
+        (header->byteSize != finfo.st_size) ||
+        ! __GECOPreloadConfigIsValidRanges(finfo.st_size, header->uidRangeOffset, header->uidRangeCount) ||
+        ! __GECOPreloadConfigIsValidRanges(finfo.st_size, header->gidRangeOffset, header->gidRangeCount) ||
+        ! __GECOPreloadConfigIsValidString(bytes, finfo.st_size, header->logPathFormatOffset) ||
+        ! __GECOPreloadConfigIsValidString(bytes, finfo.st_size, header->quarantineSocketAddrOffset) ||
+        (header->checksum != __GECOPreloadConfigChecksum(bytes + sizeof(GECOPreloadConfigHeader), finfo.st_size - sizeof(GECOPreloadConfigHeader)))
+  ) {
+    munmap(bytes, finfo.st_size);
+    return false;
+  }
+  
+  if ( ! (uidSet = GECOIntegerSetCreateConstantWithRanges(header->uidRangeCount, bytes + header->uidRangeOffset)) ) {
+    munmap(bytes, finfo.st_size);
+    return false;
+  }
+  if ( ! (gidSet = GECOIntegerSetCreateConstantWithRanges(header->gidRangeCount, bytes + header->gidRangeOffset)) ) {
+    GECOIntegerSetDestroy(uidSet);
+    munmap(bytes, finfo.st_size);
+    return false;
+  }
+  
+  aConfig->shouldQuarantineSSH = ( header->flags & GECOPreloadConfigFlagShouldQuarantineSSH ) ? true : false;
+  aConfig->execdUid = header->execdUid;
+  aConfig->logLevel = header->logLevel;
+  aConfig->logFileModeMask = header->logFileModeMask;
+  aConfig->logPathFormat = header->logPathFormatOffset ? (const char*)(bytes + header->logPathFormatOffset) : NULL;
+  aConfig->quarantineSocketAddr = header->quarantineSocketAddrOffset ? (const char*)(bytes + header->quarantineSocketAddrOffset) : NULL;
+  aConfig->quarantineSendTimeout = header->quarantineSendTimeout;
+  aConfig->quarantineRecvTimeout = header->quarantineRecvTimeout;
+  aConfig->quarantineRetryCount = header->quarantineRetryCount;
+  aConfig->allowedUids = uidSet;
+  aConfig->allowedGids = gidSet;
+  return true;
+}
+
+//
+
+void
+__GECOPreloadConfigSummarizeIntegerSet(
+  GECOIntegerSetRef   anIntSet,
+  FILE                *stream
+)
+{
+  unsigned int        i, iMax = anIntSet ? GECOIntegerSetGetRanges(anIntSet, NULL, 0) : 0;
+  
+  if ( iMax ) {
+    GECOInteger       ranges[2 * iMax];
+    
+    GECOIntegerSetGetRanges(anIntSet, ranges, iMax);
+    for ( i = 0; i < iMax; i++ ) {
+      if ( ranges[2 * i] == ranges[2 * i + 1] ) {
+        fprintf(stream, "%s%ld", (i ? "," : ""), ranges[2 * i]);
+      } else {
+        fprintf(stream, "%s%ld-%ld", (i ? "," : ""), ranges[2 * i], ranges[2 * i + 1]);
+      }
+    }
+  }
+}
+
+//
+
+void
+GECOPreloadConfigSummarizeToStream(
+  GECOPreloadConfig   *aConfig,
+  FILE                *stream
+)
+{
+  fprintf(stream, "%-25s%s\n", "enable_sshd_quarantine:", aConfig->shouldQuarantineSSH ? "true" : "false");
+  fprintf(stream, "%-25s%ld\n", "sge_execd_uid:", aConfig->execdUid);
+  fprintf(stream, "%-25s%d\n", "logging.level:", (int)aConfig->logLevel);
+  fprintf(stream, "%-25s%s\n", "logging.path:", aConfig->logPathFormat ? aConfig->logPathFormat : "<none>");
+  fprintf(stream, "%-25s%04o\n", "logging.mode:", aConfig->logFileModeMask);
+  fprintf(stream, "%-25s%s\n", "quarantine.socket:", aConfig->quarantineSocketAddr ? aConfig->quarantineSocketAddr : "<default>");
+  fprintf(stream, "%-25s%u\n", "quarantine.send_timeout:", aConfig->quarantineSendTimeout);
+  fprintf(stream, "%-25s%u\n", "quarantine.recv_timeout:", aConfig->quarantineRecvTimeout);
+  fprintf(stream, "%-25s%u\n", "quarantine.retry:", aConfig->quarantineRetryCount);
+  fprintf(stream, "%-25s", "whitelist.uids:"); __GECOPreloadConfigSummarizeIntegerSet(aConfig->allowedUids, stream); fprintf(stream, "\n");
+  fprintf(stream, "%-25s", "whitelist.gids:"); __GECOPreloadConfigSummarizeIntegerSet(aConfig->allowedGids, stream); fprintf(stream, "\n");
+}
@@ -0,0 +1,109 @@
+/*
+ *  GECO — Grid Engine Cgroup Orchestrator
+ *  GECOPreloadConfig.h
+ *
+ *  Configuration of the LD_PRELOAD library, either parsed from the
+ *  geco-preload-lib.conf file or memory-mapped from its compiled form.
+ *
+ *  Copyright © 2015
+ *  Dr. Jeffrey Frey, University of Delaware
+ *
+ *  $Id$
+ */
+
+#ifndef __GECOPRELOADCONFIG_H__
+#define __GECOPRELOADCONFIG_H__
+
+#include "GECO.h"
+#include "GECOLog.h"
+#include "GECOIntegerSet.h"
+
+/*!
+  @constant GECOPreloadConfigFileName
+  @discussion
+    Name of the text configuration file (in GECODirectoryEtc).
+*/
+extern const char *GECOPreloadConfigFileName;
+
+/*!
+  @constant GECOPreloadConfigCompiledFileName
+  @discussion
+    Name of the compiled configuration file (in GECODirectoryEtc).
+*/
+extern const char *GECOPreloadConfigCompiledFileName;
+
+/*!
+  @typedef GECOPreloadConfig
+  @discussion
+    Settings that drive the LD_PRELOAD library.  String fields are NULL if
+    the setting was not present; the uid/gid whitelists are constant integer
+    sets.
+*/
+typedef struct {
+  bool                shouldQuarantineSSH;
+  long int            execdUid;
+  GECOLogLevel        logLevel;
+  int                 logFileModeMask;
+  const char          *logPathFormat;
+  const char          *quarantineSocketAddr;
+  unsigned int        quarantineSendTimeout;
+  unsigned int        quarantineRecvTimeout;
+  unsigned int        quarantineRetryCount;
+  GECOIntegerSetRef   allowedUids;
+  GECOIntegerSetRef   allowedGids;
+} GECOPreloadConfig;
+
+/*!
+  @function GECOPreloadConfigInitDefaults
+  @discussion
+    Fill-in aConfig with the settings used when no configuration file is
+    present.  The whitelists are left NULL.
+*/
+void GECOPreloadConfigInitDefaults(GECOPreloadConfig *aConfig);
+
+/*!
+  @function GECOPreloadConfigParseFile
+  @discussion
+    Parse the libconfuse-format configuration file at path into aConfig.  The
+    uid/gid whitelists always include the system range [0, 499]; if path does
+    not exist only that range is whitelisted.
+  @result
+    Returns boolean false if the whitelists could not be allocated (errno is
+    set to ENOMEM).
+*/
+bool GECOPreloadConfigParseFile(GECOPreloadConfig *aConfig, const char *path);
+
+/*!
+  @function GECOPreloadConfigWriteCompiledFile
+  @discussion
+    Write aConfig to path in the compiled (binary) format.  The file is
+    written under a temporary name and renamed into place, so processes that
+    have the previous version mapped are unaffected.
+  @result
+    Returns boolean true if the file was successfully written.
+*/
+bool GECOPreloadConfigWriteCompiledFile(GECOPreloadConfig *aConfig, const char *path);
+
+/*!
+  @function GECOPreloadConfigMapCompiledFile
+  @discussion
+    Memory-map the compiled configuration file at path (read-only, shared)
+    and, if it passes validation, fill-in aConfig from it.  String fields in
+    aConfig point into the mapping, which remains in place for the life of
+    the process.
+
+    If sourcePath is not NULL and that file was modified more recently than
+    the compiled file, the compiled file is considered stale and is not used.
+  @result
+    Returns boolean false if the compiled file is missing, stale, or invalid.
+*/
+bool GECOPreloadConfigMapCompiledFile(GECOPreloadConfig *aConfig, const char *path, const char *sourcePath);
+
+/*!
+  @function GECOPreloadConfigSummarizeToStream
+  @discussion
+    Write a textual summary of aConfig to stream.
+*/
+void GECOPreloadConfigSummarizeToStream(GECOPreloadConfig *aConfig, FILE *stream);
+
+#endif /* __GECOPRELOADCONFIG_H__ */
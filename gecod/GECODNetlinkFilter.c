@@ -0,0 +1,82 @@
+/*
+ *  GECO — Grid Engine Cgroup Orchestrator
+ *  GECODNetlinkFilter.c
+ *  
+ *  Classic BPF socket filter that discards proc connector events gecod
+ *  has no use for before they are queued to the netlink socket.
+ *
+ *  Copyright © 2015
+ *  Dr. Jeffrey Frey, University of Delaware
+ *
+ *  $Id$
+ */
+
+#include <stddef.h>
+#include <endian.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <linux/filter.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <linux/cn_proc.h>
+
+//
+// Each proc connector event arrives as its own netlink message:  nlmsghdr,
+// then cn_msg, then the proc_event as the cn_msg payload.
+//
+#define GECOD_NETLINK_FILTER_EVENT_OFFSET   (NLMSG_HDRLEN + offsetof(struct cn_msg, data))
+#define GECOD_NETLINK_FILTER_WHAT_OFFSET    (GECOD_NETLINK_FILTER_EVENT_OFFSET + offsetof(struct proc_event, what))
+#define GECOD_NETLINK_FILTER_PID_OFFSET     (GECOD_NETLINK_FILTER_EVENT_OFFSET + offsetof(struct proc_event, event_data.exit.process_pid))
+
+#define GECOD_NETLINK_FILTER_MAX_INSNS      24
+
+//
+
+int
+GECODNetlinkFilterAttach(
+  int             fd,
+  pid_t           pidWatermark
+)
+{
+  struct sock_filter    program[GECOD_NETLINK_FILTER_MAX_INSNS];
+  struct sock_fprog     filter;
+  unsigned short        n = 0;
+  
+  //
+  // Only PROC_EVENT_EXIT gets through.  BPF loads words in network byte order
+  // but the event is in host byte order, hence the htonl():
+  //
+  program[n++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, GECOD_NETLINK_FILTER_WHAT_OFFSET);
+  program[n++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, htonl(PROC_EVENT_EXIT), 1, 0);
+  program[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0);
+  
+  //
+  // Optionally drop exits of pids below the watermark.  A magnitude comparison
+  // needs the pid in host byte order, so on little-endian hosts it has to be
+  // assembled a byte at a time:
+  //
+  if ( pidWatermark > 0 ) {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+    int                 byteIdx = sizeof(uint32_t);
+    
+    while ( byteIdx-- > 0 ) {
+      program[n++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_B | BPF_ABS, GECOD_NETLINK_FILTER_PID_OFFSET + byteIdx);
+      if ( byteIdx < sizeof(uint32_t) - 1 ) program[n++] = (struct sock_filter)BPF_STMT(BPF_ALU | BPF_OR | BPF_X, 0);
+      if ( byteIdx > 0 ) {
+        program[n++] = (struct sock_filter)BPF_STMT(BPF_ALU | BPF_LSH | BPF_K, 8);
+        program[n++] = (struct sock_filter)BPF_STMT(BPF_MISC | BPF_TAX, 0);
+      }
+    }
+#else
+    program[n++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, GECOD_NETLINK_FILTER_PID_OFFSET);
+#endif
+    program[n++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JGE | BPF_K, (uint32_t)pidWatermark, 1, 0);
+    program[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0);
+  }
+  program[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0xffffffff);
+  
+  filter.len = n;
+  filter.filter = program;
+  if ( setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &filter, sizeof(filter)) != 0 ) return errno;
+  return 0;
+}
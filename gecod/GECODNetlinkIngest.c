@@ -0,0 +1,265 @@
+/*
+ *  GECO — Grid Engine Cgroup Orchestrator
+ *  GECODNetlinkIngest.c
+ *
+ *  A dedicated thread that drains the netlink socket into a pid ring, and
+ *  the polling source through which the runloop consumes the ring.
+ *
+ *  Copyright © 2015
+ *  Dr. Jeffrey Frey, University of Delaware
+ *
+ *  $Id$
+ */
+
+#include <pthread.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+
+//
+// Number of exited pids the ring can hold while the runloop is busy; once it
+// fills, further exits are dropped and left to reconciliation:
+//
+#ifndef GECOD_NETLINK_RING_CAPACITY
+#define GECOD_NETLINK_RING_CAPACITY   65536
+#endif
+
+//
+
+typedef struct {
+  GECODNetlinkSocket        *nlSocket;
+  GECODPidRing              *ring;
+  pthread_t                 thread;
+  bool                      isThreadRunning;
+  //
+  // The runloop polls notifyFd, which the thread signals after pushing pids;
+  // the thread polls stopFd alongside the netlink socket:
+  //
+  int                       notifyFd;
+  int                       stopFd;
+  //
+  // Set by the thread when events were lost (netlink overrun or a full ring),
+  // cleared by the runloop:
+  //
+  int                       needsReconciliation;
+  unsigned long int         droppedCount;
+  //
+  // Runloop-side scratch space:
+  //
+  pid_t                     pids[GECOD_NETLINK_BATCH_SIZE];
+  GECOPidToJobIdMapJobCount jobCounts[GECOD_NETLINK_BATCH_SIZE];
+} GECODNetlinkIngest;
+
+//
+
+void
+GECODNetlinkIngestPushExits(
+  GECODNetlinkSocket  *src,
+  unsigned int        pidCount,
+  const pid_t         *pids,
+  const void          *context
+)
+{
+  GECODNetlinkIngest  *ingest = (GECODNetlinkIngest*)context;
+  unsigned int        pushCount = GECODPidRingPush(ingest->ring, pids, pidCount);
+  
+  if ( pushCount < pidCount ) {
+    //
+    // Never wait on the runloop; the pids we could not queue are released by
+    // reconciliation instead:
+    //
+    ingest->droppedCount += pidCount - pushCount;
+    src->needsReconciliation = true;
+    GECO_WARN("GECODNetlinkIngestPushExits: pid ring is full, dropped %u exit event%s (%lu so far)", pidCount - pushCount, ((pidCount - pushCount == 1) ? "" : "s"), ingest->droppedCount);
+  }
+}
+
+//
+
+void*
+GECODNetlinkIngestThread(
+  void                *context
+)
+{
+  GECODNetlinkIngest  *ingest = (GECODNetlinkIngest*)context;
+  struct pollfd       pollFds[2] = {
+                          { .fd = ingest->nlSocket->fd, .events = POLLIN },
+                          { .fd = ingest->stopFd, .events = POLLIN }
+                        };
+  
+  GECO_DEBUG("GECODNetlinkIngestThread: draining netlink socket %d", ingest->nlSocket->fd);
+  while ( true ) {
+    int               rc = poll(pollFds, 2, -1);
+  
+    if ( rc < 0 ) {
+      if ( errno == EINTR ) continue;
+      GECO_ERROR("GECODNetlinkIngestThread: poll failed (errno = %d)", errno);
+      break;
+    }
+    if ( pollFds[1].revents ) break;
+    if ( pollFds[0].revents & POLLNVAL ) {
+      GECO_ERROR("GECODNetlinkIngestThread: netlink socket %d is no longer valid", pollFds[0].fd);
+      break;
+    }
+    if ( pollFds[0].revents ) {
+      // POLLERR also lands here, since that is how ENOBUFS is reported:
+      GECODNetlinkSocketDrain(ingest->nlSocket, GECODNetlinkIngestPushExits, ingest);
+      if ( ingest->nlSocket->needsReconciliation ) {
+        ingest->nlSocket->needsReconciliation = false;
+        __atomic_store_n(&ingest->needsReconciliation, 1, __ATOMIC_RELEASE);
+      }
+      eventfd_write(ingest->notifyFd, 1);
+    }
+  }
+  GECO_DEBUG("GECODNetlinkIngestThread: exiting");
+  return NULL;
+}
+
+//
+
+void
+GECODNetlinkIngestStop(
+  GECODNetlinkIngest  *ingest
+)
+{
+  if ( ingest->isThreadRunning ) {
+    eventfd_write(ingest->stopFd, 1);
+    pthread_join(ingest->thread, NULL);
+    ingest->isThreadRunning = false;
+    GECO_DEBUG("GECODNetlinkIngestStop: netlink ingest thread joined");
+  }
+}
+
+//
+
+void
+GECODNetlinkIngestDestroySource(
+  GECOPollingSource   theSource
+)
+{
+  GECODNetlinkIngest  *ingest = (GECODNetlinkIngest*)theSource;
+  
+  GECODNetlinkIngestStop(ingest);
+  GECODNetlinkSocketDestroySource(ingest->nlSocket);
+  if ( ingest->notifyFd >= 0 ) close(ingest->notifyFd);
+  if ( ingest->stopFd >= 0 ) close(ingest->stopFd);
+  if ( ingest->ring ) GECODPidRingDestroy(ingest->ring);
+  free((void*)ingest);
+}
+
+//
+
+int
+GECODNetlinkIngestFileDescriptorForPolling(
+  GECOPollingSource   theSource
+)
+{
+  GECODNetlinkIngest  *ingest = (GECODNetlinkIngest*)theSource;
+  
+  return ingest->notifyFd;
+}
+
+//
+
+void
+GECODNetlinkIngestDidReceiveDataAvailable(
+  GECOPollingSource   theSource,
+  GECORunloopRef      theRunloop
+)
+{
+  GECODNetlinkIngest  *ingest = (GECODNetlinkIngest*)theSource;
+  unsigned int        batchCount = 0, pidCount = 0;
+  eventfd_t           notifyCount;
+  
+  eventfd_read(ingest->notifyFd, &notifyCount);
+  
+  //
+  // Same per-wakeup bound as the netlink socket source; if the ring still has
+  // pids in it, re-arm the eventfd so the runloop comes back for them:
+  //
+  while ( batchCount++ < GECOD_NETLINK_MAX_BATCHES_PER_WAKEUP ) {
+    pidCount = GECODPidRingPop(ingest->ring, ingest->pids, GECOD_NETLINK_BATCH_SIZE);
+    if ( pidCount == 0 ) break;
+    GECODPidsDidExit(pidCount, ingest->pids, ingest->jobCounts, GECOD_NETLINK_BATCH_SIZE);
+    if ( pidCount < GECOD_NETLINK_BATCH_SIZE ) break;
+  }
+  if ( pidCount == GECOD_NETLINK_BATCH_SIZE ) eventfd_write(ingest->notifyFd, 1);
+  
+  if ( __atomic_exchange_n(&ingest->needsReconciliation, 0, __ATOMIC_ACQ_REL) ) GECODReconcilerSchedule(theRunloop);
+}
+
+//
+
+GECOPollingSourceCallbacks    GECODNetlinkIngestCallbacks = {
+                                            .destroySource = GECODNetlinkIngestDestroySource,
+                                            .fileDescriptorForPolling = GECODNetlinkIngestFileDescriptorForPolling,
+                                            .shouldSourceClose = NULL,
+                                            .willRemoveAsSource = NULL,
+                                            .didAddAsSource = NULL,
+                                            .didBeginPolling = NULL,
+                                            .didReceiveDataAvailable = GECODNetlinkIngestDidReceiveDataAvailable,
+                                            .didEndPolling = NULL,
+                                            .didReceiveClose = NULL,
+                                            .didRemoveAsSource = NULL
+                                          };
+
+//
+
+bool
+GECODNetlinkIngestStart(
+  GECORunloopRef      theRunloop,
+  GECODNetlinkSocket  *nlSocket
+)
+{
+  //
+  // On success the ingest thread owns nlSocket (which must already be
+  // initialized) and closes it when the returned polling source is destroyed:
+  //
+  GECODNetlinkIngest  *ingest = malloc(sizeof(GECODNetlinkIngest));
+  sigset_t            allSignals, oldSignals;
+  int                 rc;
+  
+  if ( ! ingest ) {
+    GECO_ERROR("GECODNetlinkIngestStart: unable to allocate ingest record");
+    return false;
+  }
+  ingest->nlSocket = nlSocket;
+  ingest->isThreadRunning = false;
+  ingest->needsReconciliation = 0;
+  ingest->droppedCount = 0;
+  ingest->notifyFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  ingest->stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  ingest->ring = GECODPidRingCreate(GECOD_NETLINK_RING_CAPACITY);
+  if ( (ingest->notifyFd < 0) || (ingest->stopFd < 0) || ! ingest->ring ) {
+    GECO_ERROR("GECODNetlinkIngestStart: unable to allocate eventfds or pid ring (errno = %d)", errno);
+    goto failure;
+  }
+  
+  //
+  // Signals must be fielded by the main thread, where they interrupt the
+  // runloop:
+  //
+  sigfillset(&allSignals);
+  pthread_sigmask(SIG_BLOCK, &allSignals, &oldSignals);
+  rc = pthread_create(&ingest->thread, NULL, GECODNetlinkIngestThread, ingest);
+  pthread_sigmask(SIG_SETMASK, &oldSignals, NULL);
+  if ( rc != 0 ) {
+    GECO_ERROR("GECODNetlinkIngestStart: unable to create netlink ingest thread (errno = %d)", rc);
+    goto failure;
+  }
+  ingest->isThreadRunning = true;
+  
+  if ( ! GECORunloopAddPollingSource(theRunloop, ingest, &GECODNetlinkIngestCallbacks, GECOPollingSourceFlagStaticFileDescriptor) ) {
+    GECO_ERROR("GECODNetlinkIngestStart: unable to add ingest polling source to runloop");
+    GECODNetlinkIngestStop(ingest);
+    goto failure;
+  }
+  GECO_INFO("GECODNetlinkIngestStart: netlink socket %d is drained by a dedicated thread (ring of %u pids)", nlSocket->fd, ingest->ring->capacity);
+  return true;
+  
+failure:
+  if ( ingest->notifyFd >= 0 ) close(ingest->notifyFd);
+  if ( ingest->stopFd >= 0 ) close(ingest->stopFd);
+  if ( ingest->ring ) GECODPidRingDestroy(ingest->ring);
+  free((void*)ingest);
+  return false;
+}
@@ -26,8 +26,24 @@
 #define GECOD_max(x,y) ((y)<(x)?(x):(y))
 #define GECOD_min(x,y) ((y)>(x)?(x):(y))
 
-#define GECOD_NLMSG_BUFFER_SIZE (GECOD_max(GECOD_max(GECOD_SEND_MESSAGE_SIZE, GECOD_RECV_MESSAGE_SIZE), 4096))
-#define GECOD_MIN_RECV_SIZE (GECOD_min(GECOD_SEND_MESSAGE_SIZE, GECOD_RECV_MESSAGE_SIZE))
+//
+// The proc connector sends each event as a separate datagram, so the receive
+// buffer is a ring of datagram-sized slots filled by a single recvmmsg():
+//
+#define GECOD_NLMSG_DATAGRAM_SIZE (NLMSG_ALIGN(GECOD_max(GECOD_SEND_MESSAGE_SIZE, GECOD_RECV_MESSAGE_SIZE)))
+
+#ifndef GECOD_NETLINK_BATCH_SIZE
+#define GECOD_NETLINK_BATCH_SIZE              64
+#endif
+
+//
+// Upper bound on the number of recvmmsg() calls per wakeup, so that an exit
+// storm cannot starve the other polling sources; whatever is left in the
+// socket queue triggers another wakeup:
+//
+#ifndef GECOD_NETLINK_MAX_BATCHES_PER_WAKEUP
+#define GECOD_NETLINK_MAX_BATCHES_PER_WAKEUP  32
+#endif
 
 #define GECOD_PROC_CN_MCAST_LISTEN (1)
 #define GECOD_PROC_CN_MCAST_IGNORE (2)
@@ -36,7 +52,23 @@
 
 typedef struct {
   int                 fd;
-  char                msgBuffer[GECOD_NLMSG_BUFFER_SIZE];
+  //
+  // Number of times the kernel reported lost events (ENOBUFS or
+  // NLMSG_OVERRUN), and whether tracked pids must be reconciled because of it:
+  //
+  unsigned long int   overrunCount;
+  bool                needsReconciliation;
+  //
+  // Multi-datagram receive buffer:
+  //
+  struct mmsghdr      msgHeaders[GECOD_NETLINK_BATCH_SIZE];
+  struct iovec        msgVectors[GECOD_NETLINK_BATCH_SIZE];
+  char                msgBuffers[GECOD_NETLINK_BATCH_SIZE][GECOD_NLMSG_DATAGRAM_SIZE] __attribute__((aligned(NLMSG_ALIGNTO)));
+  //
+  // Scratch space for processing exit events in bulk:
+  //
+  pid_t                     exitPids[GECOD_NETLINK_BATCH_SIZE];
+  GECOPidToJobIdMapJobCount exitJobCounts[GECOD_NETLINK_BATCH_SIZE];
 } GECODNetlinkSocket;
 
 //
@@ -73,77 +105,148 @@ GECODNetlinkSocketFileDescriptorForPolling(
 //
 
 void
-GECODNetlinkSocketDidReceiveDataAvailable(
-  GECOPollingSource   theSource,
-  GECORunloopRef      theRunloop
+GECODNetlinkSocketNoteOverrun(
+  GECODNetlinkSocket  *src
 )
 {
-  GECODNetlinkSocket  *src = (GECODNetlinkSocket*)theSource;
-  ssize_t             msgSize;
-  struct nlmsghdr     *nl_hdr;
-  struct cn_msg       *cn_hdr;
+  src->overrunCount++;
+  src->needsReconciliation = true;
+  GECO_WARN("GECODNetlinkSocketDrain: netlink events were lost (%lu overrun%s so far)", src->overrunCount, ((src->overrunCount == 1) ? "" : "s"));
+}
+
+//
+
+//
+// Exit events are handed off in batches of up to GECOD_NETLINK_BATCH_SIZE pids:
+//
+typedef void (*GECODNetlinkSocketExitHandler)(GECODNetlinkSocket *src, unsigned int pidCount, const pid_t *pids, const void *context);
+
+void
+GECODNetlinkSocketDrain(
+  GECODNetlinkSocket            *src,
+  GECODNetlinkSocketExitHandler exitHandler,
+  const void                    *context
+)
+{
+  unsigned int        batchCount = 0;
+  bool                isDraining = true;
   
-  msgSize = read(src->fd, src->msgBuffer, sizeof(src->msgBuffer));
-  if ( msgSize > 0 ) {
-    bool            isDecoding = true;
+  //
+  // Drain the socket until it would block:
+  //
+  while ( isDraining && (batchCount++ < GECOD_NETLINK_MAX_BATCHES_PER_WAKEUP) ) {
+    int               msgCount = recvmmsg(src->fd, src->msgHeaders, GECOD_NETLINK_BATCH_SIZE, MSG_DONTWAIT, NULL);
     
-    //
-    // Decode one or more messages:
-    //
-    nl_hdr = (struct nlmsghdr*)&src->msgBuffer;
-    while ( isDecoding && NLMSG_OK(nl_hdr, msgSize) ) {
-      switch ( nl_hdr->nlmsg_type ) {
+    if ( msgCount > 0 ) {
+      unsigned int    exitCount = 0;
+      int             msgIdx;
       
-        case NLMSG_NOOP:
-          break;
-          
-        case NLMSG_ERROR:
-        case NLMSG_OVERRUN:
-          isDecoding = false;
-          break;
+      for ( msgIdx = 0; msgIdx < msgCount; msgIdx++ ) {
+        struct nlmsghdr *nl_hdr = (struct nlmsghdr*)src->msgBuffers[msgIdx];
+        ssize_t         msgSize = src->msgHeaders[msgIdx].msg_len;
+        bool            isDecoding = true;
         
-        case NLMSG_DONE:
-        default: {
-          struct proc_event     *event;
-          
-          cn_hdr = NLMSG_DATA(nl_hdr);
-          event = (struct proc_event *)cn_hdr->data;
-          switch ( event->what ) {
+        //
+        // Decode one or more messages:
+        //
+        while ( isDecoding && NLMSG_OK(nl_hdr, msgSize) ) {
+          switch ( nl_hdr->nlmsg_type ) {
           
-            //
-            // A process has exited.
-            //
-            case PROC_EVENT_EXIT: {
-              long int          jobId = -1, taskId = 1;
-              pid_t             exitPid = event->event_data.exit.process_pid;
-                
-              GECO_DEBUG("exit event noted for pid %ld", (long int)exitPid);
+            case NLMSG_NOOP:
+              break;
               
-              // Something we know about?
-              if ( GECOPidToJobIdMapGetJobAndTaskIdForPid(GECODPidMappings, exitPid, &jobId, &taskId) ) {
-                GECOJobRef      theJob = GECOJobGetExistingObjectForJobIdentifier(jobId, taskId);
-                
-                GECO_DEBUG("found pid %ld => (%ld,%ld)", (long int)exitPid, jobId, taskId);
-                if ( theJob ) {
-                  GECO_DEBUG("job %p released", theJob);
-                  GECOJobRelease(theJob);
-                  GECOPidToJobIdMapRemovePid(GECODPidMappings, exitPid);
+            case NLMSG_OVERRUN:
+              GECODNetlinkSocketNoteOverrun(src);
+              // fall through
+            case NLMSG_ERROR:
+              isDecoding = false;
+              break;
+            
+            case NLMSG_DONE:
+            default: {
+              struct cn_msg         *cn_hdr = NLMSG_DATA(nl_hdr);
+              struct proc_event     *event = (struct proc_event *)cn_hdr->data;
+              
+              switch ( event->what ) {
+              
+                //
+                // A process has exited.
+                //
+                case PROC_EVENT_EXIT: {
+                  if ( exitCount == GECOD_NETLINK_BATCH_SIZE ) {
+                    exitHandler(src, exitCount, src->exitPids, context);
+                    exitCount = 0;
+                  }
+                  src->exitPids[exitCount++] = event->event_data.exit.process_pid;
+                  GECO_DEBUG("exit event noted for pid %ld", (long int)event->event_data.exit.process_pid);
+                  break;
                 }
+                
               }
               break;
             }
-            
           }
-          break;
+          nl_hdr = NLMSG_NEXT(nl_hdr, msgSize);
         }
       }
-      nl_hdr = NLMSG_NEXT(nl_hdr, msgSize);
+      if ( exitCount ) exitHandler(src, exitCount, src->exitPids, context);
+      
+      // A partial batch means the queue is empty:
+      if ( msgCount < GECOD_NETLINK_BATCH_SIZE ) isDraining = false;
+    } else if ( msgCount < 0 ) {
+      switch ( errno ) {
+      
+        case EINTR:
+          break;
+        
+        case ENOBUFS:
+          // The receive queue overflowed; the socket remains usable:
+          GECODNetlinkSocketNoteOverrun(src);
+          break;
+        
+        default:
+          isDraining = false;
+          break;
+          
+      }
+    } else {
+      isDraining = false;
     }
   }
 }
 
 //
 
+void
+GECODNetlinkSocketPidsDidExit(
+  GECODNetlinkSocket  *src,
+  unsigned int        pidCount,
+  const pid_t         *pids,
+  const void          *context
+)
+{
+  GECODPidsDidExit(pidCount, pids, src->exitJobCounts, GECOD_NETLINK_BATCH_SIZE);
+}
+
+//
+
+void
+GECODNetlinkSocketDidReceiveDataAvailable(
+  GECOPollingSource   theSource,
+  GECORunloopRef      theRunloop
+)
+{
+  GECODNetlinkSocket  *src = (GECODNetlinkSocket*)theSource;
+  
+  GECODNetlinkSocketDrain(src, GECODNetlinkSocketPidsDidExit, NULL);
+  if ( src->needsReconciliation ) {
+    src->needsReconciliation = false;
+    GECODReconcilerSchedule(theRunloop);
+  }
+}
+
+//
+
 void
 GECODNetlinkSocketDidReceiveClose(
   GECOPollingSource   theSource,
@@ -151,12 +254,29 @@ GECODNetlinkSocketDidReceiveClose(
 )
 {
   GECODNetlinkSocket  *src = (GECODNetlinkSocket*)theSource;
+  int                 sockErr = 0;
+  socklen_t           sockErrLen = sizeof(sockErr);
   
+  //
+  // A receive queue overrun is reported by epoll as EPOLLERR, which the runloop
+  // treats as a close.  The socket is still perfectly usable in that case, so
+  // only close it for some other error (reading SO_ERROR also clears it):
+  //
+  if ( (src->fd >= 0) && (getsockopt(src->fd, SOL_SOCKET, SO_ERROR, &sockErr, &sockErrLen) == 0) && ((sockErr == 0) || (sockErr == ENOBUFS)) ) {
+    if ( sockErr == ENOBUFS ) GECODNetlinkSocketNoteOverrun(src);
+    if ( src->needsReconciliation ) {
+      src->needsReconciliation = false;
+      GECODReconcilerSchedule(theRunloop);
+    }
+    GECO_DEBUG("GECODNetlinkSocketDidReceiveClose: netlink socket %d remains open", src->fd);
+    return;
+  }
   if ( close(src->fd) == 0 ) {
     GECO_DEBUG("GECODNetlinkSocketDidReceiveClose: close(%d) succeeded", src->fd);
   } else {
     GECO_DEBUG("GECODNetlinkSocketDidReceiveClose: close(%d) failed (errno = %d)", src->fd, errno);
   }
+  GECO_ERROR("GECODNetlinkSocketDidReceiveClose: netlink socket closed (error = %d), pid exit tracking is disabled", sockErr);
   src->fd = -1;
 }
 
@@ -179,12 +299,14 @@ GECOPollingSourceCallbacks    GECODNetlinkSocketCallbacks = {
 
 int
 GECODNetlinkSocketInit(
-  GECODNetlinkSocket    *nlSocket
+  GECODNetlinkSocket    *nlSocket,
+  pid_t                 pidWatermark,
+  int                   rcvBufSize
 )
 {
 	struct sockaddr_nl    localNLAddr;
   int                   localSocket;
-  int                   rc;
+  int                   rc, i;
   ssize_t               count;
 	struct nlmsghdr       *nl_hdr;
 	struct cn_msg         *cn_hdr;
@@ -192,6 +314,17 @@ GECODNetlinkSocketInit(
   
   // Start with an invalid fd in the nlSocket:
   nlSocket->fd = -1;
+  nlSocket->overrunCount = 0;
+  nlSocket->needsReconciliation = false;
+  
+  // Point each receive slot at its buffer:
+  memset(&nlSocket->msgHeaders, 0, sizeof(nlSocket->msgHeaders));
+  for ( i = 0; i < GECOD_NETLINK_BATCH_SIZE; i++ ) {
+    nlSocket->msgVectors[i].iov_base = nlSocket->msgBuffers[i];
+    nlSocket->msgVectors[i].iov_len = GECOD_NLMSG_DATAGRAM_SIZE;
+    nlSocket->msgHeaders[i].msg_hdr.msg_iov = &nlSocket->msgVectors[i];
+    nlSocket->msgHeaders[i].msg_hdr.msg_iovlen = 1;
+  }
   
   // Allocate a netlink socket:
   localSocket = socket(PF_NETLINK, SOCK_DGRAM, NETLINK_CONNECTOR);
@@ -200,6 +333,28 @@ GECODNetlinkSocketInit(
 		return errno;
 	}
   
+  // Have the kernel drop everything but exit events before any are queued to
+  // us; without the filter we still work, just with a lot more wakeups:
+  rc = GECODNetlinkFilterAttach(localSocket, pidWatermark);
+  if ( rc == 0 ) {
+    GECO_INFO("GECODNetlinkSocketInit: exit-event filter attached (pid watermark %ld)", (long int)pidWatermark);
+  } else {
+    GECO_WARN("GECODNetlinkSocketInit: unable to attach exit-event filter to netlink socket (errno = %d)", rc);
+  }
+  
+  // Enlarge the receive queue to ride out exit storms.  SO_RCVBUFFORCE ignores
+  // the rmem_max limit but requires CAP_NET_ADMIN:
+  if ( rcvBufSize > 0 ) {
+    socklen_t           optLen = sizeof(rcvBufSize);
+    
+    if ( (setsockopt(localSocket, SOL_SOCKET, SO_RCVBUFFORCE, &rcvBufSize, sizeof(rcvBufSize)) != 0) && (setsockopt(localSocket, SOL_SOCKET, SO_RCVBUF, &rcvBufSize, sizeof(rcvBufSize)) != 0) ) {
+      GECO_WARN("GECODNetlinkSocketInit: unable to set netlink receive buffer size to %d (errno = %d)", rcvBufSize, errno);
+    }
+    if ( getsockopt(localSocket, SOL_SOCKET, SO_RCVBUF, &rcvBufSize, &optLen) == 0 ) {
+      GECO_INFO("GECODNetlinkSocketInit: netlink receive buffer is %d bytes", rcvBufSize);
+    }
+  }
+  
   // Setup this process's netlink address:
 	localNLAddr.nl_family   = AF_NETLINK;
 	localNLAddr.nl_groups   = CN_IDX_PROC;
@@ -213,14 +368,14 @@ GECODNetlinkSocketInit(
     return errno;
 	}
   
-  // Using the msgBuffer, setup various structural pointers that make
+  // Using the first receive slot, setup various structural pointers that make
   // up our netlink packet:
-  nl_hdr = (struct nlmsghdr *)&nlSocket->msgBuffer;
+  nl_hdr = (struct nlmsghdr *)nlSocket->msgBuffers[0];
   cn_hdr = (struct cn_msg *)NLMSG_DATA(nl_hdr);
 	mcop_msg = (enum proc_cn_mcast_op*)&cn_hdr->data[0];
   
-  // Zero-out all fields of the packet (by zeroing the msgBuffer):
-  memset(&nlSocket->msgBuffer, 0, sizeof(nlSocket->msgBuffer));
+  // Zero-out all fields of the packet (by zeroing the slot):
+  memset(nlSocket->msgBuffers[0], 0, GECOD_NLMSG_DATAGRAM_SIZE);
   // Fill-in netlink header:
 	nl_hdr->nlmsg_len = GECOD_SEND_MESSAGE_LEN;
 	nl_hdr->nlmsg_type = NLMSG_DONE;
@@ -0,0 +1,129 @@
+/*
+ *  GECO — Grid Engine Cgroup Orchestrator
+ *  GECODPidRing.c
+ *
+ *  Lock-free single-producer, single-consumer ring of pids.
+ *
+ *  Copyright © 2015
+ *  Dr. Jeffrey Frey, University of Delaware
+ *
+ *  $Id$
+ */
+
+#ifndef GECOD_CACHE_LINE_SIZE
+#define GECOD_CACHE_LINE_SIZE   64
+#endif
+
+//
+// The producer and consumer each own one index, which the other side only
+// ever reads.  Each index shares a cache line with the owner's cached copy of
+// the opposite index, so in the common case neither side touches the other's
+// cache line except to publish (release) or refresh (acquire):
+//
+typedef struct {
+  unsigned int        capacity;
+  unsigned int        mask;
+  pid_t               *slots;
+  //
+  // Consumer side:
+  //
+  unsigned int        head __attribute__((aligned(GECOD_CACHE_LINE_SIZE)));
+  unsigned int        cachedTail;
+  //
+  // Producer side:
+  //
+  unsigned int        tail __attribute__((aligned(GECOD_CACHE_LINE_SIZE)));
+  unsigned int        cachedHead;
+} GECODPidRing;
+
+//
+
+GECODPidRing*
+GECODPidRingCreate(
+  unsigned int        minCapacity
+)
+{
+  GECODPidRing        *newRing = NULL;
+  unsigned int        capacity = 2;
+  
+  // The capacity is rounded up to a power of two so indices wrap with a mask:
+  if ( minCapacity > (1U << 30) ) return NULL;
+  while ( capacity < minCapacity ) capacity <<= 1;
+  
+  if ( posix_memalign((void**)&newRing, GECOD_CACHE_LINE_SIZE, sizeof(GECODPidRing)) == 0 ) {
+    if ( (newRing->slots = malloc(capacity * sizeof(pid_t))) ) {
+      newRing->capacity = capacity;
+      newRing->mask = capacity - 1;
+      newRing->head = newRing->cachedTail = 0;
+      newRing->tail = newRing->cachedHead = 0;
+    } else {
+      free((void*)newRing);
+      newRing = NULL;
+    }
+  }
+  return newRing;
+}
+
+//
+
+void
+GECODPidRingDestroy(
+  GECODPidRing        *theRing
+)
+{
+  free((void*)theRing->slots);
+  free((void*)theRing);
+}
+
+//
+
+unsigned int
+GECODPidRingPush(
+  GECODPidRing        *theRing,
+  const pid_t         *pids,
+  unsigned int        pidCount
+)
+{
+  //
+  // Producer only.  Returns the number of pids actually pushed, which is less
+  // than pidCount if the ring filled up:
+  //
+  unsigned int        tail = theRing->tail;
+  unsigned int        space = theRing->capacity - (tail - theRing->cachedHead);
+  unsigned int        i;
+  
+  if ( space < pidCount ) {
+    theRing->cachedHead = __atomic_load_n(&theRing->head, __ATOMIC_ACQUIRE);
+    space = theRing->capacity - (tail - theRing->cachedHead);
+    if ( space < pidCount ) pidCount = space;
+  }
+  for ( i = 0; i < pidCount; i++ ) theRing->slots[(tail + i) & theRing->mask] = pids[i];
+  if ( pidCount ) __atomic_store_n(&theRing->tail, tail + pidCount, __ATOMIC_RELEASE);
+  return pidCount;
+}
+
+//
+
+unsigned int
+GECODPidRingPop(
+  GECODPidRing        *theRing,
+  pid_t               *pids,
+  unsigned int        maxPids
+)
+{
+  //
+  // Consumer only.  Returns the number of pids copied to pids:
+  //
+  unsigned int        head = theRing->head;
+  unsigned int        count = theRing->cachedTail - head;
+  unsigned int        i;
+  
+  if ( count < maxPids ) {
+    theRing->cachedTail = __atomic_load_n(&theRing->tail, __ATOMIC_ACQUIRE);
+    count = theRing->cachedTail - head;
+  }
+  if ( count > maxPids ) count = maxPids;
+  for ( i = 0; i < count; i++ ) pids[i] = theRing->slots[(head + i) & theRing->mask];
+  if ( count ) __atomic_store_n(&theRing->head, head + count, __ATOMIC_RELEASE);
+  return count;
+}
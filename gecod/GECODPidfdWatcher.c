@@ -0,0 +1,223 @@
+/*
+ *  GECO — Grid Engine Cgroup Orchestrator
+ *  GECODPidfdWatcher.c
+ *
+ *  Polling sources that watch individual pids for termination by way of
+ *  pidfd_open(), as an alternative to the netlink proc connector.
+ *
+ *  Copyright © 2015
+ *  Dr. Jeffrey Frey, University of Delaware
+ *
+ *  $Id$
+ */
+
+#include <sys/syscall.h>
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+//
+
+typedef struct {
+  int                 fd;
+  pid_t               pid;
+  bool                hasExited;
+} GECODPidfdWatcher;
+
+//
+// If a pidfd cannot be opened for some pid, exit tracking falls back to the
+// netlink socket, which main() provides (uninitialized) along with its
+// settings:
+//
+static GECODNetlinkSocket *GECODPidfdFallbackSocket = NULL;
+static pid_t GECODPidfdFallbackPidWatermark = 0;
+static int GECODPidfdFallbackRcvBufSize = 0;
+
+//
+
+int
+GECODPidfdOpen(
+  pid_t     aPid
+)
+{
+  return (int)syscall(SYS_pidfd_open, aPid, 0);
+}
+
+//
+
+bool
+GECODPidfdIsSupported(void)
+{
+  int       fd = GECODPidfdOpen(getpid());
+  
+  if ( fd >= 0 ) {
+    close(fd);
+    return true;
+  }
+  return false;
+}
+
+//
+
+void
+GECODPidfdWatcherSetFallback(
+  GECODNetlinkSocket  *nlSocket,
+  pid_t               pidWatermark,
+  int                 rcvBufSize
+)
+{
+  GECODPidfdFallbackSocket = nlSocket;
+  GECODPidfdFallbackPidWatermark = pidWatermark;
+  GECODPidfdFallbackRcvBufSize = rcvBufSize;
+}
+
+//
+
+void
+GECODPidfdWatcherDidExit(
+  GECODPidfdWatcher   *watcher
+)
+{
+  if ( ! watcher->hasExited ) {
+    GECOPidToJobIdMapJobCount jobCount;
+  
+    watcher->hasExited = true;
+    GECO_DEBUG("exit noted via pidfd %d for pid %ld", watcher->fd, (long int)watcher->pid);
+    GECODPidsDidExit(1, &watcher->pid, &jobCount, 1);
+  }
+}
+
+//
+
+void
+GECODPidfdWatcherDestroySource(
+  GECOPollingSource   theSource
+)
+{
+  GECODPidfdWatcher   *watcher = (GECODPidfdWatcher*)theSource;
+  
+  if ( watcher->fd >= 0 ) close(watcher->fd);
+  free((void*)watcher);
+}
+
+//
+
+int
+GECODPidfdWatcherFileDescriptorForPolling(
+  GECOPollingSource   theSource
+)
+{
+  GECODPidfdWatcher   *watcher = (GECODPidfdWatcher*)theSource;
+  
+  return watcher->fd;
+}
+
+//
+
+void
+GECODPidfdWatcherDidReceiveDataAvailable(
+  GECOPollingSource   theSource,
+  GECORunloopRef      theRunloop
+)
+{
+  //
+  // A pidfd becomes readable once its process has exited:
+  //
+  GECODPidfdWatcherDidExit((GECODPidfdWatcher*)theSource);
+  GECORunloopRemovePollingSource(theRunloop, theSource);
+}
+
+//
+
+void
+GECODPidfdWatcherDidReceiveClose(
+  GECOPollingSource   theSource,
+  GECORunloopRef      theRunloop
+)
+{
+  //
+  // Newer kernels also signal EPOLLHUP once the process has been reaped:
+  //
+  GECODPidfdWatcherDidExit((GECODPidfdWatcher*)theSource);
+}
+
+//
+
+GECOPollingSourceCallbacks    GECODPidfdWatcherCallbacks = {
+                                            .destroySource = GECODPidfdWatcherDestroySource,
+                                            .fileDescriptorForPolling = GECODPidfdWatcherFileDescriptorForPolling,
+                                            .shouldSourceClose = NULL,
+                                            .willRemoveAsSource = NULL,
+                                            .didAddAsSource = NULL,
+                                            .didBeginPolling = NULL,
+                                            .didReceiveDataAvailable = GECODPidfdWatcherDidReceiveDataAvailable,
+                                            .didEndPolling = NULL,
+                                            .didReceiveClose = GECODPidfdWatcherDidReceiveClose,
+                                            .didRemoveAsSource = NULL
+                                          };
+
+//
+
+void
+GECODPidfdWatcherFallBackToNetlink(
+  GECORunloopRef      theRunloop
+)
+{
+  int                 rc;
+  
+  if ( ! GECODPidfdFallbackSocket ) return;
+  rc = GECODNetlinkSocketInit(GECODPidfdFallbackSocket, GECODPidfdFallbackPidWatermark, GECODPidfdFallbackRcvBufSize);
+  if ( rc == 0 ) {
+    GECORunloopAddPollingSource(theRunloop, GECODPidfdFallbackSocket, &GECODNetlinkSocketCallbacks, 0);
+    GECODExitTrackingMode = GECODExitTrackingNetlink;
+    GECO_WARN("GECODPidfdWatcherFallBackToNetlink: now tracking pid exits via netlink socket");
+  } else {
+    GECO_ERROR("GECODPidfdWatcherFallBackToNetlink: unable to create netlink socket (errno = %d)", rc);
+  }
+  GECODPidfdFallbackSocket = NULL;
+  
+  // Exits that happened before the netlink socket was listening are caught
+  // by reconciliation:
+  GECODReconcilerSchedule(theRunloop);
+}
+
+//
+
+bool
+GECODPidfdWatcherAddPid(
+  GECORunloopRef      theRunloop,
+  pid_t               aPid
+)
+{
+  GECODPidfdWatcher   *watcher;
+  int                 fd = GECODPidfdOpen(aPid);
+  
+  if ( fd < 0 ) {
+    if ( errno == ESRCH ) {
+      //
+      // Already gone; let reconciliation release it rather than doing so from
+      // within the caller's context:
+      //
+      GECO_DEBUG("GECODPidfdWatcherAddPid: pid %ld exited before it could be watched", (long int)aPid);
+      GECODReconcilerSchedule(theRunloop);
+      return true;
+    }
+    GECO_ERROR("GECODPidfdWatcherAddPid: unable to open pidfd for pid %ld (errno = %d)", (long int)aPid, errno);
+  } else if ( (watcher = malloc(sizeof(GECODPidfdWatcher))) ) {
+    watcher->fd = fd;
+    watcher->pid = aPid;
+    watcher->hasExited = false;
+    if ( GECORunloopAddPollingSource(theRunloop, watcher, &GECODPidfdWatcherCallbacks, GECOPollingSourceFlagStaticFileDescriptor | GECOPollingSourceFlagRemoveOnClose) ) {
+      GECO_DEBUG("GECODPidfdWatcherAddPid: watching pid %ld via pidfd %d", (long int)aPid, fd);
+      return true;
+    }
+    GECO_ERROR("GECODPidfdWatcherAddPid: unable to add pidfd %d for pid %ld to runloop", fd, (long int)aPid);
+    free((void*)watcher);
+    close(fd);
+  } else {
+    close(fd);
+  }
+  GECODPidfdWatcherFallBackToNetlink(theRunloop);
+  return false;
+}
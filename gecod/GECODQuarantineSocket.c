@@ -12,6 +12,318 @@
 
 
 
+//
+// Each accepted connection is reference counted:  the accepting code holds one
+// reference and a job-started request awaiting cgroup init holds another.  The
+// descriptor is closed when the last reference goes away, so the connection
+// stays open until its acknowledgement has been sent.
+//
+typedef struct {
+  GECOQuarantineSocket    theSocket;
+  unsigned int            refCount;
+} GECODQuarantineConnection;
+
+typedef struct _GECODQuarantineSocketPendingJobStarted {
+  GECODQuarantineConnection *connection;
+  long int                  jobId, taskId;
+  pid_t                     jobPid;
+  struct _GECODQuarantineSocketPendingJobStarted *link;
+} GECODQuarantineSocketPendingJobStarted;
+
+//
+// Resource information for a job gecod does not know yet is fetched via qstat
+// on a worker thread.  Requests for that job which arrive in the meantime wait
+// on the same load rather than each running qstat:
+//
+typedef struct _GECODQuarantineSocketResourceLoad {
+  long int                                  jobId, taskId;
+  GECOResourceSetRef                        jobResources;
+  GECODQuarantineSocketPendingJobStarted    *waiting, *waitingTail;
+  struct _GECODQuarantineSocketResourceLoad *link;
+} GECODQuarantineSocketResourceLoad;
+
+static GECODQuarantineSocketResourceLoad *GECODQuarantineSocketResourceLoads = NULL;
+
+//
+
+GECODQuarantineConnection*
+GECODQuarantineConnectionCreate(
+  int                     connFd
+)
+{
+  GECODQuarantineConnection *connection = malloc(sizeof(GECODQuarantineConnection));
+  
+  if ( connection ) {
+    GECOQuarantineSocketInitWithFd(connFd, &connection->theSocket);
+    connection->refCount = 1;
+  }
+  return connection;
+}
+
+//
+
+GECODQuarantineConnection*
+GECODQuarantineConnectionRetain(
+  GECODQuarantineConnection *connection
+)
+{
+  connection->refCount++;
+  return connection;
+}
+
+//
+
+void
+GECODQuarantineConnectionRelease(
+  GECODQuarantineConnection *connection
+)
+{
+  if ( --connection->refCount == 0 ) {
+    close(connection->theSocket.socketFd);
+    GECO_INFO("completed, fd %d closed", connection->theSocket.socketFd);
+    free((void*)connection);
+  }
+}
+
+//
+
+void
+GECODQuarantineSocketSendAckJobStarted(
+  GECOQuarantineSocket    *theSocket,
+  long int                jobId,
+  long int                taskId,
+  pid_t                   jobPid,
+  bool                    ok
+)
+{
+  GECOQuarantineCommandRef    ackCommand = GECOQuarantineCommandAckJobStartedCreate(jobId, taskId, ok);
+  
+  if ( ackCommand ) {
+    if ( GECOQuarantineSocketSendCommand(theSocket, ackCommand) ) {
+      GECO_INFO("Job-started acknowledgement (%s) sent for %ld.%ld (pid %ld)", (ok ? "success" : "failure"), jobId, taskId, (long int)jobPid);
+    } else {
+      GECO_ERROR("Failed to send job-started acknowledgement (%s) for %ld.%ld (pid %ld)", (ok ? "success" : "failure"), jobId, taskId, (long int)jobPid);
+    }
+    GECOQuarantineCommandDestroy(ackCommand);
+  } else {
+    GECO_ERROR("Unable to create job-started acknowledgement command (%s) for %ld.%ld (pid %ld)", (ok ? "success" : "failure"), jobId, taskId, (long int)jobPid);
+  }
+}
+
+//
+
+void
+GECODQuarantineSocketJobCGroupInitDidComplete(
+  GECOJobRef        theJob,
+  bool              success,
+  const void        *context
+)
+{
+  GECODQuarantineSocketPendingJobStarted  *pending = (GECODQuarantineSocketPendingJobStarted*)context;
+  bool                                    ok = false;
+  
+  if ( success ) {
+    if ( GECOJobCGroupAddPid(theJob, pending->jobPid) ) {
+      long long int   startTime = 0;
+      
+      ok = true;
+      // Record the start time so that reconciliation can tell if the pid is reused:
+      GECOGetPidInfo(pending->jobPid, NULL, NULL, NULL, &startTime);
+      GECOPidToJobIdMapAddPidWithStartTime(GECODPidMappings, pending->jobPid, startTime, pending->jobId, pending->taskId);
+      if ( GECODExitTrackingMode == GECODExitTrackingPidfd ) GECODPidfdWatcherAddPid(GECODRunloop, pending->jobPid);
+    } else {
+      GECO_ERROR("GECODQuarantineSocketDidReceiveDataAvailable: failed to add pid %ld to cgroups for %ld.%ld", (long int)pending->jobPid, pending->jobId, pending->taskId);
+      GECOJobRelease(theJob);
+    }
+  } else {
+    GECO_ERROR("GECODQuarantineSocketDidReceiveDataAvailable: failed to init cgroups for %ld.%ld (pid %ld)", pending->jobId, pending->taskId, (long int)pending->jobPid);
+    GECOJobRelease(theJob);
+  }
+  
+  GECODQuarantineSocketSendAckJobStarted(&pending->connection->theSocket, pending->jobId, pending->taskId, pending->jobPid, ok);
+  GECODQuarantineConnectionRelease(pending->connection);
+  free((void*)pending);
+}
+
+//
+
+void
+GECODQuarantineSocketJobStartedContinue(
+  GECODQuarantineSocketPendingJobStarted  *pending,
+  GECOJobRef                              theJob
+)
+{
+  if ( theJob ) {
+    //
+    // The ack is sent once the cgroup init completes -- possibly much later,
+    // if cores have to be waited on:
+    //
+    GECOJobCGroupInitAsync(theJob, GECODRunloop, GECODQuarantineSocketJobCGroupInitDidComplete, pending);
+  } else {
+    GECO_ERROR("GECODQuarantineSocketDidReceiveDataAvailable: no job information available for %ld.%ld (pid %ld)", pending->jobId, pending->taskId, (long int)pending->jobPid);
+    GECODQuarantineSocketSendAckJobStarted(&pending->connection->theSocket, pending->jobId, pending->taskId, pending->jobPid, false);
+    GECODQuarantineConnectionRelease(pending->connection);
+    free((void*)pending);
+  }
+}
+
+//
+
+bool
+GECODQuarantineSocketShouldLoadResourcesOnWorker(
+  long int      jobId,
+  long int      taskId
+)
+{
+  char          path[PATH_MAX];
+  
+  //
+  // Only qstat is slow enough to be worth handing off; the resource cache
+  // file and existing job objects are dealt with inline:
+  //
+  if ( ! GECODWorkersAreEnabled() || (GECODJobCreationFunction != GECOJobCreateWithJobIdentifier) ) return false;
+  if ( GECOJobGetExistingObjectForJobIdentifier(jobId, taskId) ) return false;
+  if ( snprintf(path, sizeof(path), "%s/resources/%ld.%ld", GECOGetStateDir(), jobId, ((taskId <= 0) ? 1 : taskId)) >= sizeof(path) ) return false;
+  return ! GECOIsFile(path);
+}
+
+//
+
+void
+GECODQuarantineSocketLoadResources(
+  void                                *context
+)
+{
+  //
+  // Runs on a worker thread:
+  //
+  GECODQuarantineSocketResourceLoad   *load = (GECODQuarantineSocketResourceLoad*)context;
+  GECOResourceSetCreateFailure        failureReason = GECOResourceSetCreateFailureNone;
+  
+  GECO_INFO("loading resource information for %ld.%ld via qstat", load->jobId, load->taskId);
+  load->jobResources = GECOResourceSetCreate(load->jobId, load->taskId, 5, &failureReason);
+  if ( ! load->jobResources ) {
+    GECO_ERROR("GECODQuarantineSocketLoadResources: failed to find resource information for job %ld.%ld (reason = %d)", load->jobId, load->taskId, failureReason);
+  }
+}
+
+//
+
+void
+GECODQuarantineSocketLoadResourcesDidComplete(
+  void                                    *context
+)
+{
+  GECODQuarantineSocketResourceLoad       *load = (GECODQuarantineSocketResourceLoad*)context;
+  GECODQuarantineSocketResourceLoad       **loadPtr = &GECODQuarantineSocketResourceLoads;
+  GECODQuarantineSocketPendingJobStarted  *pending = load->waiting, *next;
+  GECOJobRef                              theJob = NULL;
+  
+  while ( *loadPtr && (*loadPtr != load) ) loadPtr = &(*loadPtr)->link;
+  if ( *loadPtr ) *loadPtr = load->link;
+  
+  if ( load->jobResources ) {
+    theJob = GECOJobCreateWithJobIdentifierAndResourceSet(load->jobId, load->taskId, load->jobResources);
+    if ( theJob ) {
+      // Every waiting request beyond the first holds its own reference:
+      for ( next = pending->link; next; next = next->link ) GECOJobRetain(theJob);
+    }
+  }
+  while ( pending ) {
+    next = pending->link;
+    GECODQuarantineSocketJobStartedContinue(pending, theJob);
+    pending = next;
+  }
+  free((void*)load);
+}
+
+//
+
+bool
+GECODQuarantineSocketLoadResourcesOnWorker(
+  GECODQuarantineSocketPendingJobStarted  *pending
+)
+{
+  GECODQuarantineSocketResourceLoad       *load = GECODQuarantineSocketResourceLoads;
+  
+  while ( load ) {
+    if ( (load->jobId == pending->jobId) && (load->taskId == pending->taskId) ) {
+      GECO_DEBUG("GECODQuarantineSocketLoadResourcesOnWorker: %ld.%ld (pid %ld) waiting on resource load already in progress", pending->jobId, pending->taskId, (long int)pending->jobPid);
+      load->waitingTail->link = pending;
+      load->waitingTail = pending;
+      return true;
+    }
+    load = load->link;
+  }
+  if ( ! GECODQuarantineSocketShouldLoadResourcesOnWorker(pending->jobId, pending->taskId) ) return false;
+  if ( ! (load = malloc(sizeof(GECODQuarantineSocketResourceLoad))) ) return false;
+  
+  load->jobId = pending->jobId;
+  load->taskId = pending->taskId;
+  load->jobResources = NULL;
+  load->waiting = load->waitingTail = pending;
+  load->link = GECODQuarantineSocketResourceLoads;
+  GECODQuarantineSocketResourceLoads = load;
+  GECODWorkSubmit(load->jobId, load->taskId, GECODQuarantineSocketLoadResources, GECODQuarantineSocketLoadResourcesDidComplete, load);
+  return true;
+}
+
+//
+
+void
+GECODQuarantineConnectionProcessCommand(
+  GECODQuarantineConnection *connection
+)
+{
+  GECOQuarantineCommandRef  theCommand = NULL;
+  
+  if ( GECOQuarantineSocketRecvCommand(&connection->theSocket, &theCommand) ) {
+    GECOQuarantineCommandId theCommandId = GECOQuarantineCommandGetCommandId(theCommand);
+    
+    switch ( theCommandId ) {
+    
+      case GECOQuarantineCommandIdJobStarted: {
+        long int              jobId = GECOQuarantineCommandJobStartedGetJobId(theCommand),
+                              taskId = GECOQuarantineCommandJobStartedGetTaskId(theCommand);
+        pid_t                 jobPid = GECOQuarantineCommandJobStartedGetJobPid(theCommand);
+        GECODQuarantineSocketPendingJobStarted  *pending = malloc(sizeof(GECODQuarantineSocketPendingJobStarted));
+        
+        if ( pending ) {
+          pending->connection = GECODQuarantineConnectionRetain(connection);
+          pending->jobId = jobId;
+          pending->taskId = taskId;
+          pending->jobPid = jobPid;
+          pending->link = NULL;
+          //
+          // See if we can reconstitute some job information; a qstat lookup is
+          // done off the runloop when worker threads are available:
+          //
+          if ( ! GECODQuarantineSocketLoadResourcesOnWorker(pending) ) {
+            GECODQuarantineSocketJobStartedContinue(pending, GECODJobCreationFunction(jobId, taskId));
+          }
+        } else {
+          GECO_ERROR("GECODQuarantineSocketDidReceiveDataAvailable: unable to allocate pending job-started record for %ld.%ld (pid %ld)", jobId, taskId, (long int)jobPid);
+          GECODQuarantineSocketSendAckJobStarted(&connection->theSocket, jobId, taskId, jobPid, false);
+        }
+        break;
+      }
+      
+      default:
+        GECO_ERROR("GECODQuarantineSocketDidReceiveDataAvailable: unexpected command %u on fd %d", theCommandId, connection->theSocket.socketFd);
+        break;
+    
+    }
+    
+    GECOQuarantineCommandDestroy(theCommand);
+  }
+}
+
+//
+#if 0
+#pragma mark -
+#endif
+//
+
 int
 GECODQuarantineSocketFileDescriptorForPolling(
   GECOPollingSource   theSource
@@ -34,64 +346,16 @@ GECODQuarantineSocketDidReceiveDataAvailable(
   int                         connFd = accept(src->socketFd, NULL, NULL);
   
   if ( connFd >= 0 ) {
-    GECOQuarantineSocket      theSocket;
-    GECOQuarantineCommandRef  theCommand = NULL;
+    GECODQuarantineConnection *connection = GECODQuarantineConnectionCreate(connFd);
     
-    GECO_INFO("GECODQuarantineSocketDidReceiveDataAvailable: connection accepted on fd %d", connFd);
-    GECOQuarantineSocketInitWithFd(connFd, &theSocket);
-    if ( GECOQuarantineSocketRecvCommand(&theSocket, &theCommand) ) {
-    
-      switch ( GECOQuarantineCommandGetCommandId(theCommand) ) {
-      
-        case GECOQuarantineCommandIdJobStarted: {
-          //
-          // See if we can reconstitute some job information:
-          //
-          bool                  ok = false;
-          long int              jobId = GECOQuarantineCommandJobStartedGetJobId(theCommand),
-                                taskId = GECOQuarantineCommandJobStartedGetTaskId(theCommand);
-          pid_t                 jobPid = GECOQuarantineCommandJobStartedGetJobPid(theCommand);
-          GECOJobRef            theJob = GECODJobCreationFunction(jobId, taskId);
-          
-          if ( theJob ) {
-            if ( GECOJobCGroupInit(theJob, GECODRunloop) ) {
-              if ( GECOJobCGroupAddPid(theJob, jobPid) ) {
-                ok = true;
-                GECOPidToJobIdMapAddPid(GECODPidMappings, jobPid, jobId, taskId);
-              } else {
-                GECO_ERROR("GECODQuarantineSocketDidReceiveDataAvailable: failed to add pid %ld to cgroups for %ld.%ld", (long int)jobPid, jobId, taskId);
-                GECOJobRelease(theJob);
-              }
-            } else {
-              GECO_ERROR("GECODQuarantineSocketDidReceiveDataAvailable: failed to init cgroups for %ld.%ld (pid %ld)", jobId, taskId, (long int)jobPid);
-              GECOJobRelease(theJob);
-            }
-          } else {
-            GECO_ERROR("GECODQuarantineSocketDidReceiveDataAvailable: no job information available for %ld.%ld (pid %ld)", jobId, taskId, (long int)jobPid);
-          }
-          
-          GECOQuarantineCommandRef    ackCommand = GECOQuarantineCommandAckJobStartedCreate(jobId, taskId, ok);
-          
-          if ( ackCommand ) {
-            if ( GECOQuarantineSocketSendCommand(&theSocket, ackCommand) ) {
-              GECO_INFO("Job-started acknowledgement (%s) sent for %ld.%ld", (ok ? "success" : "failure"), jobId, taskId);
-            } else {
-              GECO_ERROR("Failed to send job-started acknowledgement (%s) for %ld.%ld", (ok ? "success" : "failure"), jobId, taskId);
-            }
-            GECOQuarantineCommandDestroy(ackCommand);
-          } else {
-            GECO_ERROR("Unable to create job-started acknowledgement command (%s) for %ld.%ld", (ok ? "success" : "failure"), jobId, taskId);
-          }
-          break;
-        }
-      
-      }
-      
-      GECOQuarantineCommandDestroy(theCommand);
+    if ( ! connection ) {
+      GECO_ERROR("GECODQuarantineSocketDidReceiveDataAvailable: unable to allocate connection record for fd %d", connFd);
+      close(connFd);
+      return;
     }
- 
-    close(connFd);
-    GECO_INFO("completed, fd %d closed", connFd);
+    GECO_INFO("GECODQuarantineSocketDidReceiveDataAvailable: connection accepted on fd %d", connFd);
+    GECODQuarantineConnectionProcessCommand(connection);
+    GECODQuarantineConnectionRelease(connection);
   } else {
     GECO_ERROR("GECODQuarantineSocketDidReceiveDataAvailable: failed to accept connection (errno = %d)", errno);
   }
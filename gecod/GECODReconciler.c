@@ -0,0 +1,348 @@
+/*
+ *  GECO — Grid Engine Cgroup Orchestrator
+ *  GECODReconciler.c
+ *
+ *  Release tracked pids whose exit notifications were lost.
+ *
+ *  Copyright © 2015
+ *  Dr. Jeffrey Frey, University of Delaware
+ *
+ *  $Id$
+ */
+
+#include <time.h>
+
+//
+// A reconciliation pass is broken into slices, each of which runs from a
+// runloop timer and stops once it has used GECOD_RECONCILE_SLICE_BUDGET
+// seconds:
+//
+#ifndef GECOD_RECONCILE_SLICE_BUDGET
+#define GECOD_RECONCILE_SLICE_BUDGET      0.002
+#endif
+
+#ifndef GECOD_RECONCILE_SLICE_INTERVAL
+#define GECOD_RECONCILE_SLICE_INTERVAL    0.05
+#endif
+
+#ifndef GECOD_RECONCILE_PROCS_BUFFER_SIZE
+#define GECOD_RECONCILE_PROCS_BUFFER_SIZE 4096
+#endif
+
+//
+
+void
+GECODPidsDidExit(
+  unsigned int              pidCount,
+  const pid_t               *pids,
+  GECOPidToJobIdMapJobCount *jobCounts,
+  unsigned int              maxJobCounts
+)
+{
+  //
+  // Drop the mappings for all exited pids we know about in one pass, then
+  // release each affected job once per pid:
+  //
+  unsigned int              jobCount = GECOPidToJobIdMapRemovePids(GECODPidMappings, pidCount, pids, jobCounts, maxJobCounts);
+  unsigned int              i;
+  
+  for ( i = 0; i < jobCount; i++ ) {
+    long int                jobId = jobCounts[i].jobId, taskId = jobCounts[i].taskId;
+    unsigned int            jobPidCount = jobCounts[i].pidCount;
+    GECOJobRef              theJob = GECOJobGetExistingObjectForJobIdentifier(jobId, taskId);
+  
+    GECO_DEBUG("%u exited pid%s => (%ld,%ld)", jobPidCount, ((jobPidCount == 1) ? "" : "s"), jobId, taskId);
+    if ( theJob ) {
+      GECO_DEBUG("job %p released %u time%s", theJob, jobPidCount, ((jobPidCount == 1) ? "" : "s"));
+      while ( jobPidCount-- ) GECOJobRelease(theJob);
+    } else {
+      // The job is gone, so any pids still mapped to it are stale:
+      unsigned int          staleCount = GECOPidToJobIdMapRemoveJobAndTaskId(GECODPidMappings, jobId, taskId);
+  
+      GECO_DEBUG("job (%ld,%ld) no longer exists, dropped %u stale pid mapping%s", jobId, taskId, staleCount, ((staleCount == 1) ? "" : "s"));
+    }
+  }
+}
+
+//
+#if 0
+#pragma mark -
+#endif
+//
+
+typedef struct {
+  GECORunloopTimerRef   theTimer;
+  bool                  shouldRestart;
+  //
+  // Position in the job table and statistics for the pass in progress:
+  //
+  unsigned int          jobCursor;
+  unsigned int          jobCount, staleCount, sliceCount;
+  //
+  // Scratch space, grown as needed:
+  //
+  pid_t                 *pids;
+  unsigned int          pidCapacity;
+  pid_t                 *procs;
+  unsigned int          procCapacity;
+  char                  *procsBuffer;
+  size_t                procsBufferSize;
+} GECODReconciler;
+
+static GECODReconciler GECODReconcilerState = {
+                          .theTimer = NULL,
+                          .shouldRestart = false,
+                          .jobCursor = 0,
+                          .jobCount = 0, .staleCount = 0, .sliceCount = 0,
+                          .pids = NULL, .pidCapacity = 0,
+                          .procs = NULL, .procCapacity = 0,
+                          .procsBuffer = NULL, .procsBufferSize = 0
+                        };
+
+//
+
+int
+__GECODReconcilerPidCompare(
+  const void    *p1,
+  const void    *p2
+)
+{
+  pid_t         pid1 = *((const pid_t*)p1), pid2 = *((const pid_t*)p2);
+  
+  return ( pid1 < pid2 ) ? -1 : ((pid1 > pid2) ? 1 : 0);
+}
+
+//
+
+bool
+__GECODReconcilerGrowPids(
+  pid_t         **pids,
+  unsigned int  *capacity,
+  unsigned int  minCapacity
+)
+{
+  unsigned int  newCapacity = ( *capacity ) ? *capacity : 16;
+  pid_t         *newPids;
+  
+  while ( newCapacity < minCapacity ) newCapacity *= 2;
+  if ( (newPids = realloc(*pids, newCapacity * sizeof(pid_t))) ) {
+    *pids = newPids;
+    *capacity = newCapacity;
+    return true;
+  }
+  return false;
+}
+
+//
+
+bool
+__GECODReconcilerReadCGroupProcs(
+  GECODReconciler       *r,
+  long int              jobId,
+  long int              taskId,
+  unsigned int          *procCount
+)
+{
+  //
+  // The kernel's view of the job:  the cgroup.procs file of the first managed
+  // subsystem that has one.  Pids are added to every managed subsystem, so any
+  // one of them will do.
+  //
+  GECOCGroupSubsystem   subsystem;
+  
+  for ( subsystem = GECOCGroupSubsystem_min; subsystem < GECOCGroupSubsystem_max; subsystem++ ) {
+    if ( GECOCGroupGetSubsystemIsManaged(subsystem) ) {
+      size_t            bufferLen;
+  
+      while ( true ) {
+        if ( r->procsBufferSize == 0 ) {
+          if ( ! (r->procsBuffer = malloc(GECOD_RECONCILE_PROCS_BUFFER_SIZE)) ) return false;
+          r->procsBufferSize = GECOD_RECONCILE_PROCS_BUFFER_SIZE;
+        }
+        bufferLen = r->procsBufferSize - 1;
+        if ( ! GECOCGroupReadLeaf(subsystem, jobId, taskId, "cgroup.procs", r->procsBuffer, &bufferLen) ) break;
+        if ( bufferLen < r->procsBufferSize - 1 ) {
+          char          *p = r->procsBuffer, *endp;
+          unsigned int  n = 0;
+  
+          r->procsBuffer[bufferLen] = '\0';
+          while ( *p ) {
+            long int    aPid = strtol(p, &endp, 10);
+  
+            if ( endp == p ) break;
+            if ( (n == r->procCapacity) && ! __GECODReconcilerGrowPids(&r->procs, &r->procCapacity, n + 1) ) return false;
+            r->procs[n++] = (pid_t)aPid;
+            p = endp;
+          }
+          qsort(r->procs, n, sizeof(pid_t), __GECODReconcilerPidCompare);
+          *procCount = n;
+          return true;
+        } else {
+          // The buffer may have truncated the list, so try again with more room:
+          char          *newBuffer = realloc(r->procsBuffer, 2 * r->procsBufferSize);
+  
+          if ( ! newBuffer ) return false;
+          r->procsBuffer = newBuffer;
+          r->procsBufferSize *= 2;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+//
+
+bool
+__GECODReconcilerPidHasExited(
+  pid_t           aPid
+)
+{
+  long long int   recordedStartTime = 0, startTime;
+  
+  if ( GECOPidToJobIdMapGetStartTimeForPid(GECODPidMappings, aPid, &recordedStartTime) && (recordedStartTime > 0) ) {
+    //
+    // A different start time means the pid has been recycled:
+    //
+    if ( ! GECOGetPidInfo(aPid, NULL, NULL, NULL, &startTime) ) return true;
+    if ( startTime != recordedStartTime ) {
+      GECO_DEBUG("pid %ld start time %lld != %lld, pid was reused", (long int)aPid, startTime, recordedStartTime);
+      return true;
+    }
+    return false;
+  }
+  return ( (kill(aPid, 0) != 0) && (errno == ESRCH) );
+}
+
+//
+
+unsigned int
+__GECODReconcilerReconcileJob(
+  GECODReconciler           *r,
+  long int                  jobId,
+  long int                  taskId
+)
+{
+  GECOPidToJobIdMapJobCount jobCount;
+  unsigned int              pidCount, procCount = 0, staleCount = 0, i;
+  bool                      hasProcs;
+  
+  pidCount = GECOPidToJobIdMapGetPidsForJobAndTaskId(GECODPidMappings, jobId, taskId, r->pids, r->pidCapacity);
+  if ( pidCount > r->pidCapacity ) {
+    if ( __GECODReconcilerGrowPids(&r->pids, &r->pidCapacity, pidCount) ) {
+      pidCount = GECOPidToJobIdMapGetPidsForJobAndTaskId(GECODPidMappings, jobId, taskId, r->pids, r->pidCapacity);
+    } else {
+      pidCount = r->pidCapacity;
+    }
+  }
+  if ( pidCount == 0 ) return 0;
+  
+  //
+  // Anything still in the job's cgroup is alive and ours; only the remainder
+  // need to be checked individually:
+  //
+  hasProcs = __GECODReconcilerReadCGroupProcs(r, jobId, taskId, &procCount);
+  for ( i = 0; i < pidCount; i++ ) {
+    if ( hasProcs && bsearch(&r->pids[i], r->procs, procCount, sizeof(pid_t), __GECODReconcilerPidCompare) ) continue;
+    if ( __GECODReconcilerPidHasExited(r->pids[i]) ) r->pids[staleCount++] = r->pids[i];
+  }
+  if ( staleCount ) {
+    GECO_INFO("GECODReconciler: %u of %u pid%s tracked for %ld.%ld had exited unnoticed", staleCount, pidCount, ((pidCount == 1) ? "" : "s"), jobId, taskId);
+    // All of the pids belong to one job, so a single count suffices:
+    GECODPidsDidExit(staleCount, r->pids, &jobCount, 1);
+  }
+  return staleCount;
+}
+
+//
+
+double
+__GECODReconcilerElapsed(
+  struct timespec   *t0
+)
+{
+  struct timespec   t1;
+  
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  return (t1.tv_sec - t0->tv_sec) + 1e-9 * (t1.tv_nsec - t0->tv_nsec);
+}
+
+//
+
+void
+GECODReconcilerTimerFired(
+  GECORunloopTimerRef   theTimer,
+  GECORunloopRef        theRunloop,
+  const void            *context
+)
+{
+  GECODReconciler       *r = (GECODReconciler*)context;
+  struct timespec       t0;
+  bool                  isComplete = false;
+  
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  r->sliceCount++;
+  do {
+    unsigned int              jobCursor = r->jobCursor;
+    GECOPidToJobIdMapJobCount job;
+  
+    if ( GECOPidToJobIdMapGetJobs(GECODPidMappings, &r->jobCursor, &job, 1) == 0 ) {
+      isComplete = true;
+    } else {
+      r->jobCount++;
+      r->staleCount += __GECODReconcilerReconcileJob(r, job.jobId, job.taskId);
+      if ( ! GECOPidToJobIdMapHasJobAndTaskId(GECODPidMappings, job.jobId, job.taskId) ) {
+        //
+        // Dropping the job's last pid shifts later jobs back into the slot just
+        // visited, so revisit it:
+        //
+        r->jobCursor = jobCursor;
+      } else if ( r->jobCursor == 0 ) {
+        isComplete = true;
+      }
+    }
+  } while ( ! isComplete && (__GECODReconcilerElapsed(&t0) < GECOD_RECONCILE_SLICE_BUDGET) );
+  
+  if ( isComplete ) {
+    GECO_INFO("GECODReconciler: pass complete, %u stale pid%s released across %u job%s in %u slice%s",
+        r->staleCount, ((r->staleCount == 1) ? "" : "s"),
+        r->jobCount, ((r->jobCount == 1) ? "" : "s"),
+        r->sliceCount, ((r->sliceCount == 1) ? "" : "s")
+      );
+    r->jobCursor = r->jobCount = r->staleCount = r->sliceCount = 0;
+    if ( r->shouldRestart ) {
+      // More events were lost while this pass was underway:
+      r->shouldRestart = false;
+    } else {
+      GECORunloopInvalidateTimer(theRunloop, theTimer);
+      r->theTimer = NULL;
+    }
+  }
+}
+
+//
+
+void
+GECODReconcilerSchedule(
+  GECORunloopRef      theRunloop
+)
+{
+  GECODReconciler     *r = &GECODReconcilerState;
+  
+  if ( r->theTimer ) {
+    //
+    // Pids already visited by the pass in progress could be affected, so
+    // another pass will follow it:
+    //
+    r->shouldRestart = true;
+  } else {
+    r->jobCursor = r->jobCount = r->staleCount = r->sliceCount = 0;
+    r->shouldRestart = false;
+    r->theTimer = GECORunloopAddTimer(theRunloop, GECOD_RECONCILE_SLICE_INTERVAL, true, GECODReconcilerTimerFired, r);
+    if ( r->theTimer ) {
+      GECO_INFO("GECODReconciler: reconciliation of %u tracked pid%s scheduled", GECOPidToJobIdMapGetCount(GECODPidMappings), ((GECOPidToJobIdMapGetCount(GECODPidMappings) == 1) ? "" : "s"));
+    } else {
+      GECO_ERROR("GECODReconciler: unable to schedule reconciliation timer");
+    }
+  }
+}
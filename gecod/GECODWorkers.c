@@ -0,0 +1,329 @@
+/*
+ *  GECO — Grid Engine Cgroup Orchestrator
+ *  GECODWorkers.c
+ *
+ *  Worker threads that run slow, self-contained work (e.g. qstat lookups)
+ *  off the runloop, with completions delivered back on the runloop.
+ *
+ *  Copyright © 2015
+ *  Dr. Jeffrey Frey, University of Delaware
+ *
+ *  $Id$
+ */
+
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+//
+// The work function runs on a worker thread and so must not touch any of the
+// job, cgroup, or pid-mapping state; the completion runs on the runloop and
+// may:
+//
+typedef void (*GECODWorkFunction)(void *context);
+typedef void (*GECODWorkCompletion)(void *context);
+
+typedef struct _GECODWorkItem {
+  GECODWorkFunction       work;
+  GECODWorkCompletion     completion;
+  void                    *context;
+  struct _GECODWorkItem   *link;
+} GECODWorkItem;
+
+//
+// Each worker services its own FIFO.  Work is assigned to a worker by job id,
+// so all work for a given job runs in submission order:
+//
+typedef struct {
+  pthread_t               thread;
+  pthread_mutex_t         lock;
+  pthread_cond_t          hasWork;
+  GECODWorkItem           *head, *tail;
+  bool                    shouldExit;
+} GECODWorker;
+
+typedef struct {
+  unsigned int            workerCount;
+  GECODWorker             *workers;
+  //
+  // Finished items awaiting their completion on the runloop:
+  //
+  pthread_mutex_t         completedLock;
+  GECODWorkItem           *completedHead, *completedTail;
+  int                     notifyFd;
+} GECODWorkerPool;
+
+static GECODWorkerPool GECODWorkers = {
+                          .workerCount = 0,
+                          .workers = NULL,
+                          .completedLock = PTHREAD_MUTEX_INITIALIZER,
+                          .completedHead = NULL, .completedTail = NULL,
+                          .notifyFd = -1
+                        };
+
+//
+
+void*
+GECODWorkerThread(
+  void                    *context
+)
+{
+  GECODWorker             *worker = (GECODWorker*)context;
+  
+  pthread_mutex_lock(&worker->lock);
+  while ( true ) {
+    GECODWorkItem         *item;
+  
+    while ( ! worker->head && ! worker->shouldExit ) pthread_cond_wait(&worker->hasWork, &worker->lock);
+    if ( worker->shouldExit ) break;
+  
+    item = worker->head;
+    if ( ! (worker->head = item->link) ) worker->tail = NULL;
+    pthread_mutex_unlock(&worker->lock);
+  
+    item->work(item->context);
+  
+    item->link = NULL;
+    pthread_mutex_lock(&GECODWorkers.completedLock);
+    if ( GECODWorkers.completedTail ) {
+      GECODWorkers.completedTail->link = item;
+    } else {
+      GECODWorkers.completedHead = item;
+    }
+    GECODWorkers.completedTail = item;
+    pthread_mutex_unlock(&GECODWorkers.completedLock);
+    eventfd_write(GECODWorkers.notifyFd, 1);
+  
+    pthread_mutex_lock(&worker->lock);
+  }
+  pthread_mutex_unlock(&worker->lock);
+  return NULL;
+}
+
+//
+
+void
+GECODWorkersDestroySource(
+  GECOPollingSource       theSource
+)
+{
+  if ( GECODWorkers.notifyFd >= 0 ) {
+    close(GECODWorkers.notifyFd);
+    GECODWorkers.notifyFd = -1;
+  }
+}
+
+//
+
+int
+GECODWorkersFileDescriptorForPolling(
+  GECOPollingSource       theSource
+)
+{
+  return GECODWorkers.notifyFd;
+}
+
+//
+
+void
+GECODWorkersDidReceiveDataAvailable(
+  GECOPollingSource       theSource,
+  GECORunloopRef          theRunloop
+)
+{
+  GECODWorkItem           *item;
+  eventfd_t               notifyCount;
+  
+  eventfd_read(GECODWorkers.notifyFd, &notifyCount);
+  
+  pthread_mutex_lock(&GECODWorkers.completedLock);
+  item = GECODWorkers.completedHead;
+  GECODWorkers.completedHead = GECODWorkers.completedTail = NULL;
+  pthread_mutex_unlock(&GECODWorkers.completedLock);
+  
+  while ( item ) {
+    GECODWorkItem         *next = item->link;
+  
+    if ( item->completion ) item->completion(item->context);
+    free((void*)item);
+    item = next;
+  }
+}
+
+//
+
+GECOPollingSourceCallbacks    GECODWorkersCallbacks = {
+                                            .destroySource = GECODWorkersDestroySource,
+                                            .fileDescriptorForPolling = GECODWorkersFileDescriptorForPolling,
+                                            .shouldSourceClose = NULL,
+                                            .willRemoveAsSource = NULL,
+                                            .didAddAsSource = NULL,
+                                            .didBeginPolling = NULL,
+                                            .didReceiveDataAvailable = GECODWorkersDidReceiveDataAvailable,
+                                            .didEndPolling = NULL,
+                                            .didReceiveClose = NULL,
+                                            .didRemoveAsSource = NULL
+                                          };
+
+//
+
+bool
+GECODWorkersAreEnabled(void)
+{
+  return ( GECODWorkers.workerCount > 0 );
+}
+
+//
+
+void
+GECODWorkSubmit(
+  long int                jobId,
+  long int                taskId,
+  GECODWorkFunction       work,
+  GECODWorkCompletion     completion,
+  void                    *context
+)
+{
+  GECODWorkItem           *item = NULL;
+  
+  if ( GECODWorkers.workerCount && (item = malloc(sizeof(GECODWorkItem))) ) {
+    GECODWorker           *worker = &GECODWorkers.workers[((unsigned long int)jobId * 31 + (unsigned long int)taskId) % GECODWorkers.workerCount];
+  
+    item->work = work;
+    item->completion = completion;
+    item->context = context;
+    item->link = NULL;
+  
+    pthread_mutex_lock(&worker->lock);
+    if ( worker->tail ) {
+      worker->tail->link = item;
+    } else {
+      worker->head = item;
+    }
+    worker->tail = item;
+    pthread_cond_signal(&worker->hasWork);
+    pthread_mutex_unlock(&worker->lock);
+  } else {
+    // No workers (or no memory), so do it all right now:
+    work(context);
+    if ( completion ) completion(context);
+  }
+}
+
+//
+
+bool
+GECODWorkersStart(
+  GECORunloopRef          theRunloop,
+  unsigned int            workerCount
+)
+{
+  sigset_t                allSignals, oldSignals;
+  unsigned int            i;
+  
+  if ( workerCount == 0 ) {
+    GECO_INFO("GECODWorkersStart: no worker threads, all job setup is done on the runloop");
+    return true;
+  }
+  GECODWorkers.notifyFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if ( GECODWorkers.notifyFd < 0 ) {
+    GECO_ERROR("GECODWorkersStart: unable to create eventfd (errno = %d)", errno);
+    return false;
+  }
+  if ( ! (GECODWorkers.workers = calloc(workerCount, sizeof(GECODWorker))) ) {
+    GECO_ERROR("GECODWorkersStart: unable to allocate %u workers", workerCount);
+    goto failure;
+  }
+  if ( ! GECORunloopAddPollingSource(theRunloop, &GECODWorkers, &GECODWorkersCallbacks, GECOPollingSourceFlagStaticFileDescriptor) ) {
+    GECO_ERROR("GECODWorkersStart: unable to add completion polling source to runloop");
+    goto failure;
+  }
+  
+  //
+  // Signals must be fielded by the main thread, where they interrupt the
+  // runloop:
+  //
+  sigfillset(&allSignals);
+  pthread_sigmask(SIG_BLOCK, &allSignals, &oldSignals);
+  for ( i = 0; i < workerCount; i++ ) {
+    GECODWorker           *worker = &GECODWorkers.workers[i];
+    int                   rc;
+  
+    pthread_mutex_init(&worker->lock, NULL);
+    pthread_cond_init(&worker->hasWork, NULL);
+    if ( (rc = pthread_create(&worker->thread, NULL, GECODWorkerThread, worker)) != 0 ) {
+      GECO_WARN("GECODWorkersStart: unable to create worker thread %u (errno = %d)", i, rc);
+      pthread_cond_destroy(&worker->hasWork);
+      pthread_mutex_destroy(&worker->lock);
+      break;
+    }
+    GECODWorkers.workerCount++;
+  }
+  pthread_sigmask(SIG_SETMASK, &oldSignals, NULL);
+  if ( GECODWorkers.workerCount == 0 ) {
+    GECO_ERROR("GECODWorkersStart: no worker threads could be started");
+    //
+    // Removing the polling source also closes notifyFd, leaving the pool as it
+    // was before this call:
+    //
+    GECORunloopRemovePollingSource(theRunloop, &GECODWorkers);
+    free((void*)GECODWorkers.workers);
+    GECODWorkers.workers = NULL;
+    return false;
+  }
+  GECO_INFO("GECODWorkersStart: %u worker thread%s started", GECODWorkers.workerCount, ((GECODWorkers.workerCount == 1) ? "" : "s"));
+  return true;
+  
+failure:
+  if ( GECODWorkers.workers ) free((void*)GECODWorkers.workers);
+  GECODWorkers.workers = NULL;
+  close(GECODWorkers.notifyFd);
+  GECODWorkers.notifyFd = -1;
+  return false;
+}
+
+//
+
+void
+GECODWorkersShutdown(void)
+{
+  //
+  // Each worker finishes whatever it is running and then exits.  Anything
+  // still queued or awaiting completion is discarded -- this only happens as
+  // gecod exits:
+  //
+  unsigned int            i, workerCount = GECODWorkers.workerCount;
+  
+  if ( ! workerCount ) return;
+  GECODWorkers.workerCount = 0;
+  for ( i = 0; i < workerCount; i++ ) {
+    GECODWorker           *worker = &GECODWorkers.workers[i];
+  
+    pthread_mutex_lock(&worker->lock);
+    worker->shouldExit = true;
+    pthread_cond_signal(&worker->hasWork);
+    pthread_mutex_unlock(&worker->lock);
+  }
+  for ( i = 0; i < workerCount; i++ ) {
+    GECODWorker           *worker = &GECODWorkers.workers[i];
+  
+    pthread_join(worker->thread, NULL);
+    while ( worker->head ) {
+      GECODWorkItem       *item = worker->head;
+  
+      worker->head = item->link;
+      free((void*)item);
+    }
+    pthread_cond_destroy(&worker->hasWork);
+    pthread_mutex_destroy(&worker->lock);
+  }
+  while ( GECODWorkers.completedHead ) {
+    GECODWorkItem         *item = GECODWorkers.completedHead;
+  
+    GECODWorkers.completedHead = item->link;
+    free((void*)item);
+  }
+  GECODWorkers.completedTail = NULL;
+  free((void*)GECODWorkers.workers);
+  GECODWorkers.workers = NULL;
+  GECO_DEBUG("GECODWorkersShutdown: %u worker thread%s joined", workerCount, ((workerCount == 1) ? "" : "s"));
+}
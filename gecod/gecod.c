@@ -56,6 +56,24 @@ static unsigned int GECODDefaultSendTimeout = GECOD_SEND_TIMEOUT;
 
 static const char *GECODDefaultQuarantineSocket = GECOD_QUARANTINE_SOCKET;
 
+#ifndef GECOD_PID_WATERMARK
+#define GECOD_PID_WATERMARK         0
+#endif
+
+static int GECODDefaultPidWatermark = GECOD_PID_WATERMARK;
+
+#ifndef GECOD_NETLINK_RCVBUF
+#define GECOD_NETLINK_RCVBUF        (4 * 1024 * 1024)
+#endif
+
+static int GECODDefaultNetlinkRcvBuf = GECOD_NETLINK_RCVBUF;
+
+#ifndef GECOD_WORKER_THREADS
+#define GECOD_WORKER_THREADS        2
+#endif
+
+static int GECODDefaultWorkerThreads = GECOD_WORKER_THREADS;
+
 //
 
 static GECORunloopRef GECODRunloop = NULL;
@@ -64,8 +82,35 @@ static GECOJobRef (*GECODJobCreationFunction)(long int, long int) = GECOJobCreat
 
 static GECOPidToJobIdMapRef GECODPidMappings = NULL;
 
+//
+// How exits of quarantined job pids are noticed:  the netlink proc connector
+// sees every exit on the node, a pidfd per job pid sees only the ones we care
+// about (but requires pidfd_open(), Linux 5.3 and later):
+//
+typedef enum {
+  GECODExitTrackingNetlink = 0,
+  GECODExitTrackingPidfd
+} GECODExitTracking;
+
+static GECODExitTracking GECODExitTrackingMode = GECODExitTrackingNetlink;
+
+static volatile sig_atomic_t GECODShouldRescanCpusetBindings = 0;
+static volatile sig_atomic_t GECODShouldReloadTopology = 0;
+
+#include "GECODReconciler.c"
+
+#include "GECODNetlinkFilter.c"
+
 #include "GECODNetlinkSocket.c"
 
+#include "GECODPidRing.c"
+
+#include "GECODNetlinkIngest.c"
+
+#include "GECODPidfdWatcher.c"
+
+#include "GECODWorkers.c"
+
 #include "GECODQuarantineSocket.c"
 
 #include <getopt.h>
@@ -86,7 +131,12 @@ enum {
   GECODCliOptQuarantineSocket = 'Q',
   GECODCliOptReceiveTimeout   = 'R',
   GECODCliOptSendTimeout      = 't',
-  GECODCliOptNoQstat          = 1001
+  GECODCliOptNoQstat          = 1001,
+  GECODCliOptPidWatermark     = 1002,
+  GECODCliOptNetlinkRcvBuf    = 1003,
+  GECODCliOptExitTracking     = 1004,
+  GECODCliOptWorkerThreads    = 1005,
+  GECODCliOptNoIngestThread   = 1006
 };
 
 const char *GECODCliOptString = "hvqe:d:Dp:l?r:S:m:s:Q:R:t:";
@@ -108,6 +158,11 @@ const struct option GECODCliOpts[] = {
                   { "receive-timeout",      required_argument,    NULL,         GECODCliOptReceiveTimeout },
                   { "send-timeout",         required_argument,    NULL,         GECODCliOptSendTimeout },
                   { "no-qstat",             no_argument,          NULL,         GECODCliOptNoQstat },
+                  { "pid-watermark",        required_argument,    NULL,         GECODCliOptPidWatermark },
+                  { "netlink-rcvbuf",       required_argument,    NULL,         GECODCliOptNetlinkRcvBuf },
+                  { "exit-tracking",        required_argument,    NULL,         GECODCliOptExitTracking },
+                  { "worker-threads",       required_argument,    NULL,         GECODCliOptWorkerThreads },
+                  { "no-ingest-thread",     no_argument,          NULL,         GECODCliOptNoIngestThread },
                   { NULL,                   0,                    0,             0  }
                 };
 
@@ -165,6 +220,24 @@ usage(
       "                                       the qmaster via qstat and then cached for the duration\n"
       "                                       of the job; set this flag if you pre-create the cached\n"
       "                                       copy inside the state directory\n"
+      "  --pid-watermark #                    ignore exit events for pids below this value; the\n"
+      "                                       kernel never recycles pids below 300, so values up to\n"
+      "                                       that are always safe (default: %d)\n"
+      "  --netlink-rcvbuf #                   size (in bytes) of the netlink socket's receive\n"
+      "                                       queue; 0 keeps the kernel default (default: %d)\n"
+      "  --exit-tracking <mode>               how job process exits are noticed:\n"
+      "                                         netlink   proc connector events for all\n"
+      "                                                   processes on the node (default)\n"
+      "                                         pidfd     a pidfd per quarantined job pid; falls\n"
+      "                                                   back to netlink if unavailable\n"
+      "  --worker-threads #                   number of threads that fetch resource information\n"
+      "                                       for new jobs via qstat; 0 does so on the main\n"
+      "                                       thread (default: %d)\n"
+      "  --no-ingest-thread                   drain the netlink socket on the main thread rather\n"
+      "                                       than on a dedicated thread\n"
+      "\n"
+      "  Sending SIGUSR1 to gecod forces a full rescan of the per-job cpuset bindings;\n"
+      "  SIGHUP forces the hardware topology to be reloaded.\n"
       "\n"
       "  <bind-info> can be:\n"
       "    service:<named service>|#          open quarantine socket bound to localhost and the given\n"
@@ -181,7 +254,10 @@ usage(
       GECOCGroupGetSubGroup(),
       GECODDefaultStartupRetryCount, (GECODDefaultStartupRetryCount == 1) ? "retry" : "retries",
       GECODDefaultReceiveTimeout, (GECODDefaultReceiveTimeout == 1) ? "second" : "seconds",
-      GECODDefaultSendTimeout, (GECODDefaultSendTimeout == 1) ? "second" : "seconds"
+      GECODDefaultSendTimeout, (GECODDefaultSendTimeout == 1) ? "second" : "seconds",
+      GECODDefaultPidWatermark,
+      GECODDefaultNetlinkRcvBuf,
+      GECODDefaultWorkerThreads
     );
   
   subsysId = GECOCGroupSubsystem_min;
@@ -224,6 +300,16 @@ GECODHandleSignal(
     
     case SIGALRM:
       break;
+    
+    case SIGUSR1: {
+      GECODShouldRescanCpusetBindings = 1;
+      break;
+    }
+    
+    case SIGHUP: {
+      GECODShouldReloadTopology = 1;
+      break;
+    }
       
     case SIGTERM:
     case SIGINT: {
@@ -236,6 +322,27 @@ GECODHandleSignal(
 
 //
 
+void
+GECODSignalRequestObserver(
+  GECORunloopObserver   theObserver,
+  GECORunloopRef        theRunloop,
+  GECORunloopActivity   theActivity
+)
+{
+  if ( GECODShouldReloadTopology ) {
+    GECODShouldReloadTopology = 0;
+    GECO_INFO("reload of hardware topology requested");
+    GECOCGroupInvalidateTopology();
+  }
+  if ( GECODShouldRescanCpusetBindings ) {
+    GECODShouldRescanCpusetBindings = 0;
+    GECO_INFO("rescan of cpuset bindings requested");
+    if ( ! GECOCGroupScanActiveCpusetBindings() ) GECO_ERROR("failed to rescan cpuset bindings");
+  }
+}
+
+//
+
 int
 main(
   int                 argc,
@@ -257,6 +364,10 @@ main(
   unsigned int        receiveTimeout = GECODDefaultReceiveTimeout;
   unsigned int        sendTimeout = GECODDefaultSendTimeout;
   bool                shouldDisableQstat = false;
+  int                 pidWatermark = GECODDefaultPidWatermark;
+  int                 netlinkRcvBuf = GECODDefaultNetlinkRcvBuf;
+  int                 workerThreads = GECODDefaultWorkerThreads;
+  bool                shouldUseIngestThread = true;
   
   if ( getuid() != 0 ) {
 		fprintf(stderr, "ERROR:  %s must be run as root\n", exe);
@@ -403,6 +514,59 @@ main(
         shouldDisableQstat = true;
         break;
       }
+      
+      case GECODCliOptPidWatermark: {
+        int     tmpInt;
+        
+        if ( optarg && *optarg && GECO_strtoi(optarg, &tmpInt, NULL) && (tmpInt >= 0) ) {
+          pidWatermark = tmpInt;
+        } else {
+          fprintf(stderr, "ERROR:  invalid value provided with --pid-watermark: %s\n", optarg);
+          exit(EINVAL);
+        }
+        break;
+      }
+      
+      case GECODCliOptExitTracking: {
+        if ( optarg && (strcasecmp(optarg, "netlink") == 0) ) {
+          GECODExitTrackingMode = GECODExitTrackingNetlink;
+        } else if ( optarg && (strcasecmp(optarg, "pidfd") == 0) ) {
+          GECODExitTrackingMode = GECODExitTrackingPidfd;
+        } else {
+          fprintf(stderr, "ERROR:  invalid value provided with --exit-tracking: %s\n", optarg);
+          exit(EINVAL);
+        }
+        break;
+      }
+      
+      case GECODCliOptNetlinkRcvBuf: {
+        int     tmpInt;
+        
+        if ( optarg && *optarg && GECO_strtoi(optarg, &tmpInt, NULL) && (tmpInt >= 0) ) {
+          netlinkRcvBuf = tmpInt;
+        } else {
+          fprintf(stderr, "ERROR:  invalid value provided with --netlink-rcvbuf: %s\n", optarg);
+          exit(EINVAL);
+        }
+        break;
+      }
+      
+      case GECODCliOptWorkerThreads: {
+        int     tmpInt;
+        
+        if ( optarg && *optarg && GECO_strtoi(optarg, &tmpInt, NULL) && (tmpInt >= 0) ) {
+          workerThreads = tmpInt;
+        } else {
+          fprintf(stderr, "ERROR:  invalid value provided with --worker-threads: %s\n", optarg);
+          exit(EINVAL);
+        }
+        break;
+      }
+      
+      case GECODCliOptNoIngestThread: {
+        shouldUseIngestThread = false;
+        break;
+      }
 
     }
   }
@@ -415,8 +579,9 @@ main(
   }
   
   // Setup signal handling:
-  signal(SIGHUP, SIG_IGN);
+  signal(SIGHUP, GECODHandleSignal);
   signal(SIGALRM, GECODHandleSignal);
+  signal(SIGUSR1, GECODHandleSignal);
   signal(SIGTERM, GECODHandleSignal);
   signal(SIGINT, GECODHandleSignal);
   
@@ -494,6 +659,12 @@ retry_cgroup_init:
     }
   }
   
+  //
+  // Reconcile our core allocations against any per-job cpusets left behind by a previous
+  // instance; after this the in-memory allocation state is kept current incrementally:
+  //
+  if ( GECOCGroupGetSubsystemIsManaged(GECOCGroupSubsystem_cpuset) ) GECOCGroupScanActiveCpusetBindings();
+  
   GECOQuarantineSocket      quarantineSocket;
   GECODNetlinkSocket        nlSocket;
   bool                      ok;
@@ -506,8 +677,12 @@ retry_cgroup_init:
           sendTimeout,
           &quarantineSocket
         );
+  if ( (GECODExitTrackingMode == GECODExitTrackingPidfd) && ! GECODPidfdIsSupported() ) {
+    GECO_WARN("pidfd exit tracking is not available (errno = %d), using netlink instead", errno);
+    GECODExitTrackingMode = GECODExitTrackingNetlink;
+  }
   if ( ok ) {
-    rc = GECODNetlinkSocketInit(&nlSocket);
+    rc = ( GECODExitTrackingMode == GECODExitTrackingNetlink ) ? GECODNetlinkSocketInit(&nlSocket, pidWatermark, netlinkRcvBuf) : 0;
     
     if ( rc == 0 ) {
       // Create the runloop:
@@ -527,14 +702,37 @@ retry_cgroup_init:
           GECORunloopAddPollingSource(GECODRunloop, &quarantineSocket, &GECODQuarantineSocketCallbacks, GECOPollingSourceFlagStaticFileDescriptor);
           GECO_DEBUG("quarantine socket polling source added to runloop");
           
-          // Add the netlink socket to the runloop:
-          GECORunloopAddPollingSource(GECODRunloop, &nlSocket, &GECODNetlinkSocketCallbacks, 0);
-          GECO_DEBUG("netlink socket polling source added to runloop");
+          if ( GECODExitTrackingMode == GECODExitTrackingNetlink ) {
+            if ( shouldUseIngestThread && GECODNetlinkIngestStart(GECODRunloop, &nlSocket) ) {
+              GECO_DEBUG("netlink ingest polling source added to runloop");
+            } else {
+              // Add the netlink socket to the runloop:
+              GECORunloopAddPollingSource(GECODRunloop, &nlSocket, &GECODNetlinkSocketCallbacks, 0);
+              GECO_DEBUG("netlink socket polling source added to runloop");
+            }
+          } else {
+            // Job pids get their own polling sources as they're quarantined:
+            GECODPidfdWatcherSetFallback(&nlSocket, pidWatermark, netlinkRcvBuf);
+            GECO_INFO("tracking job pid exits via pidfd");
+          }
+          
+          // Resource lookups for new jobs are handed off to worker threads.  The
+          // hostname is cached now, before any of them need it:
+          GECOGetHostname();
+          if ( ! GECODWorkersStart(GECODRunloop, workerThreads) ) {
+            GECO_WARN("unable to start worker threads, all job setup is done on the runloop");
+          }
+          
+          // Handle explicit rescan/reload requests delivered by signal:
+          GECORunloopAddObserver(GECODRunloop, GECODSignalRequestObserver, GECORunloopActivityAfterWait, GECODSignalRequestObserver, 0, true);
           
           // Run until something says we're done:
           GECO_DEBUG("entering runloop");
           rc = GECORunloopRun(GECODRunloop);
           
+          // No more handing off work:
+          GECODWorkersShutdown();
+          
           // Deinitialize the job management component:
           GECOJobDeinit();
           GECO_DEBUG("shutting down job management");
@@ -1,8 +1,8 @@
 /*
  *  GECO — Grid Engine Cgroup Orchestrator
- *  runloop-test.c
+ *  integer-set-test.c
  *  
- *  Standalone program that tests the GECORunloop functionality.
+ *  Standalone program that tests/benchmarks the GECOIntegerSet functionality.
  *
  *  Copyright © 2015
  *  Dr. Jeffrey Frey, University of Delaware
@@ -12,6 +12,46 @@
 
 #include "GECOIntegerSet.h"
 
+//
+
+#ifndef INTEGERSETTEST_TIMING_ROUNDS
+#define INTEGERSETTEST_TIMING_ROUNDS    1000000
+#endif
+
+//
+
+void
+integersettest_timing(
+  const char          *label,
+  GECOIntegerSetRef   setOfIntegers,
+  GECOInteger         low,
+  GECOInteger         high
+)
+{
+  unsigned int        count = GECOIntegerSetGetCount(setOfIntegers), round, hits = 0;
+  GECOInteger         span = high - low + 1, sum = 0;
+  struct timespec     t0, t1;
+  double              dtContains, dtIndex;
+  
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for ( round = 0; round < INTEGERSETTEST_TIMING_ROUNDS; round++ ) {
+    if ( GECOIntegerSetContains(setOfIntegers, low + (GECOInteger)((round * 2654435761U) % span)) ) hits++;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  dtContains = (t1.tv_sec - t0.tv_sec) + 1e-9 * (t1.tv_nsec - t0.tv_nsec);
+  
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for ( round = 0; round < INTEGERSETTEST_TIMING_ROUNDS; round++ ) {
+    sum += GECOIntegerSetGetIntegerAtIndex(setOfIntegers, (round * 2654435761U) % count);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  dtIndex = (t1.tv_sec - t0.tv_sec) + 1e-9 * (t1.tv_nsec - t0.tv_nsec);
+  
+  printf("%-12s contains: %8.1f ns/op (%u hits)   index: %8.1f ns/op (sum %ld)\n", label, 1e9 * dtContains / INTEGERSETTEST_TIMING_ROUNDS, hits, 1e9 * dtIndex / INTEGERSETTEST_TIMING_ROUNDS, sum);
+}
+
+//
+
 int
 main(
   int         argc,
@@ -22,10 +62,18 @@ main(
   int                   argn = 1;
   
   while ( argn < argc ) {
-    long int            value;
+    long int            value, highValue;
+    const char          *endPtr;
     
-    if ( GECO_strtol(argv[argn], &value, NULL) ) {
-      GECOIntegerSetAddInteger(initSet, value);
+    //
+    // Each argument is an integer or an inclusive range <low>:<high>
+    //
+    if ( GECO_strtol(argv[argn], &value, &endPtr) ) {
+      if ( (*endPtr == ':') && GECO_strtol(endPtr + 1, &highValue, NULL) ) {
+        GECOIntegerSetAddIntegerRange(initSet, value, highValue);
+      } else {
+        GECOIntegerSetAddInteger(initSet, value);
+      }
     }
     argn++;
   }
@@ -46,6 +94,77 @@ main(
   
   printf("%d in set: %d\n", 1014, GECOIntegerSetContains(duplSet, 1014));
   
+  //
+  // The constant copy must agree with the original set:
+  //
+  if ( GECOIntegerSetGetCount(initSet) ) {
+    GECOInteger         v = GECOIntegerSetGetIntegerAtIndex(initSet, 0) - 2;
+    GECOInteger         vMax = GECOIntegerSetGetIntegerAtIndex(initSet, GECOIntegerSetGetCount(initSet) - 1) + 2;
+    GECOIntegerSetRef   copySet = GECOIntegerSetCopy(duplSet);
+    unsigned int        i, errors = 0;
+    
+    if ( GECOIntegerSetGetCount(duplSet) != GECOIntegerSetGetCount(initSet) ) errors++;
+    for ( i = 0; i < GECOIntegerSetGetCount(initSet); i++ ) {
+      if ( GECOIntegerSetGetIntegerAtIndex(duplSet, i) != GECOIntegerSetGetIntegerAtIndex(initSet, i) ) errors++;
+    }
+    while ( v <= vMax ) {
+      if ( GECOIntegerSetContains(duplSet, v) != GECOIntegerSetContains(initSet, v) ) errors++;
+      if ( copySet && (GECOIntegerSetContains(copySet, v) != GECOIntegerSetContains(initSet, v)) ) errors++;
+      v++;
+    }
+    if ( copySet ) GECOIntegerSetDestroy(copySet);
+    printf("const copy mismatches: %u\n", errors);
+    
+    
+    //
+    // Set algebra against a second set that partially overlaps the first:
+    //
+    GECOIntegerSetRef   otherSet = GECOIntegerSetCreate();
+    
+    errors = 0;
+    for ( i = 0; i < GECOIntegerSetGetCount(initSet); i++ ) {
+      GECOInteger       w = GECOIntegerSetGetIntegerAtIndex(initSet, i);
+      
+      GECOIntegerSetAddInteger(otherSet, w + 3);
+      if ( (w % 4) == 0 ) GECOIntegerSetAddInteger(otherSet, w);
+    }
+    GECOIntegerSetRef   constOtherSet = GECOIntegerSetCreateConstantCopy(otherSet);
+    GECOIntegerSetRef   lhs[2] = { initSet, duplSet }, rhs[2] = { otherSet, constOtherSet };
+    unsigned int        l, r;
+    
+    for ( l = 0; l < 2; l++ ) {
+      for ( r = 0; r < 2; r++ ) {
+        GECOIntegerSetRef   unionSet = GECOIntegerSetCreateUnion(lhs[l], rhs[r]);
+        GECOIntegerSetRef   interSet = GECOIntegerSetCreateIntersection(lhs[l], rhs[r]);
+        GECOIntegerSetRef   diffSet = GECOIntegerSetCreateDifference(lhs[l], rhs[r]);
+        GECOInteger         common;
+        
+        for ( v = GECOIntegerSetGetIntegerAtIndex(initSet, 0) - 2; v <= vMax + 3; v++ ) {
+          bool              inL = GECOIntegerSetContains(lhs[l], v), inR = GECOIntegerSetContains(rhs[r], v);
+          
+          if ( GECOIntegerSetContains(unionSet, v) != (inL || inR) ) errors++;
+          if ( GECOIntegerSetContains(interSet, v) != (inL && inR) ) errors++;
+          if ( GECOIntegerSetContains(diffSet, v) != (inL && ! inR) ) errors++;
+        }
+        if ( GECOIntegerSetIntersectsAny(lhs[l], rhs[r], &common) ) {
+          if ( ! GECOIntegerSetGetCount(interSet) || (common != GECOIntegerSetGetIntegerAtIndex(interSet, 0)) ) errors++;
+        } else if ( GECOIntegerSetGetCount(interSet) ) {
+          errors++;
+        }
+        GECOIntegerSetDestroy(unionSet);
+        GECOIntegerSetDestroy(interSet);
+        GECOIntegerSetDestroy(diffSet);
+      }
+    }
+    GECOIntegerSetDestroy(constOtherSet);
+    GECOIntegerSetDestroy(otherSet);
+    printf("set algebra mismatches: %u\n", errors);
+    
+    printf("\n");
+    integersettest_timing("Integer set", initSet, GECOIntegerSetGetIntegerAtIndex(initSet, 0) - 2, vMax);
+    integersettest_timing("const copy", duplSet, GECOIntegerSetGetIntegerAtIndex(initSet, 0) - 2, vMax);
+  }
+  
   GECOIntegerSetDestroy(duplSet);
   GECOIntegerSetDestroy(initSet);
   
@@ -14,7 +14,8 @@
 
 #include <dirent.h>
 #include <sys/utsname.h>
-#include <glob.h>
+#include <sys/syscall.h>
+#include <stddef.h>
 
 //
 
@@ -605,48 +606,94 @@ GECOGetPidInfo(
 #endif
 //
 
-static GECOPidTree *GECOPidTreePool = NULL;
+//
+// All nodes of a tree (and their cmd strings, inline right after each node) are
+// bump-allocated out of a short list of chunks owned by the tree's root.  The root
+// node is the first field of the arena record, so destroying the tree is just a
+// walk of the chunk list.
+//
+#ifndef GECO_PIDTREE_ARENA_CHUNK_SIZE
+#define GECO_PIDTREE_ARENA_CHUNK_SIZE   (64 * 1024)
+#endif
+
+typedef struct __GECOPidTreeArenaChunk {
+  struct __GECOPidTreeArenaChunk  *link;
+  size_t                          capacity, used;
+  union {
+    GECOPidTree                   alignNode;
+    char                          bytes[1];
+  } storage;
+} GECOPidTreeArenaChunk;
+
+typedef struct {
+  GECOPidTree                     root;
+  GECOPidTreeArenaChunk           *chunks;
+  unsigned int                    nodeCount;
+} GECOPidTreeArena;
+
+#define GECO_PIDTREE_ARENA_ALIGN(S)  (((S) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+
+//
+
+GECOPidTree*
+__GECOPidTreeArenaCreate(void)
+{
+  GECOPidTreeArena      *newArena = malloc(sizeof(GECOPidTreeArena));
+  
+  if ( newArena ) {
+    newArena->root.pid = newArena->root.ppid = -1;
+    newArena->root.cmd = NULL;
+    newArena->root.parent = newArena->root.sibling = newArena->root.child = NULL;
+    newArena->chunks = NULL;
+    newArena->nodeCount = 0;
+  }
+  return (GECOPidTree*)newArena;
+}
 
 //
 
 GECOPidTree*
 __GECOPidTreeAlloc(
+  GECOPidTree     *theRoot,
   size_t          cmdLen
 )
 {
-  GECOPidTree     *newNode = NULL;
+  GECOPidTreeArena        *theArena = (GECOPidTreeArena*)theRoot;
+  GECOPidTreeArenaChunk   *chunk = theArena->chunks;
+  size_t                  nodeSize = GECO_PIDTREE_ARENA_ALIGN(sizeof(GECOPidTree) + (cmdLen ? cmdLen + 1 : 0));
+  GECOPidTree             *newNode;
   
-  if ( GECOPidTreePool ) {
-    newNode = GECOPidTreePool;
-    GECOPidTreePool = newNode->sibling;
-  } else {
-    newNode = malloc(sizeof(GECOPidTree));
-  }
-  if ( newNode ) {
-    newNode->pid = newNode->ppid = -1;
-    if ( cmdLen > 0 ) {
-      if ( ! (newNode->cmd = malloc(cmdLen + 1)) ) {
-        free((void*)newNode);
-        return NULL;
-      }
-    } else {
-      newNode->cmd = NULL;
-    }
-    newNode->parent = newNode->sibling = newNode->child = NULL;
+  if ( ! chunk || (chunk->capacity - chunk->used < nodeSize) ) {
+    //
+    // Each new chunk is twice the size of the previous one:
+    //
+    size_t                capacity = ( chunk ? 2 * chunk->capacity : GECO_PIDTREE_ARENA_CHUNK_SIZE );
+    
+    while ( capacity < nodeSize ) capacity *= 2;
+    if ( ! (chunk = malloc(offsetof(GECOPidTreeArenaChunk, storage) + capacity)) ) return NULL;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    chunk->link = theArena->chunks;
+    theArena->chunks = chunk;
   }
+  newNode = (GECOPidTree*)(chunk->storage.bytes + chunk->used);
+  chunk->used += nodeSize;
+  theArena->nodeCount++;
+  
+  newNode->pid = newNode->ppid = -1;
+  newNode->cmd = ( cmdLen ? (char*)newNode + sizeof(GECOPidTree) : NULL );
+  newNode->parent = newNode->sibling = newNode->child = NULL;
   return newNode;
 }
 
 //
 
-void
-__GECOPidTreeDealloc(
-  GECOPidTree   *aNode
+unsigned int
+GECOPidTreeGetNodeCount(
+  GECOPidTree     *theTree
 )
 {
-  if ( aNode->cmd ) free((void*)aNode->cmd);
-  aNode->sibling = GECOPidTreePool;
-  GECOPidTreePool = aNode;
+  return ((GECOPidTreeArena*)theTree)->nodeCount;
 }
 
 //
@@ -683,93 +730,209 @@ GECOPidTreeGetNodeWithPPid(
 
 //
 
+//
+// Size of the buffer into which /proc/<pid>/stat is read; only the leading fields
+// (through the ppid) are needed, so it need not hold the entire file:
+//
+#ifndef GECO_PROC_STAT_BUFFER_SIZE
+#define GECO_PROC_STAT_BUFFER_SIZE  512
+#endif
+
+//
+// Size of the buffer used for getdents64() calls against /proc:
+//
+#ifndef GECO_PROC_DIRENT_BUFFER_SIZE
+#define GECO_PROC_DIRENT_BUFFER_SIZE 32768
+#endif
+
+typedef struct {
+  uint64_t        d_ino;
+  int64_t         d_off;
+  unsigned short  d_reclen;
+  unsigned char   d_type;
+  char            d_name[];
+} GECOLinuxDirent64;
+
+//
+
+bool
+__GECOParseProcStat(
+  char            *buffer,
+  size_t          bufferLen,
+  pid_t           *pid,
+  const char      **comm,
+  size_t          *commLen,
+  pid_t           *ppid
+)
+{
+  char            *p = buffer, *end = buffer + bufferLen;
+  char            *commStart, *commEnd;
+  long int        value;
+  bool            isNegative = false;
+  
+  //
+  // The pid leads the line:
+  //
+  value = 0;
+  while ( (p < end) && isdigit(*p) ) value = 10 * value + (*p++ - '0');
+  if ( (p == buffer) || (p >= end) || (*p != ' ') ) return false;
+  *pid = value;
+  
+  //
+  // The comm field is wrapped in parentheses, but can itself contain spaces and
+  // parentheses; the kernel emits no other ')' characters after it, so the last
+  // one on the line is the real terminator:
+  //
+  if ( (++p >= end) || (*p != '(') ) return false;
+  commStart = ++p;
+  commEnd = end;
+  while ( --commEnd >= commStart ) if ( *commEnd == ')' ) break;
+  if ( commEnd < commStart ) return false;
+  if ( comm ) *comm = commStart;
+  if ( commLen ) *commLen = commEnd - commStart;
+  
+  //
+  // Skip the state character and pick up the ppid:
+  //
+  p = commEnd + 1;
+  if ( (end - p < 5) || (p[0] != ' ') || (p[2] != ' ') ) return false;
+  p += 3;
+  if ( *p == '-' ) {
+    isNegative = true;
+    p++;
+  }
+  value = 0;
+  while ( (p < end) && isdigit(*p) ) value = 10 * value + (*p++ - '0');
+  *ppid = isNegative ? -value : value;
+  return true;
+}
+
+//
+
 GECOPidTree*
 GECOPidTreeCreate(
   bool            shouldIncludeCmd
 )
 {
   GECOPidTree     *newTree = NULL;
-  GECOPidTree     *nodes = NULL;
-  glob_t          globData;
+  GECOPidTree     **nodes = NULL;
+  unsigned int    nodeCount = 0, nodeCapacity = 0;
+  bool            failed = false;
+  int             procFd = open("/proc", O_RDONLY | O_DIRECTORY);
+  
+  if ( procFd < 0 ) return NULL;
+  
+  newTree = __GECOPidTreeArenaCreate();
+  if ( ! newTree ) {
+    close(procFd);
+    return NULL;
+  }
+  newTree->pid = 0;
   
-  glob("/proc/[0-9]*", GLOB_NOSORT, NULL, &globData);
-  if ( globData.gl_pathc > 0 ) {
-    unsigned int  globIdx = 0;
-    bool          failed = false;
+  //
+  // Walk the numeric entries in /proc, reading each stat file into a fixed
+  // buffer and parsing the leading fields by hand:
+  //
+  while ( ! failed ) {
+    char          direntBuffer[GECO_PROC_DIRENT_BUFFER_SIZE];
+    long          direntBufferLen = syscall(SYS_getdents64, procFd, direntBuffer, sizeof(direntBuffer));
+    long          offset = 0;
     
-    while ( ! failed && (globIdx < globData.gl_pathc) ) {
-      char      procPath[64];
-      char      cmd[PATH_MAX];
-      FILE      *fPtr;
-      pid_t     pid, ppid;
+    if ( direntBufferLen <= 0 ) break;
+    while ( ! failed && (offset < direntBufferLen) ) {
+      GECOLinuxDirent64   *dirent = (GECOLinuxDirent64*)(direntBuffer + offset);
+      char                statPath[32];
+      char                statBuffer[GECO_PROC_STAT_BUFFER_SIZE];
+      ssize_t             statLen;
+      int                 statFd;
+      pid_t               pid, ppid;
+      const char          *comm;
+      size_t              commLen;
       
-      snprintf(procPath, sizeof(procPath), "%s/stat", globData.gl_pathv[globIdx++]);
-      fPtr = fopen(procPath, "r");
-      if ( ! fPtr ) continue;
-      if ( fscanf(fPtr, "%d %s %*c %d", &pid, cmd, &ppid) >= 3 ) {
-        GECOPidTree   *newNode = __GECOPidTreeAlloc(strlen(cmd));
+      offset += dirent->d_reclen;
+      if ( ! isdigit(dirent->d_name[0]) ) continue;
+      
+      snprintf(statPath, sizeof(statPath), "%s/stat", dirent->d_name);
+      if ( (statFd = openat(procFd, statPath, O_RDONLY)) < 0 ) continue;
+      statLen = read(statFd, statBuffer, sizeof(statBuffer));
+      close(statFd);
+      
+      if ( (statLen > 0) && __GECOParseProcStat(statBuffer, statLen, &pid, &comm, &commLen, &ppid) ) {
+        GECOPidTree       *newNode;
         
-        if ( ! newNode ) {
-          fclose(fPtr);
+        if ( nodeCount == nodeCapacity ) {
+          unsigned int    newCapacity = ( nodeCapacity ? 2 * nodeCapacity : 1024 );
+          GECOPidTree     **newNodes = realloc(nodes, newCapacity * sizeof(GECOPidTree*));
+          
+          if ( ! newNodes ) {
+            failed = true;
+            break;
+          }
+          nodes = newNodes;
+          nodeCapacity = newCapacity;
+        }
+        if ( ! (newNode = __GECOPidTreeAlloc(newTree, shouldIncludeCmd ? commLen : 0)) ) {
           failed = true;
           break;
-        } else {
-          newNode->pid = pid;
-          newNode->ppid = ppid;
-          strcpy((char*)newNode->cmd, cmd);
-          newNode->sibling = nodes;
-          nodes = newNode;
         }
+        newNode->pid = pid;
+        newNode->ppid = ppid;
+        if ( newNode->cmd ) {
+          memcpy(newNode->cmd, comm, commLen);
+          newNode->cmd[commLen] = '\0';
+        }
+        nodes[nodeCount++] = newNode;
       }
-      fclose(fPtr);
     }
   }
-  globfree(&globData);
+  close(procFd);
   
-  if ( nodes ) {
-    GECOPidTree       *foundNode = nodes, *prevNode = NULL;
+  if ( ! failed && nodeCount ) {
+    //
+    // Index the nodes by pid in an open-addressed hash table (at most half full)
+    // so that each node's parent can be found in constant time:
+    //
+    unsigned int    hashCapacity = 1, hashMask, i;
+    GECOPidTree     **hash;
     
-    // We now have a flat array of tree nodes.  Create the tree:
-    newTree = __GECOPidTreeAlloc(0);
-    if ( newTree ) {
-      newTree->pid = 0;
-      while ( nodes ) {
-        foundNode = nodes;
-        prevNode = NULL;
-        while ( foundNode ) {
-          GECOPidTree   *parent = GECOPidTreeGetNodeWithPid(newTree, foundNode->ppid);
+    while ( hashCapacity < 2 * nodeCount ) hashCapacity <<= 1;
+    hashMask = hashCapacity - 1;
+    if ( (hash = calloc(hashCapacity, sizeof(GECOPidTree*))) ) {
+      for ( i = 0; i < nodeCount; i++ ) {
+        unsigned int  slot = ((uint32_t)nodes[i]->pid * 2654435761U) & hashMask;
+        
+        while ( hash[slot] ) slot = (slot + 1) & hashMask;
+        hash[slot] = nodes[i];
+      }
+      for ( i = 0; i < nodeCount; i++ ) {
+        GECOPidTree   *node = nodes[i];
+        GECOPidTree   *parent = NULL;
+        
+        if ( node->ppid > 0 ) {
+          unsigned int  slot = ((uint32_t)node->ppid * 2654435761U) & hashMask;
           
-          if ( parent ) {
-            GECOPidTree *next = foundNode->sibling;
-            
-            // Remove this node from the list:
-            if ( prevNode ) {
-              prevNode->sibling = next;
-            } else {
-              nodes = next;
-            }
-            // Set parent pointer:
-            foundNode->parent = parent;
-            foundNode->child = NULL;
-            // Set as child of the parent:
-            foundNode->sibling = ( parent->child ? parent->child : NULL );
-            parent->child = foundNode;
-            foundNode = next;
-          } else {
-            prevNode = foundNode;
-            foundNode = foundNode->sibling;
-          }
+          while ( hash[slot] && (hash[slot]->pid != node->ppid) ) slot = (slot + 1) & hashMask;
+          parent = hash[slot];
         }
+        //
+        // Processes whose parent is pid 0 -- or whose parent exited while we were
+        // scanning -- hang off the root:
+        //
+        if ( ! parent ) parent = newTree;
+        node->parent = parent;
+        node->sibling = parent->child;
+        parent->child = node;
       }
+      free(hash);
     } else {
-      while ( nodes ) {
-        GECOPidTree   *next = nodes->sibling;
-        __GECOPidTreeDealloc(nodes);
-        nodes = next;
-      }
+      failed = true;
     }
   }
-  
+  if ( failed ) {
+    GECOPidTreeDestroy(newTree);
+    newTree = NULL;
+  }
+  if ( nodes ) free(nodes);
   return newTree;
 }
 
@@ -808,9 +971,186 @@ GECOPidTreeDestroy(
   GECOPidTree*  theTree
 )
 {
-  if ( theTree->sibling ) GECOPidTreeDestroy(theTree->sibling);
-  if ( theTree->child ) GECOPidTreeDestroy(theTree->child);
-  __GECOPidTreeDealloc(theTree);
+  GECOPidTreeArena        *theArena = (GECOPidTreeArena*)theTree;
+  GECOPidTreeArenaChunk   *chunk = theArena->chunks;
+  
+  while ( chunk ) {
+    GECOPidTreeArenaChunk *next = chunk->link;
+    
+    free((void*)chunk);
+    chunk = next;
+  }
+  free((void*)theArena);
+}
+
+//
+#if 0
+#pragma mark -
+#endif
+//
+
+//
+// Kernels built without CONFIG_PROC_CHILDREN lack /proc/<pid>/task/<tid>/children;
+// whether or not it's present is determined once, on first use:
+//
+static int GECOProcHasChildrenFiles = -1;
+
+bool
+__GECOProcHasChildrenFiles(void)
+{
+  if ( GECOProcHasChildrenFiles < 0 ) {
+    char      path[64];
+    
+    snprintf(path, sizeof(path), "/proc/%ld/task/%ld/children", (long int)getpid(), (long int)syscall(SYS_gettid));
+    GECOProcHasChildrenFiles = ( access(path, R_OK) == 0 ) ? 1 : 0;
+  }
+  return ( GECOProcHasChildrenFiles > 0 );
+}
+
+//
+
+bool
+__GECOEnumerateDescendantPidsInTree(
+  GECOPidTree               *theTree,
+  GECOPidEnumeratorCallback enumeratorCallback,
+  const void                *context
+)
+{
+  while ( theTree ) {
+    if ( ! enumeratorCallback(theTree->pid, context) ) {
+      // ESRCH is reserved for the top-level pid not existing:
+      if ( errno == ESRCH ) errno = ECANCELED;
+      return false;
+    }
+    if ( theTree->child && ! __GECOEnumerateDescendantPidsInTree(theTree->child, enumeratorCallback, context) ) return false;
+    theTree = theTree->sibling;
+  }
+  return true;
+}
+
+//
+
+bool
+__GECODescendantPidFound(
+  pid_t                     aPid,
+  GECOPidEnumeratorCallback enumeratorCallback,
+  const void                *context,
+  pid_t                     **pending,
+  unsigned int              *pendingCount,
+  unsigned int              *pendingCapacity
+)
+{
+  if ( ! enumeratorCallback(aPid, context) ) {
+    // ESRCH is reserved for the top-level pid not existing:
+    if ( errno == ESRCH ) errno = ECANCELED;
+    return false;
+  }
+  if ( *pendingCount == *pendingCapacity ) {
+    pid_t                   *newPending = realloc(*pending, 2 * *pendingCapacity * sizeof(pid_t));
+    
+    if ( ! newPending ) return false;
+    *pending = newPending;
+    *pendingCapacity *= 2;
+  }
+  (*pending)[(*pendingCount)++] = aPid;
+  return true;
+}
+
+//
+
+bool
+GECOEnumerateDescendantPids(
+  pid_t                     aPid,
+  GECOPidEnumeratorCallback enumeratorCallback,
+  const void                *context
+)
+{
+  pid_t                     *pending;
+  unsigned int              pendingCount = 0, pendingCapacity = 64;
+  bool                      rc = true;
+  
+  if ( ! __GECOProcHasChildrenFiles() ) {
+    GECOPidTree             *processTree = GECOPidTreeCreate(false);
+    
+    if ( processTree ) {
+      GECOPidTree           *subTree = GECOPidTreeGetNodeWithPid(processTree, aPid);
+      
+      if ( subTree ) {
+        if ( subTree->child ) rc = __GECOEnumerateDescendantPidsInTree(subTree->child, enumeratorCallback, context);
+      } else {
+        errno = ESRCH;
+        rc = false;
+      }
+      GECOPidTreeDestroy(processTree);
+    } else {
+      rc = false;
+    }
+    return rc;
+  }
+  
+  if ( ! (pending = malloc(pendingCapacity * sizeof(pid_t))) ) return false;
+  pending[pendingCount++] = aPid;
+  
+  //
+  // Depth-first walk:  every thread of a process can have children of its own, so the
+  // children file of each entry under /proc/<pid>/task is consulted:
+  //
+  while ( rc && pendingCount ) {
+    pid_t                   parentPid = pending[--pendingCount];
+    char                    path[64];
+    DIR                     *taskDir;
+    
+    snprintf(path, sizeof(path), "/proc/%ld/task", (long int)parentPid);
+    if ( ! (taskDir = opendir(path)) ) {
+      //
+      // The process exited; unless it was the top-level pid, that's not an error:
+      //
+      if ( parentPid == aPid ) {
+        errno = ESRCH;
+        rc = false;
+      }
+      continue;
+    }
+    
+    struct dirent           *taskItem;
+    
+    // The DIR* is private to this walk, so plain readdir() is safe:
+    while ( rc && (taskItem = readdir(taskDir)) ) {
+      char                  buffer[1024];
+      ssize_t               bufferLen;
+      long int              childPid = 0;
+      bool                  inPid = false;
+      int                   fd;
+      
+      if ( ! isdigit(taskItem->d_name[0]) ) continue;
+      snprintf(path, sizeof(path), "/proc/%ld/task/%ld/children", (long int)parentPid, strtol(taskItem->d_name, NULL, 10));
+      if ( (fd = open(path, O_RDONLY)) < 0 ) continue;
+      
+      //
+      // Space-separated list of pids, which may straddle read() calls:
+      //
+      while ( rc && (bufferLen = read(fd, buffer, sizeof(buffer))) > 0 ) {
+        char                *p = buffer, *end = buffer + bufferLen;
+        
+        while ( rc && (p < end) ) {
+          if ( isdigit(*p) ) {
+            childPid = 10 * childPid + (*p - '0');
+            inPid = true;
+          } else if ( inPid ) {
+            rc = __GECODescendantPidFound((pid_t)childPid, enumeratorCallback, context, &pending, &pendingCount, &pendingCapacity);
+            childPid = 0;
+            inPid = false;
+          }
+          p++;
+        }
+      }
+      close(fd);
+      if ( rc && inPid ) rc = __GECODescendantPidFound((pid_t)childPid, enumeratorCallback, context, &pending, &pendingCount, &pendingCapacity);
+    }
+    closedir(taskDir);
+  }
+  free(pending);
+  return rc;
 }
 
 //
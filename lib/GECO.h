@@ -323,6 +323,13 @@ typedef struct __GECOPidTree {
     Creates a new process tree from the /proc filesystem.  The tree is essentially
     a point-in-time snapshot of the real process tree (some processes may start/end
     while the tree is being created).
+    
+    The root of the tree is a placeholder node with pid 0.  Processes whose parent
+    could not be found (e.g. it exited during the scan) are attached to the root.
+    
+    If shouldIncludeCmd is true, each node's cmd field is set to the process' comm
+    (as present in /proc/<pid>/stat, without the enclosing parentheses); otherwise
+    it is NULL.
 */
 GECOPidTree* GECOPidTreeCreate(bool shouldIncludeCmd);
 
@@ -357,14 +364,55 @@ GECOPidTree* GECOPidTreeGetNodeWithPPid(GECOPidTree *theTree, pid_t ppid);
 */
 void GECOPidTreePrint(GECOPidTree *theTree, bool showChildren, bool showSiblings);
 
+/*!
+  @function GECOPidTreeGetNodeCount
+  @discussion
+    Returns the number of process nodes in theTree (not counting the root node).
+    Please note:  ONLY the root node returned by GECOPidTreeCreate() should be
+    passed to this function.
+*/
+unsigned int GECOPidTreeGetNodeCount(GECOPidTree *theTree);
+
 /*!
   @function GECOPidTreeDestroy
   @discussion
     Destroy theTree.  Please note:  ONLY the root node returned by GECOPidTreeCreate()
     should be passed to this function.
+    
+    All nodes of a tree are allocated in bulk alongside the root node, so no
+    node of the tree may be used after the tree is destroyed.
 */
 void GECOPidTreeDestroy(GECOPidTree* theTree);
 
+/*!
+  @typedef GECOPidEnumeratorCallback
+  @discussion
+    Type of a callback function used to enumerate process ids.
+    
+    The function should return boolean false to halt enumeration.
+*/
+typedef bool (*GECOPidEnumeratorCallback)(pid_t aPid, const void *context);
+
+/*!
+  @function GECOEnumerateDescendantPids
+  @discussion
+    Pass the pid of every descendant of aPid (children, grandchildren, etc.) to the
+    enumeratorCallback function; a parent is always passed before its own
+    children.
+    
+    Descendants are found by walking /proc/<pid>/task/<tid>/children, so the cost
+    scales with the size of aPid's subtree.  On kernels that lack those files a
+    full process tree is created via GECOPidTreeCreate() instead.
+    
+    Additional information can be passed to the callback function via the context pointer.
+  @result
+    Returns boolean true if aPid existed and all of its descendants were processed by
+    the callback without issue.  If aPid itself does not exist, errno is set to ESRCH;
+    descendants that exit during the walk are simply skipped, and ESRCH is never
+    reported on their account.
+*/
+bool GECOEnumerateDescendantPids(pid_t aPid, GECOPidEnumeratorCallback enumeratorCallback, const void *context);
+
 /*!
   @typedef GECODirectoryEnumeratorCallback
   @discussion
@@ -659,6 +659,10 @@ GECOCGroupDeinitForJobIdentifier(
                 rc = false;
               } else {
                 GECO_INFO("removed %s", path);
+                //
+                // With its cpuset subgroup gone, the job's cores are free again:
+                //
+                if ( subsystemId == GECOCGroupSubsystem_cpuset ) GECOCGroupDeallocateCoresForJobIdentifier(jobId, taskId);
               }
             }
           } else {
@@ -690,18 +694,26 @@ GECOCGroupAddTask(
 //
 
 bool
-__GECOCGroupAddTaskWalkPidTree(
-  GECOPidTree           *theTree,
-  const char            *tasksFile
+__GECOCGroupAddTaskDescendant(
+  pid_t                 aPid,
+  const void            *context
 )
 {
+  const char            *tasksFile = (const char*)context;
   char                  pidStr[32];
-  bool                  rc = __GECOCGroupWrite(tasksFile, pidStr, snprintf(pidStr, sizeof(pidStr), "%ld", (long int)theTree->pid));
-
-  GECO_INFO("task %ld %s to %s", (long int)theTree->pid, ( rc ? "added" : "not added" ), tasksFile);
-  if ( rc && theTree->child ) __GECOCGroupAddTaskWalkPidTree(theTree->child, tasksFile);
-  if ( rc && theTree->sibling ) __GECOCGroupAddTaskWalkPidTree(theTree->sibling, tasksFile);
-  return rc;
+  
+  if ( __GECOCGroupWrite(tasksFile, pidStr, snprintf(pidStr, sizeof(pidStr), "%ld", (long int)aPid)) ) {
+    GECO_INFO("task %ld added to %s", (long int)aPid, tasksFile);
+  } else if ( errno == ESRCH ) {
+    GECO_DEBUG("task %ld exited before it could be added to %s", (long int)aPid, tasksFile);
+  } else {
+    GECO_WARN("task %ld not added to %s (errno = %d)", (long int)aPid, tasksFile, errno);
+  }
+  //
+  // One descendant failing (most often because it has already exited) is no
+  // reason to leave the rest of the subtree out of the cgroup:
+  //
+  return true;
 }
 
 bool
@@ -740,25 +752,13 @@ GECOCGroupAddTaskAndChildren(
               GECO_INFO("task %ld added to %s", (long int)aPid, canonPath);
           
               // Add children?
-              if ( addChildPids ) {
-                GECOPidTree   *processTree = GECOPidTreeCreate(false);
-                
-                if ( processTree ) {
-                  GECOPidTree *subTree = GECOPidTreeGetNodeWithPid(processTree, aPid);
-                  
-                  if ( subTree ) {
-                    if ( subTree->child ) {
-                      __GECOCGroupAddTaskWalkPidTree(subTree->child, canonPath);
-                    }
-                  } else {
-                    GECO_ERROR("GECOCGroupAddTask: unable to find pid %ld in the process tree", (long int)aPid);
-                    rc = false;
-                  }
-                  GECOPidTreeDestroy(processTree);
+              if ( addChildPids && ! GECOEnumerateDescendantPids(aPid, __GECOCGroupAddTaskDescendant, canonPath) ) {
+                if ( errno == ESRCH ) {
+                  GECO_ERROR("GECOCGroupAddTask: unable to find pid %ld in the process tree", (long int)aPid);
                 } else {
-                  GECO_ERROR("GECOCGroupAddTask: unable to create process tree for pid %ld child addition (errno = %d)", (long int)aPid, errno);
-                  rc = false;
+                  GECO_ERROR("GECOCGroupAddTask: unable to enumerate descendants of pid %ld for child addition (errno = %d)", (long int)aPid, errno);
                 }
+                rc = false;
               }
             } else {
               GECO_ERROR("GECOCGroupAddTask: unable to add pid %ld to %s (errno = %d)", (long int)aPid, canonPath, errno);
@@ -786,25 +786,13 @@ GECOCGroupAddTaskAndChildren(
           GECO_INFO("task %ld added to %s", (long int)aPid, canonPath);
           
           // Add children?
-          if ( addChildPids ) {
-            GECOPidTree   *processTree = GECOPidTreeCreate(false);
-            
-            if ( processTree ) {
-              GECOPidTree *subTree = GECOPidTreeGetNodeWithPid(processTree, aPid);
-              
-              if ( subTree ) {
-                if ( subTree->child ) {
-                  __GECOCGroupAddTaskWalkPidTree(subTree->child, canonPath);
-                }
-              } else {
-                GECO_ERROR("GECOCGroupAddTask: unable to find pid %ld in the process tree", (long int)aPid);
-                rc = false;
-              }
-              GECOPidTreeDestroy(processTree);
+          if ( addChildPids && ! GECOEnumerateDescendantPids(aPid, __GECOCGroupAddTaskDescendant, canonPath) ) {
+            if ( errno == ESRCH ) {
+              GECO_ERROR("GECOCGroupAddTask: unable to find pid %ld in the process tree", (long int)aPid);
             } else {
-              GECO_ERROR("GECOCGroupAddTask: unable to create process tree for pid %ld child addition (errno = %d)", (long int)aPid, errno);
-              rc = false;
+              GECO_ERROR("GECOCGroupAddTask: unable to enumerate descendants of pid %ld for child addition (errno = %d)", (long int)aPid, errno);
             }
+            rc = false;
           }
         } else {
           GECO_ERROR("GECOCGroupAddTask: unable to add pid %ld to %s (errno = %d)", (long int)aPid, canonPath, errno);
@@ -1146,6 +1134,79 @@ GECOCGroupGetIsUnderOOM(
 
 static bool GECOCGroupHasScannedGECOCGroups = false;
 
+//
+// Per-job cpuset bindings:  the authoritative record of which cores have been
+// handed to which job.  A full scan of the cpuset subgroup only repopulates
+// this table; after that it is kept current by allocation, deallocation, and
+// the removal of per-job cgroups.
+//
+typedef struct {
+  long int          jobId, taskId;
+  hwloc_bitmap_t    cpuset;
+} GECOCGroupCpusetBinding;
+
+static GECOCGroupCpusetBinding  *GECOCGroupCpusetBindings = NULL;
+static unsigned int             GECOCGroupCpusetBindingCount = 0;
+static unsigned int             GECOCGroupCpusetBindingCapacity = 0;
+
+#ifndef GECOCGROUP_CPUSET_BINDING_GROWTH
+#define GECOCGROUP_CPUSET_BINDING_GROWTH 16
+#endif
+
+int
+__GECOCGroupCpusetBindingIndex(
+  long int          jobId,
+  long int          taskId
+)
+{
+  unsigned int      i = 0;
+  
+  while ( i < GECOCGroupCpusetBindingCount ) {
+    if ( (GECOCGroupCpusetBindings[i].jobId == jobId) && (GECOCGroupCpusetBindings[i].taskId == taskId) ) return i;
+    i++;
+  }
+  return -1;
+}
+
+bool
+__GECOCGroupCpusetBindingAdd(
+  long int          jobId,
+  long int          taskId,
+  hwloc_bitmap_t    theCpuset
+)
+{
+  if ( GECOCGroupCpusetBindingCount == GECOCGroupCpusetBindingCapacity ) {
+    unsigned int              newCapacity = GECOCGroupCpusetBindingCapacity + GECOCGROUP_CPUSET_BINDING_GROWTH;
+    GECOCGroupCpusetBinding   *newBindings = realloc(GECOCGroupCpusetBindings, newCapacity * sizeof(GECOCGroupCpusetBinding));
+    
+    if ( ! newBindings ) return false;
+    GECOCGroupCpusetBindings = newBindings;
+    GECOCGroupCpusetBindingCapacity = newCapacity;
+  }
+  GECOCGroupCpusetBindings[GECOCGroupCpusetBindingCount].jobId = jobId;
+  GECOCGroupCpusetBindings[GECOCGroupCpusetBindingCount].taskId = taskId;
+  GECOCGroupCpusetBindings[GECOCGroupCpusetBindingCount].cpuset = theCpuset;
+  GECOCGroupCpusetBindingCount++;
+  return true;
+}
+
+void
+__GECOCGroupCpusetBindingRemoveAtIndex(
+  unsigned int      index
+)
+{
+  hwloc_bitmap_free(GECOCGroupCpusetBindings[index].cpuset);
+  if ( index < --GECOCGroupCpusetBindingCount ) GECOCGroupCpusetBindings[index] = GECOCGroupCpusetBindings[GECOCGroupCpusetBindingCount];
+}
+
+void
+__GECOCGroupCpusetBindingRemoveAll(void)
+{
+  while ( GECOCGroupCpusetBindingCount > 0 ) hwloc_bitmap_free(GECOCGroupCpusetBindings[--GECOCGroupCpusetBindingCount].cpuset);
+}
+
+//
+
 hwloc_bitmap_t
 __GECOCGroupGetAllocatedCpuset(void)
 {
@@ -1190,11 +1251,13 @@ GECOCGroupScanActiveCpusetBindings(void)
   
     hwloc_bitmap_zero(__GECOCGroupGetAllocatedCpuset());
     hwloc_bitmap_fill(availableCpuset);
+    __GECOCGroupCpusetBindingRemoveAll();
     
     if ( gecoDir ) {
       struct dirent   item, *itemPtr;
       long int        jobId, taskId;
-      char            cpuInfo[PATH_MAX];
+      long int        *jobIds = NULL, *taskIds = NULL;
+      unsigned int    jobCount = 0, jobCapacity = 0;
       char            *bitmapStr;
       
       if ( GECOCGroupGetCpusetCpus(GECOUnknownJobId, GECOUnknownTaskId, &availableCpuset) ) {
@@ -1212,34 +1275,76 @@ GECOCGroupScanActiveCpusetBindings(void)
       GECO_INFO("  Scanning %s for extant per-job CPU allocations", path);
       while ( (readdir_r(gecoDir, &item, &itemPtr) == 0) && itemPtr ) {
         if ( sscanf(item.d_name, "%ld.%ld", &jobId, &taskId) == 2 ) {
-          size_t    cpuInfoLen = sizeof(cpuInfo);
-    
           GECO_INFO("    Found GECO subgroup for job %ld.%ld", jobId, taskId);
-          if ( GECOResourceSetIsJobRunningOnHost(jobId, taskId, 5) ) {
+          if ( jobCount == jobCapacity ) {
+            unsigned int    newCapacity = jobCapacity + GECOCGROUP_CPUSET_BINDING_GROWTH;
+            long int        *newJobIds = realloc(jobIds, 2 * newCapacity * sizeof(long int));
+            
+            if ( ! newJobIds ) {
+              GECO_ERROR("GECOCGroupScanActiveCpusetBindings: unable to grow job id list");
+              break;
+            }
+            //
+            // Job ids occupy the first half of the buffer, task ids the second:
+            //
+            if ( jobCount ) memmove(newJobIds + newCapacity, newJobIds + jobCapacity, jobCount * sizeof(long int));
+            jobIds = newJobIds;
+            taskIds = newJobIds + newCapacity;
+            jobCapacity = newCapacity;
+          }
+          jobIds[jobCount] = jobId;
+          taskIds[jobCount] = taskId;
+          jobCount++;
+        }
+      }
+      
+      if ( jobCount > 0 ) {
+        //
+        // Check the running state of all those jobs at once:
+        //
+        bool            isRunning[jobCount];
+        unsigned int    i;
+        
+        GECOResourceSetAreJobsRunningOnHost(jobCount, jobIds, taskIds, isRunning, 5);
+        
+        for ( i = 0; i < jobCount; i++ ) {
+          jobId = jobIds[i];
+          taskId = taskIds[i];
+          if ( isRunning[i] ) {
             if ( cpuMask ) hwloc_bitmap_zero(cpuMask);
             if ( GECOCGroupGetCpusetCpus(jobId, taskId, &cpuMask) ) {
 #ifndef GECO_DEBUG_DISABLE
               hwloc_bitmap_list_asprintf(&bitmapStr, cpuMask);
               if ( bitmapStr ) {
-                GECO_INFO("      Job is using cpuset.cpus %s", bitmapStr);
+                GECO_INFO("    Job %ld.%ld is using cpuset.cpus %s", jobId, taskId, bitmapStr);
                 free(bitmapStr);
               }
 #endif
               hwloc_bitmap_or(__GECOCGroupGetAllocatedCpuset(), __GECOCGroupGetAllocatedCpuset(), cpuMask);
               hwloc_bitmap_andnot(availableCpuset, availableCpuset, cpuMask);
+              
+              //
+              // The binding table takes ownership of the bitmap:
+              //
+              if ( __GECOCGroupCpusetBindingAdd(jobId, taskId, cpuMask) ) {
+                cpuMask = hwloc_bitmap_alloc();
+              } else {
+                GECO_ERROR("GECOCGroupScanActiveCpusetBindings: unable to record cpuset binding for %ld.%ld", jobId, taskId);
+              }
             }
           } else {
             //
             // Attempt to scrub all cgroup sub-group for this job id:
             //
             if ( GECOCGroupDeinitForJobIdentifier(jobId, taskId, NULL, NULL) ) {
-              GECO_INFO("      %ld.%ld does not appear to be valid on host, removing orphaned cgroups", jobId, taskId);
+              GECO_INFO("    %ld.%ld does not appear to be valid on host, removing orphaned cgroups", jobId, taskId);
             } else {
-              GECO_ERROR("      %ld.%ld does not appear to be valid on host, but unable to remove orphaned cgroups", jobId, taskId);
+              GECO_ERROR("    %ld.%ld does not appear to be valid on host, but unable to remove orphaned cgroups", jobId, taskId);
             }
           }
         }
       }
+      if ( jobIds ) free(jobIds);
       closedir(gecoDir);
       GECOCGroupHasScannedGECOCGroups = rc = true;
 
@@ -1259,10 +1364,81 @@ GECOCGroupScanActiveCpusetBindings(void)
   } else {
     GECO_ERROR("GECOCGroupScanActiveCpusetBindings: path limit exceeded (%d >= %d)", pathLen, sizeof(path));
   }
-  hwloc_bitmap_free(cpuMask);
+  if ( cpuMask ) hwloc_bitmap_free(cpuMask);
   return rc;
 }
 
+//
+// The hwloc topology is loaded once and reused; each allocation works on a
+// duplicate (hwloc_topology_restrict() alters the topology it's given).  The
+// list of online CPUs is remembered alongside it so that CPU hotplug can be
+// noticed and the topology reloaded:
+//
+static hwloc_topology_t GECOCGroupTopology = NULL;
+static char             GECOCGroupTopologyOnlineCpus[PATH_MAX];
+
+#ifndef GECOCGROUP_ONLINE_CPUS_PATH
+#define GECOCGROUP_ONLINE_CPUS_PATH "/sys/devices/system/cpu/online"
+#endif
+
+bool
+__GECOCGroupReadOnlineCpus(
+  char          *buffer,
+  size_t        bufferLen
+)
+{
+  size_t        actualLen = bufferLen;
+  
+  if ( __GECOCGroupReadCString(GECOCGROUP_ONLINE_CPUS_PATH, buffer, &actualLen) && (actualLen < bufferLen) ) {
+    GECOChomp(buffer);
+    return true;
+  }
+  *buffer = '\0';
+  return false;
+}
+
+hwloc_topology_t
+__GECOCGroupGetTopology(void)
+{
+  char          onlineCpus[PATH_MAX];
+  
+  if ( GECOCGroupTopology ) {
+    if ( __GECOCGroupReadOnlineCpus(onlineCpus, sizeof(onlineCpus)) && strcmp(onlineCpus, GECOCGroupTopologyOnlineCpus) ) {
+      GECO_INFO("online CPUs changed from %s to %s, reloading hwloc topology", GECOCGroupTopologyOnlineCpus, onlineCpus);
+      GECOCGroupInvalidateTopology();
+    }
+  }
+  if ( ! GECOCGroupTopology ) {
+    hwloc_topology_init(&GECOCGroupTopology);
+    if ( GECOCGroupTopology ) {
+      // Ignore everything except the NUMA/memory/cpu components:
+      hwloc_topology_ignore_type(GECOCGroupTopology, HWLOC_OBJ_BRIDGE | HWLOC_OBJ_MISC | HWLOC_OBJ_GROUP);
+      // Detect those components:
+      if ( hwloc_topology_load(GECOCGroupTopology) == 0 ) {
+        __GECOCGroupReadOnlineCpus(GECOCGroupTopologyOnlineCpus, sizeof(GECOCGroupTopologyOnlineCpus));
+        GECO_DEBUG("loaded hwloc topology");
+      } else {
+        GECO_ERROR("__GECOCGroupGetTopology: unable to load hwloc topology (errno = %d)", errno);
+        hwloc_topology_destroy(GECOCGroupTopology);
+        GECOCGroupTopology = NULL;
+      }
+    }
+  }
+  return GECOCGroupTopology;
+}
+
+//
+
+void
+GECOCGroupInvalidateTopology(void)
+{
+  if ( GECOCGroupTopology ) {
+    hwloc_topology_destroy(GECOCGroupTopology);
+    GECOCGroupTopology = NULL;
+    GECO_DEBUG("invalidated hwloc topology");
+  }
+}
+
 //
 
 bool
@@ -1276,23 +1452,14 @@ GECOCGroupAllocateCores(
   int                 maxCores;
   int                 rootCount;
   
-#ifdef LIBGECO_PRE_V101
-  if ( ! GECOCGroupHasScannedGECOCGroups ) GECOCGroupScanActiveCpusetBindings();
-#else
   //
-  // ALWAYS scan active bindings since cleanup doesn't seem to work too well...
+  // The in-memory allocation state is authoritative once it has been populated;
+  // further full scans only happen when explicitly requested:
   //
-  GECOCGroupScanActiveCpusetBindings();
-#endif
+  if ( ! GECOCGroupHasScannedGECOCGroups ) GECOCGroupScanActiveCpusetBindings();
 
-  // Allocate a new topology object:
-  hwloc_topology_init(&topology);
-  if ( ! topology ) return false;
-  
-  // Ignore everything except the NUMA/memory/cpu components:
-  hwloc_topology_ignore_type(topology, HWLOC_OBJ_BRIDGE | HWLOC_OBJ_MISC | HWLOC_OBJ_GROUP);
-  // Detect those components:
-  hwloc_topology_load(topology);
+  // Work on a copy of the cached topology:
+  if ( ! __GECOCGroupGetTopology() || (hwloc_topology_dup(&topology, GECOCGroupTopology) != 0) ) return false;
   if ( ! hwloc_bitmap_iszero(__GECOCGroupGetAvailableCpuset()) ) {
     // If there aren't enough bits in the bitmask, we have a problem:
     if ( hwloc_bitmap_weight(__GECOCGroupGetAvailableCpuset()) >= nCores ) {
@@ -1402,6 +1569,70 @@ GECOCGroupDeallocateCores(
 
 //
 
+bool
+GECOCGroupAllocateCoresForJobIdentifier(
+  long int            jobId,
+  long int            taskId,
+  unsigned int        nCores,
+  hwloc_bitmap_t      *outCpuset
+)
+{
+  hwloc_bitmap_t      theCpuset = NULL;
+  
+  //
+  // Any cores still bound to this job from a previous allocation go back into the
+  // pool first:
+  //
+  GECOCGroupDeallocateCoresForJobIdentifier(jobId, taskId);
+  
+  if ( ! GECOCGroupAllocateCores(nCores, &theCpuset) ) return false;
+  if ( outCpuset && ! (*outCpuset = hwloc_bitmap_dup(theCpuset)) ) {
+    GECOCGroupDeallocateCores(theCpuset);
+    return false;
+  }
+  if ( ! __GECOCGroupCpusetBindingAdd(jobId, taskId, theCpuset) ) {
+    GECO_ERROR("GECOCGroupAllocateCoresForJobIdentifier: unable to record cpuset binding for %ld.%ld", jobId, taskId);
+    if ( outCpuset ) {
+      hwloc_bitmap_free(*outCpuset);
+      *outCpuset = NULL;
+    }
+    GECOCGroupDeallocateCores(theCpuset);
+    return false;
+  }
+  return true;
+}
+
+//
+
+bool
+GECOCGroupDeallocateCoresForJobIdentifier(
+  long int            jobId,
+  long int            taskId
+)
+{
+  int                 index = __GECOCGroupCpusetBindingIndex(jobId, taskId);
+  
+  if ( index >= 0 ) {
+    hwloc_bitmap_t    theCpuset = GECOCGroupCpusetBindings[index].cpuset;
+#ifndef GECO_INFO_DISABLE
+    char              *str;
+    
+    hwloc_bitmap_list_asprintf(&str, theCpuset);
+    if ( str ) {
+      GECO_INFO("deallocating cgroup.cpus %s for %ld.%ld", str, jobId, taskId);
+      free(str);
+    }
+#endif
+    hwloc_bitmap_andnot(__GECOCGroupGetAllocatedCpuset(), __GECOCGroupGetAllocatedCpuset(), theCpuset);
+    hwloc_bitmap_or(__GECOCGroupGetAvailableCpuset(), __GECOCGroupGetAvailableCpuset(), theCpuset);
+    __GECOCGroupCpusetBindingRemoveAtIndex(index);
+    return true;
+  }
+  return false;
+}
+
+//
+
 bool
 GECOCGroupGetCpusetCpus(
   long int          jobId,
@@ -356,14 +356,28 @@ GECOCGroupWriteEventControl(
     the bitmap of all cores available to the GECO cpuset subgroup itself
     to yield the unallocated set of cores.
     
-    This function is called by GECOJob when GECOCGroupAllocateCores() fails
-    to allocate the requested number of cores.
+    The per-job cpuset bindings tracked by this library are replaced by what
+    is found on disk.  GECOCGroupAllocateCores() calls this function once
+    (the first time it is used); thereafter the in-memory state is updated
+    by allocation, deallocation, and GECOCGroupDeinitForJobIdentifier(), so
+    a full scan should only be needed at startup or when the caller has
+    reason to believe the in-memory state has drifted.
   @result
     As long as the GECO subgroup of the cpuset subsystem is present and
     navigable, this function returns boolean true.
 */
 bool GECOCGroupScanActiveCpusetBindings(void);
 
+/*!
+  @function GECOCGroupInvalidateTopology
+  @discussion
+    The hwloc topology used by GECOCGroupAllocateCores() is loaded once and
+    reused by all subsequent allocations.  It is reloaded automatically if
+    the set of online CPUs changes; this function discards it so that the
+    next allocation is forced to reload it.
+*/
+void GECOCGroupInvalidateTopology(void);
+
 /*!
   @function GECOCGroupAllocateCores
   @discussion
@@ -397,6 +411,32 @@ bool GECOCGroupAllocateCores(unsigned int nCores, hwloc_bitmap_t *outCpuset);
 */
 void GECOCGroupDeallocateCores(hwloc_bitmap_t theCpuset);
 
+/*!
+  @function GECOCGroupAllocateCoresForJobIdentifier
+  @discussion
+    Same as GECOCGroupAllocateCores(), but the chosen processing units are
+    also recorded as bound to the given job.  Any cores already bound to the
+    job are first returned to the pool.
+    
+    If outCpuset is not NULL, *outCpuset is set to a copy of the cpuset
+    bitmap that the caller must destroy with hwloc_bitmap_free(); the cores
+    themselves are returned to the pool by a call to
+    GECOCGroupDeallocateCoresForJobIdentifier() or by removal of the job's
+    cpuset subgroup via GECOCGroupDeinitForJobIdentifier().
+  @result
+    Returns boolean true if nCores processing units were allocated.
+*/
+bool GECOCGroupAllocateCoresForJobIdentifier(long int jobId, long int taskId, unsigned int nCores, hwloc_bitmap_t *outCpuset);
+
+/*!
+  @function GECOCGroupDeallocateCoresForJobIdentifier
+  @discussion
+    Return any processing units bound to the given job to being available.
+  @result
+    Returns boolean true if the job had cores bound to it.
+*/
+bool GECOCGroupDeallocateCoresForJobIdentifier(long int jobId, long int taskId);
+
 /*!
   @function GECOCGroupGetMemoryLimit
   @discussion
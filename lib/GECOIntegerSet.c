@@ -23,6 +23,16 @@ typedef bool              (*GECOIntegerSetContainsCallback)(GECOIntegerSetRef se
 typedef bool              (*GECOIntegerSetAddIntegerCallback)(GECOIntegerSetRef setOfIntegers, GECOInteger anInteger);
 typedef bool              (*GECOIntegerSetRemoveIntegerCallback)(GECOIntegerSetRef setOfIntegers, GECOInteger anInteger);
 
+//
+// Range enumeration:  each backend yields its values as a sequence of disjoint,
+// ascending [low, high] ranges.  The cursor must be zeroed before the first call.
+//
+typedef struct {
+  unsigned int      i, j;
+} GECOIntegerSetRangeCursor;
+
+typedef bool              (*GECOIntegerSetNextRangeCallback)(GECOIntegerSetRef setOfIntegers, GECOIntegerSetRangeCursor *cursor, GECOInteger *low, GECOInteger *high);
+
 typedef struct {
   const char                              *subType;
   GECOIntegerSetCopyCallback              copy;
@@ -33,6 +43,7 @@ typedef struct {
   GECOIntegerSetContainsCallback          contains;
   GECOIntegerSetAddIntegerCallback        addInteger;
   GECOIntegerSetRemoveIntegerCallback     removeInteger;
+  GECOIntegerSetNextRangeCallback         nextRange;
 } GECOIntegerSetImpl;
 
 //
@@ -171,11 +182,9 @@ GECOSimpleArrayIntegerSetContains(
     if ( theSet->array[i] == anInteger ) return true;
     
     if ( theSet->array[i] < anInteger ) {
-      if ( i == UINT_MAX ) break;
       iMin = i + 1;
     } else {
-      if ( i == 0 ) break;
-      iMax = i - 1;
+      iMax = i;
     }
   }
   return false;
@@ -249,16 +258,14 @@ GECOSimpleArrayIntegerSetRemoveInteger(
     unsigned int      i = iMin + ((iMax - iMin) / 2);
     
     if ( theSet->array[i] == anInteger ) {
-      if ( i < iMax - 1 ) memmove(&theSet->array[i], &theSet->array[i + 1], (iMax - i - 1) * sizeof(GECOInteger));
+      if ( i < theSet->base.count - 1 ) memmove(&theSet->array[i], &theSet->array[i + 1], (theSet->base.count - i - 1) * sizeof(GECOInteger));
       return true;
     }
     
     if ( theSet->array[i] < anInteger ) {
-      if ( i == UINT_MAX ) break;
       iMin = i + 1;
     } else {
-      if ( i == 0 ) break;
-      iMax = i - 1;
+      iMax = i;
     }
   }
   return false;
@@ -266,6 +273,27 @@ GECOSimpleArrayIntegerSetRemoveInteger(
 
 //
 
+bool
+GECOSimpleArrayIntegerSetNextRange(
+  GECOIntegerSetRef           setOfIntegers,
+  GECOIntegerSetRangeCursor   *cursor,
+  GECOInteger                 *low,
+  GECOInteger                 *high
+)
+{
+  GECOSimpleArrayIntegerSet   *theSet = (GECOSimpleArrayIntegerSet*)setOfIntegers;
+  unsigned int                i = cursor->i;
+  
+  if ( i >= theSet->base.count ) return false;
+  *low = theSet->array[i];
+  while ( (i + 1 < theSet->base.count) && (theSet->array[i + 1] == theSet->array[i] + 1) ) i++;
+  *high = theSet->array[i];
+  cursor->i = i + 1;
+  return true;
+}
+
+//
+
 static GECOIntegerSetImpl GECOSimpleArrayIntegerSetImpl = {
                               .subType = "GECOSimpleArrayIntegerSet",
                               .copy = GECOSimpleArrayIntegerSetCopy,
@@ -275,7 +303,8 @@ static GECOIntegerSetImpl GECOSimpleArrayIntegerSetImpl = {
                               .getIntegerAtIndex = GECOSimpleArrayIntegerSetGetIntegerAtIndex,
                               .contains = GECOSimpleArrayIntegerSetContains,
                               .addInteger = GECOSimpleArrayIntegerSetAddInteger,
-                              .removeInteger = GECOSimpleArrayIntegerSetRemoveInteger
+                              .removeInteger = GECOSimpleArrayIntegerSetRemoveInteger,
+                              .nextRange = GECOSimpleArrayIntegerSetNextRange
                             };
 
 //
@@ -294,7 +323,8 @@ __GECOSimpleArrayIntegerSetEmpty()
                       .getIntegerAtIndex = GECOSimpleArrayIntegerSetGetIntegerAtIndex,
                       .contains = GECOSimpleArrayIntegerSetContains,
                       .addInteger = GECOSimpleArrayIntegerSetAddInteger,
-                      .removeInteger = GECOSimpleArrayIntegerSetRemoveInteger
+                      .removeInteger = GECOSimpleArrayIntegerSetRemoveInteger,
+                      .nextRange = GECOSimpleArrayIntegerSetNextRange
                     },
                   .count = 0,
                   .isConstant = true,
@@ -348,44 +378,26 @@ __GECOSimpleArrayIntegerSetAlloc(
 #endif
 //
 
-enum {
-  GECOIntegerSetElementSubTypeSingle = 1,
-  GECOIntegerSetElementSubTypeRange = 2
-};
-
-typedef struct {
-  int             subType;
-} GECOIntegerSetElement;
-
-typedef struct {
-  int             subType;
-  GECOInteger     value;
-} GECOIntegerSetElementSingle;
+//
+// GECOMixedElementIntegerSet:  constant set stored as a sorted array of disjoint,
+// non-adjacent [low, high] elements (a single value has low == high).  The parallel
+// rank array holds the number of values in all preceding elements, so both
+// membership and index access are binary searches.
+//
 
 typedef struct {
-  int             subType;
   GECOInteger     low, high;
-} GECOIntegerSetElementRange;
+} GECOIntegerSetElement;
 
 typedef struct {
   GECOIntegerSet        base;
   unsigned int          elementCount, singlesCount, rangesCount;
   GECOIntegerSetElement *elements;
+  unsigned int          *ranks;
 } GECOMixedElementIntegerSet;
 
-static size_t GECOMixedElementIntegerSetSizes[] = { 0, sizeof(GECOIntegerSetElementSingle), sizeof(GECOIntegerSetElementRange) };
-
-#define GECOMixedElementIntegerSetIteratorBegin(S) \
-    { \
-      void *elements = (void*)((S)->elements); unsigned int eIdx = 0; \
-      while ( eIdx < (S)->elementCount ) { \
-        GECOIntegerSetElement *element = (GECOIntegerSetElement*)elements; \
-        elements += GECOMixedElementIntegerSetSizes[element->subType];
+#define GECOMixedElementIntegerSetElementSize (sizeof(GECOIntegerSetElement) + sizeof(unsigned int))
 
-#define GECOMixedElementIntegerSetIteratorEnd(S) \
-        eIdx++; \
-      } \
-    }
 //
 
 GECOMixedElementIntegerSet* __GECOMixedElementIntegerSetAllocBare(unsigned int countOfSingles, unsigned int countOfRanges);
@@ -400,7 +412,13 @@ GECOMixedElementIntegerSetCopy(
   GECOMixedElementIntegerSet  *theSet = (GECOMixedElementIntegerSet*)setOfIntegers;
   GECOMixedElementIntegerSet  *newSet = __GECOMixedElementIntegerSetAllocBare(theSet->singlesCount, theSet->rangesCount);
   
-  if ( newSet && newSet->elements ) memcpy(newSet->elements, theSet->elements, newSet->singlesCount * sizeof(GECOIntegerSetElementSingle) + newSet->rangesCount * sizeof(GECOIntegerSetElementRange));
+  if ( newSet ) {
+    newSet->base.count = theSet->base.count;
+    if ( newSet->elementCount ) {
+      memcpy(newSet->elements, theSet->elements, newSet->elementCount * sizeof(GECOIntegerSetElement));
+      memcpy(newSet->ranks, theSet->ranks, newSet->elementCount * sizeof(unsigned int));
+    }
+  }
   return (GECOIntegerSetRef)newSet;
 }
 
@@ -423,36 +441,18 @@ GECOMixedElementIntegerSetPrint(
 )
 {
   GECOMixedElementIntegerSet  *theSet = (GECOMixedElementIntegerSet*)setOfIntegers;
-  unsigned int                index = 0;
-  
-  GECOMixedElementIntegerSetIteratorBegin(theSet);
+  unsigned int                eIdx, index = 0;
   
-    switch ( element->subType ) {
+  for ( eIdx = 0; eIdx < theSet->elementCount; eIdx++ ) {
+    GECOInteger               v = theSet->elements[eIdx].low;
     
-      case GECOIntegerSetElementSubTypeSingle: {
-        GECOIntegerSetElementSingle *eSingle = (GECOIntegerSetElementSingle*)element;
-        
-        fprintf(stream, "%s%ld", (index ? "," : ""), eSingle->value);
-        index++;
-        break;
-      }
-      
-      case GECOIntegerSetElementSubTypeRange: {
-        GECOIntegerSetElementRange  *eRange = (GECOIntegerSetElementRange*)element;
-        GECOInteger                 v = eRange->low;
-        
-        while ( v <= eRange->high ) {
-          fprintf(stream, "%s%ld", (index ? "," : ""), v);
-          if ( v == INT_MAX ) return;
-          v++;
-          index++;
-        }
-        break;
-      }
-      
+    while ( v <= theSet->elements[eIdx].high ) {
+      fprintf(stream, "%s%ld", (index ? "," : ""), v);
+      if ( v == LONG_MAX ) return;
+      v++;
+      index++;
     }
-  
-  GECOMixedElementIntegerSetIteratorEnd(theSet);
+  }
 }
 
 //
@@ -464,32 +464,18 @@ GECOMixedElementIntegerSetDebug(
 )
 {
   GECOMixedElementIntegerSet  *theSet = (GECOMixedElementIntegerSet*)setOfIntegers;
-  unsigned int                index = 0;
+  unsigned int                eIdx;
   
   fprintf(stream, "elementCount: %u; singlesCount: %u; rangesCount: %u; { ", theSet->elementCount, theSet->singlesCount, theSet->rangesCount);
-  GECOMixedElementIntegerSetIteratorBegin(theSet);
-  
-    switch ( element->subType ) {
-    
-      case GECOIntegerSetElementSubTypeSingle: {
-        GECOIntegerSetElementSingle *eSingle = (GECOIntegerSetElementSingle*)element;
-        
-        fprintf(stream, "%s%u: %ld", (index ? ", " : ""), index, eSingle->value);
-        index++;
-        break;
-      }
-      
-      case GECOIntegerSetElementSubTypeRange: {
-        GECOIntegerSetElementRange  *eRange = (GECOIntegerSetElementRange*)element;
-        
-        fprintf(stream, "%s%u: [%ld, %ld]", (index ? ", " : ""), index, eRange->low, eRange->high);
-        index++;
-        break;
-      }
+  for ( eIdx = 0; eIdx < theSet->elementCount; eIdx++ ) {
+    GECOIntegerSetElement     *element = &theSet->elements[eIdx];
     
+    if ( element->low == element->high ) {
+      fprintf(stream, "%s%u: %ld", (eIdx ? ", " : ""), eIdx, element->low);
+    } else {
+      fprintf(stream, "%s%u: [%ld, %ld]", (eIdx ? ", " : ""), eIdx, element->low, element->high);
     }
-    
-  GECOMixedElementIntegerSetIteratorEnd(theSet);
+  }
   fprintf(stream, " }");
 }
 
@@ -503,43 +489,18 @@ GECOMixedElementIntegerSetGetIntegerAtIndex(
 )
 {
   GECOMixedElementIntegerSet  *theSet = (GECOMixedElementIntegerSet*)setOfIntegers;
+  unsigned int                iMin = 0, iMax = theSet->elementCount;
   
-  GECOMixedElementIntegerSetIteratorBegin(theSet);
+  if ( index >= theSet->base.count ) return false;
   
-    switch ( element->subType ) {
-    
-      case GECOIntegerSetElementSubTypeSingle: {
-        GECOIntegerSetElementSingle *eSingle = (GECOIntegerSetElementSingle*)element;
-        
-        if ( index == 0 ) {
-          *anInteger = eSingle->value;
-          return true;
-        }
-        index--;
-        break;
-      }
-      
-      case GECOIntegerSetElementSubTypeRange: {
-        GECOIntegerSetElementRange  *eRange = (GECOIntegerSetElementRange*)element;
-        GECOInteger                 v = eRange->low;
-        
-        while ( index && (v <= eRange->high) ) {
-          index--;
-          if ( v == INT_MAX ) return false;
-          v++;
-        }
-        if ( index == 0 ) {
-          *anInteger = v;
-          return true;
-        }
-        break;
-      }
+  // Find the last element whose rank is <= index:
+  while ( iMax - iMin > 1 ) {
+    unsigned int              i = iMin + ((iMax - iMin) / 2);
     
-    }
-  
-  GECOMixedElementIntegerSetIteratorEnd(theSet);
-  
-  return false;
+    if ( theSet->ranks[i] <= index ) iMin = i; else iMax = i;
+  }
+  *anInteger = theSet->elements[iMin].low + (index - theSet->ranks[iMin]);
+  return true;
 }
 
 //
@@ -551,30 +512,15 @@ GECOMixedElementIntegerSetContains(
 )
 {
   GECOMixedElementIntegerSet  *theSet = (GECOMixedElementIntegerSet*)setOfIntegers;
+  unsigned int                iMin = 0, iMax = theSet->elementCount;
   
-  GECOMixedElementIntegerSetIteratorBegin(theSet);
-  
-    switch ( element->subType ) {
-    
-      case GECOIntegerSetElementSubTypeSingle: {
-        GECOIntegerSetElementSingle *eSingle = (GECOIntegerSetElementSingle*)element;
-        
-        if ( anInteger == eSingle->value ) return true;
-        break;
-      }
-      
-      case GECOIntegerSetElementSubTypeRange: {
-        GECOIntegerSetElementRange  *eRange = (GECOIntegerSetElementRange*)element;
-        
-        if ( anInteger >= eRange->low && anInteger <= eRange->high ) return true;
-        break;
-      }
+  // Find the first element whose high is >= anInteger:
+  while ( iMin < iMax ) {
+    unsigned int              i = iMin + ((iMax - iMin) / 2);
     
-    }
-  
-  GECOMixedElementIntegerSetIteratorEnd(theSet);
-  
-  return false;
+    if ( theSet->elements[i].high < anInteger ) iMin = i + 1; else iMax = i;
+  }
+  return ( (iMin < theSet->elementCount) && (theSet->elements[iMin].low <= anInteger) );
 }
 
 //
@@ -601,15 +547,35 @@ GECOMixedElementIntegerSetRemoveInteger(
 
 //
 
+bool
+GECOMixedElementIntegerSetNextRange(
+  GECOIntegerSetRef           setOfIntegers,
+  GECOIntegerSetRangeCursor   *cursor,
+  GECOInteger                 *low,
+  GECOInteger                 *high
+)
+{
+  GECOMixedElementIntegerSet  *theSet = (GECOMixedElementIntegerSet*)setOfIntegers;
+  
+  if ( cursor->i >= theSet->elementCount ) return false;
+  *low = theSet->elements[cursor->i].low;
+  *high = theSet->elements[cursor->i++].high;
+  return true;
+}
+
+//
+
 static GECOIntegerSetImpl GECOMixedElementIntegerSetImpl = {
                               .subType = "GECOMixedElementIntegerSet",
+                              .copy = GECOMixedElementIntegerSetCopy,
                               .dealloc = GECOMixedElementIntegerSetDealloc,
                               .print = GECOMixedElementIntegerSetPrint,
                               .debug = GECOMixedElementIntegerSetDebug,
                               .getIntegerAtIndex = GECOMixedElementIntegerSetGetIntegerAtIndex,
                               .contains = GECOMixedElementIntegerSetContains,
                               .addInteger = GECOMixedElementIntegerSetAddInteger,
-                              .removeInteger = GECOMixedElementIntegerSetRemoveInteger
+                              .removeInteger = GECOMixedElementIntegerSetRemoveInteger,
+                              .nextRange = GECOMixedElementIntegerSetNextRange
                             };
 
 //
@@ -622,43 +588,20 @@ __GECOMixedElementIntegerSetAnalyzeArray(
   unsigned int      *countOfRanges
 )
 {
-  size_t            totalBytes = 0;
+  unsigned int      i = 0;
   
   *countOfRanges = *countOfSingles = 0;
-  if ( count ) {
-    GECOInteger     low = *set, last = low, high = 0;
-    bool            highIsSet = false;
-    
-    set++; count--;
-    while ( count ) {
-      if ( *set == last + 1 ) {
-        high = *set;
-        highIsSet = true;
-      } else {
-        // Create the next element:
-        if ( highIsSet ) {
-          totalBytes += sizeof(GECOIntegerSetElementRange);
-          *countOfRanges += 1;
-          highIsSet = false;
-        } else {
-          *countOfSingles += 1;
-          totalBytes += sizeof(GECOIntegerSetElementSingle);
-        }
-        low = *set;
-      }
-      last = *set++;
-      count--;
-    }
-    // Create the final element:
-    if ( highIsSet ) {
-      totalBytes += sizeof(GECOIntegerSetElementRange);
+  while ( i < count ) {
+    unsigned int    iStart = i;
+    
+    while ( (++i < count) && (set[i] == set[i - 1] + 1) );
+    if ( i - iStart > 1 ) {
       *countOfRanges += 1;
     } else {
-      totalBytes += sizeof(GECOIntegerSetElementSingle);
       *countOfSingles += 1;
     }
   }
-  return totalBytes;
+  return (*countOfSingles + *countOfRanges) * GECOMixedElementIntegerSetElementSize;
 }
 
 //
@@ -670,15 +613,18 @@ __GECOMixedElementIntegerSetAllocBare(
 )
 {
   GECOMixedElementIntegerSet  *newSet = NULL;
-  size_t                      byteSize = sizeof(GECOMixedElementIntegerSet) + countOfSingles * sizeof(GECOIntegerSetElementSingle) + countOfRanges * sizeof(GECOIntegerSetElementRange);
+  unsigned int                elementCount = countOfSingles + countOfRanges;
+  size_t                      byteSize = sizeof(GECOMixedElementIntegerSet) + elementCount * GECOMixedElementIntegerSetElementSize;
   
   newSet = malloc(byteSize);
   if ( newSet ) {
     __GECOIntegerSetInit((GECOIntegerSet*)newSet, &GECOMixedElementIntegerSetImpl, true);
-    if ( (newSet->elementCount = countOfSingles + countOfRanges) > 0 ) {
+    if ( (newSet->elementCount = elementCount) > 0 ) {
       newSet->elements = ((void*)newSet) + sizeof(GECOMixedElementIntegerSet);
+      newSet->ranks = (unsigned int*)(newSet->elements + elementCount);
     } else {
       newSet->elements = NULL;
+      newSet->ranks = NULL;
     }
     newSet->singlesCount = countOfSingles;
     newSet->rangesCount = countOfRanges;
@@ -700,50 +646,599 @@ __GECOMixedElementIntegerSetAlloc(
   
   if ( newSet ) {
     // Initialize the element records:
-    void*           p = (void*)newSet->elements;
-    GECOInteger     low = *set, last = low, high = 0;
-    bool            highIsSet = false;
-    
-    set++; count--;
-    while ( count ) {
-      if ( *set == last + 1 ) {
-        high = *set;
-        highIsSet = true;
-      } else {
-        // Create the next element:
-        if ( highIsSet ) {
-          GECOIntegerSetElementRange    *R = (GECOIntegerSetElementRange*)p;
+    unsigned int    i = 0, eIdx = 0;
+    
+    while ( i < count ) {
+      unsigned int  iStart = i;
+      
+      while ( (++i < count) && (set[i] == set[i - 1] + 1) );
+      newSet->elements[eIdx].low = set[iStart];
+      newSet->elements[eIdx].high = set[i - 1];
+      newSet->ranks[eIdx++] = iStart;
+    }
+    newSet->base.count = count;
+  }
+  return newSet;
+}
+
+//
+#if 0
+#pragma mark -
+#endif
+//
+// GECOBitmapIntegerSet:  constant set that partitions its values by their high-order
+// bits (value >> 16) into containers that each hold the low 16 bits of up to 65536
+// values.  Each container uses whichever of three representations is smallest for
+// the values it holds:
+//
+//   - array:   sorted list of 16-bit values (sparse)
+//   - bitmap:  65536-bit bitmap, 64-byte aligned (dense)
+//   - run:     sorted list of (start, length - 1) 16-bit pairs (clustered)
+//
+// so membership is a binary search on the container keys followed by a bit test or
+// a binary search within the container.
+//
+
+enum {
+  GECOBitmapContainerTypeArray = 0,
+  GECOBitmapContainerTypeBitmap,
+  GECOBitmapContainerTypeRun
+};
+
+#define GECOBitmapContainerBitmapWords    (65536 / 64)
+#define GECOBitmapContainerBitmapBytes    (GECOBitmapContainerBitmapWords * sizeof(uint64_t))
+
+#ifndef GECOBITMAPINTEGERSET_ALIGNMENT
+#define GECOBITMAPINTEGERSET_ALIGNMENT    64
+#endif
+
+#define GECOBitmapIntegerSetAlignedSize(S)  (((S) + GECOBITMAPINTEGERSET_ALIGNMENT - 1) & ~((size_t)GECOBITMAPINTEGERSET_ALIGNMENT - 1))
+
+#define GECOBitmapIntegerSetKey(V)          ((V) >> 16)
+#define GECOBitmapIntegerSetLow(V)          ((uint16_t)((V) & 0xFFFF))
+#define GECOBitmapIntegerSetValue(K, L)     ((K) * 65536 + (GECOInteger)(L))
+
+typedef struct {
+  GECOInteger         key;
+  unsigned int        type;
+  unsigned int        length;         // number of values (array) or runs (run)
+  unsigned int        cardinality;
+  unsigned int        rank;           // number of values in all preceding containers
+  size_t              offset;         // byte offset of the payload from the set's payload base
+} GECOBitmapContainer;
+
+typedef struct {
+  GECOIntegerSet      base;
+  size_t              byteSize;
+  unsigned int        containerCount;
+  GECOBitmapContainer *containers;
+  void                *payload;
+} GECOBitmapIntegerSet;
+
+//
+
+GECOBitmapIntegerSet* __GECOBitmapIntegerSetAllocBare(size_t byteSize, unsigned int containerCount);
+
+//
+
+GECOIntegerSetRef
+GECOBitmapIntegerSetCopy(
+  GECOIntegerSetRef   setOfIntegers
+)
+{
+  GECOBitmapIntegerSet  *theSet = (GECOBitmapIntegerSet*)setOfIntegers;
+  GECOBitmapIntegerSet  *newSet = __GECOBitmapIntegerSetAllocBare(theSet->byteSize, theSet->containerCount);
+  
+  if ( newSet ) {
+    GECOBitmapContainer *containers = newSet->containers;
+    void                *payload = newSet->payload;
+    
+    memcpy(newSet, theSet, theSet->byteSize);
+    newSet->containers = containers;
+    newSet->payload = payload;
+  }
+  return (GECOIntegerSetRef)newSet;
+}
+
+//
+
+void
+GECOBitmapIntegerSetDealloc(
+  GECOIntegerSetRef   setOfIntegers
+)
+{
+  free((void*)setOfIntegers);
+}
+
+//
+
+void
+GECOBitmapIntegerSetPrint(
+  GECOIntegerSetRef   setOfIntegers,
+  FILE                *stream
+)
+{
+  GECOBitmapIntegerSet  *theSet = (GECOBitmapIntegerSet*)setOfIntegers;
+  unsigned int          c, index = 0;
+  
+  for ( c = 0; c < theSet->containerCount; c++ ) {
+    GECOBitmapContainer *container = &theSet->containers[c];
+    void                *payload = theSet->payload + container->offset;
+    unsigned int        i;
+    
+    switch ( container->type ) {
+    
+      case GECOBitmapContainerTypeArray: {
+        uint16_t        *values = (uint16_t*)payload;
+        
+        for ( i = 0; i < container->length; i++ ) fprintf(stream, "%s%ld", (index++ ? "," : ""), GECOBitmapIntegerSetValue(container->key, values[i]));
+        break;
+      }
+      
+      case GECOBitmapContainerTypeBitmap: {
+        uint64_t        *words = (uint64_t*)payload;
+        
+        for ( i = 0; i < GECOBitmapContainerBitmapWords; i++ ) {
+          uint64_t      w = words[i];
           
-          R->subType = GECOIntegerSetElementSubTypeRange;
-          R->low = low;
-          R->high = high;
-          p += sizeof(GECOIntegerSetElementRange);
-          highIsSet = false;
-        } else {
-          GECOIntegerSetElementSingle   *S = (GECOIntegerSetElementSingle*)p;
+          while ( w ) {
+            fprintf(stream, "%s%ld", (index++ ? "," : ""), GECOBitmapIntegerSetValue(container->key, 64 * i + __builtin_ctzll(w)));
+            w &= w - 1;
+          }
+        }
+        break;
+      }
+      
+      case GECOBitmapContainerTypeRun: {
+        uint16_t        *runs = (uint16_t*)payload;
+        
+        for ( i = 0; i < container->length; i++ ) {
+          unsigned int  v = runs[2 * i], vMax = v + runs[2 * i + 1];
           
-          S->subType = GECOIntegerSetElementSubTypeSingle;
-          S->value = low;
-          p += sizeof(GECOIntegerSetElementSingle);
+          while ( v <= vMax ) fprintf(stream, "%s%ld", (index++ ? "," : ""), GECOBitmapIntegerSetValue(container->key, v++));
         }
-        low = *set;
+        break;
       }
-      last = *set++;
-      count--;
+      
     }
-    // Create the final element:
-    if ( highIsSet ) {
-      GECOIntegerSetElementRange    *R = (GECOIntegerSetElementRange*)p;
+  }
+}
+
+//
+
+void
+GECOBitmapIntegerSetDebug(
+  GECOIntegerSetRef   setOfIntegers,
+  FILE                *stream
+)
+{
+  static const char     *typeNames[] = { "array", "bitmap", "run" };
+  GECOBitmapIntegerSet  *theSet = (GECOBitmapIntegerSet*)setOfIntegers;
+  unsigned int          c;
+  
+  fprintf(stream, "byteSize: %lu; containerCount: %u; { ", (unsigned long)theSet->byteSize, theSet->containerCount);
+  for ( c = 0; c < theSet->containerCount; c++ ) {
+    GECOBitmapContainer *container = &theSet->containers[c];
+    
+    fprintf(stream, "%s%u: key %ld %s(length: %u; cardinality: %u; rank: %u)", (c ? ", " : ""), c, container->key, typeNames[container->type], container->length, container->cardinality, container->rank);
+  }
+  fprintf(stream, " }");
+}
+
+//
+
+int
+__GECOBitmapIntegerSetIndexOfKey(
+  GECOBitmapIntegerSet  *theSet,
+  GECOInteger           key
+)
+{
+  unsigned int          iMin = 0, iMax = theSet->containerCount;
+  
+  while ( iMin < iMax ) {
+    unsigned int        i = iMin + ((iMax - iMin) / 2);
+    
+    if ( theSet->containers[i].key == key ) return i;
+    if ( theSet->containers[i].key < key ) iMin = i + 1; else iMax = i;
+  }
+  return -1;
+}
+
+//
+
+bool
+GECOBitmapIntegerSetGetIntegerAtIndex(
+  GECOIntegerSetRef   setOfIntegers,
+  unsigned int        index,
+  GECOInteger         *anInteger
+)
+{
+  GECOBitmapIntegerSet  *theSet = (GECOBitmapIntegerSet*)setOfIntegers;
+  GECOBitmapContainer   *container;
+  void                  *payload;
+  unsigned int          iMin = 0, iMax = theSet->containerCount;
+  
+  if ( index >= theSet->base.count ) return false;
+  
+  // Find the last container whose rank is <= index:
+  while ( iMax - iMin > 1 ) {
+    unsigned int        i = iMin + ((iMax - iMin) / 2);
+    
+    if ( theSet->containers[i].rank <= index ) iMin = i; else iMax = i;
+  }
+  container = &theSet->containers[iMin];
+  payload = theSet->payload + container->offset;
+  index -= container->rank;
+  
+  switch ( container->type ) {
+  
+    case GECOBitmapContainerTypeArray:
+      *anInteger = GECOBitmapIntegerSetValue(container->key, ((uint16_t*)payload)[index]);
+      return true;
+    
+    case GECOBitmapContainerTypeBitmap: {
+      uint64_t          *words = (uint64_t*)payload;
+      unsigned int      i = 0, n;
+      uint64_t          w;
       
-      R->subType = GECOIntegerSetElementSubTypeRange;
-      R->low = low;
-      R->high = high;
-    } else {
-      GECOIntegerSetElementSingle   *S = (GECOIntegerSetElementSingle*)p;
+      while ( index >= (n = __builtin_popcountll(words[i])) ) {
+        index -= n;
+        i++;
+      }
+      w = words[i];
+      while ( index-- ) w &= w - 1;
+      *anInteger = GECOBitmapIntegerSetValue(container->key, 64 * i + __builtin_ctzll(w));
+      return true;
+    }
+    
+    case GECOBitmapContainerTypeRun: {
+      uint16_t          *runs = (uint16_t*)payload;
       
-      S->subType = GECOIntegerSetElementSubTypeSingle;
-      S->value = low;
+      while ( index > runs[1] ) {
+        index -= runs[1] + 1;
+        runs += 2;
+      }
+      *anInteger = GECOBitmapIntegerSetValue(container->key, runs[0] + index);
+      return true;
     }
+    
+  }
+  return false;
+}
+
+//
+
+bool
+GECOBitmapIntegerSetContains(
+  GECOIntegerSetRef   setOfIntegers,
+  GECOInteger         anInteger
+)
+{
+  GECOBitmapIntegerSet  *theSet = (GECOBitmapIntegerSet*)setOfIntegers;
+  int                   c = __GECOBitmapIntegerSetIndexOfKey(theSet, GECOBitmapIntegerSetKey(anInteger));
+  
+  if ( c >= 0 ) {
+    GECOBitmapContainer *container = &theSet->containers[c];
+    void                *payload = theSet->payload + container->offset;
+    uint16_t            low = GECOBitmapIntegerSetLow(anInteger);
+    
+    switch ( container->type ) {
+    
+      case GECOBitmapContainerTypeBitmap:
+        return ( (((uint64_t*)payload)[low >> 6] >> (low & 63)) & 1 ) ? true : false;
+      
+      case GECOBitmapContainerTypeArray: {
+        uint16_t        *values = (uint16_t*)payload;
+        unsigned int    iMin = 0, iMax = container->length;
+        
+        while ( iMin < iMax ) {
+          unsigned int  i = iMin + ((iMax - iMin) / 2);
+          
+          if ( values[i] == low ) return true;
+          if ( values[i] < low ) iMin = i + 1; else iMax = i;
+        }
+        break;
+      }
+      
+      case GECOBitmapContainerTypeRun: {
+        uint16_t        *runs = (uint16_t*)payload;
+        unsigned int    iMin = 0, iMax = container->length;
+        
+        // Find the last run starting at or below low:
+        while ( iMin < iMax ) {
+          unsigned int  i = iMin + ((iMax - iMin) / 2);
+          
+          if ( runs[2 * i] <= low ) iMin = i + 1; else iMax = i;
+        }
+        if ( iMin > 0 ) {
+          iMin--;
+          if ( low - runs[2 * iMin] <= runs[2 * iMin + 1] ) return true;
+        }
+        break;
+      }
+      
+    }
+  }
+  return false;
+}
+
+//
+
+bool
+GECOBitmapIntegerSetAddInteger(
+  GECOIntegerSetRef   setOfIntegers,
+  GECOInteger         anInteger
+)
+{
+  return false;
+}
+
+//
+
+bool
+GECOBitmapIntegerSetRemoveInteger(
+  GECOIntegerSetRef   setOfIntegers,
+  GECOInteger         anInteger
+)
+{
+  return false;
+}
+
+//
+
+bool
+GECOBitmapIntegerSetNextRange(
+  GECOIntegerSetRef           setOfIntegers,
+  GECOIntegerSetRangeCursor   *cursor,
+  GECOInteger                 *low,
+  GECOInteger                 *high
+)
+{
+  GECOBitmapIntegerSet        *theSet = (GECOBitmapIntegerSet*)setOfIntegers;
+  
+  //
+  // cursor->i is the container index; cursor->j is the next value (array), run
+  // (run), or bit position (bitmap) within it:
+  //
+  while ( cursor->i < theSet->containerCount ) {
+    GECOBitmapContainer       *container = &theSet->containers[cursor->i];
+    void                      *payload = theSet->payload + container->offset;
+    
+    switch ( container->type ) {
+    
+      case GECOBitmapContainerTypeArray: {
+        uint16_t              *values = (uint16_t*)payload;
+        unsigned int          j = cursor->j;
+        
+        if ( j < container->length ) {
+          *low = GECOBitmapIntegerSetValue(container->key, values[j]);
+          while ( (j + 1 < container->length) && (values[j + 1] == values[j] + 1) ) j++;
+          *high = GECOBitmapIntegerSetValue(container->key, values[j]);
+          cursor->j = j + 1;
+          return true;
+        }
+        break;
+      }
+      
+      case GECOBitmapContainerTypeRun: {
+        uint16_t              *runs = (uint16_t*)payload;
+        
+        if ( cursor->j < container->length ) {
+          *low = GECOBitmapIntegerSetValue(container->key, runs[2 * cursor->j]);
+          *high = *low + runs[2 * cursor->j + 1];
+          cursor->j++;
+          return true;
+        }
+        break;
+      }
+      
+      case GECOBitmapContainerTypeBitmap: {
+        uint64_t              *words = (uint64_t*)payload;
+        unsigned int          w = cursor->j >> 6, start, end;
+        uint64_t              bits;
+        
+        if ( cursor->j >= 65536 ) break;
+        
+        // Find the next set bit:
+        bits = words[w] & (~(uint64_t)0 << (cursor->j & 63));
+        while ( ! bits && (++w < GECOBitmapContainerBitmapWords) ) bits = words[w];
+        if ( ! bits ) break;
+        start = 64 * w + __builtin_ctzll(bits);
+        
+        // Find the next clear bit after it:
+        bits = ~words[w] & (~(uint64_t)0 << (start & 63));
+        while ( ! bits && (++w < GECOBitmapContainerBitmapWords) ) bits = ~words[w];
+        end = bits ? (64 * w + __builtin_ctzll(bits)) : 65536;
+        
+        *low = GECOBitmapIntegerSetValue(container->key, start);
+        *high = GECOBitmapIntegerSetValue(container->key, end - 1);
+        cursor->j = end;
+        return true;
+      }
+      
+    }
+    cursor->i++;
+    cursor->j = 0;
+  }
+  return false;
+}
+
+//
+
+static GECOIntegerSetImpl GECOBitmapIntegerSetImpl = {
+                              .subType = "GECOBitmapIntegerSet",
+                              .copy = GECOBitmapIntegerSetCopy,
+                              .dealloc = GECOBitmapIntegerSetDealloc,
+                              .print = GECOBitmapIntegerSetPrint,
+                              .debug = GECOBitmapIntegerSetDebug,
+                              .getIntegerAtIndex = GECOBitmapIntegerSetGetIntegerAtIndex,
+                              .contains = GECOBitmapIntegerSetContains,
+                              .addInteger = GECOBitmapIntegerSetAddInteger,
+                              .removeInteger = GECOBitmapIntegerSetRemoveInteger,
+                              .nextRange = GECOBitmapIntegerSetNextRange
+                            };
+
+//
+
+unsigned int
+__GECOBitmapContainerChooseType(
+  unsigned int      cardinality,
+  unsigned int      runCount,
+  size_t            *payloadBytes
+)
+{
+  size_t            asArray = cardinality * sizeof(uint16_t);
+  size_t            asRuns = runCount * 2 * sizeof(uint16_t);
+  
+  if ( asRuns <= asArray && asRuns <= GECOBitmapContainerBitmapBytes ) {
+    *payloadBytes = asRuns;
+    return GECOBitmapContainerTypeRun;
+  }
+  if ( asArray <= GECOBitmapContainerBitmapBytes ) {
+    *payloadBytes = asArray;
+    return GECOBitmapContainerTypeArray;
+  }
+  *payloadBytes = GECOBitmapContainerBitmapBytes;
+  return GECOBitmapContainerTypeBitmap;
+}
+
+//
+
+size_t
+__GECOBitmapIntegerSetAnalyzeArray(
+  unsigned int      count,
+  GECOInteger       *set,
+  unsigned int      *countOfContainers,
+  size_t            *bitmapBytes
+)
+{
+  size_t            payloadBytes = 0;
+  unsigned int      i = 0;
+  
+  *countOfContainers = 0;
+  *bitmapBytes = 0;
+  while ( i < count ) {
+    GECOInteger     key = GECOBitmapIntegerSetKey(set[i]);
+    unsigned int    cardinality = 1, runCount = 1;
+    size_t          containerBytes;
+    
+    while ( (++i < count) && (GECOBitmapIntegerSetKey(set[i]) == key) ) {
+      cardinality++;
+      if ( set[i] != set[i - 1] + 1 ) runCount++;
+    }
+    if ( __GECOBitmapContainerChooseType(cardinality, runCount, &containerBytes) == GECOBitmapContainerTypeBitmap ) *bitmapBytes += containerBytes;
+    payloadBytes += containerBytes;
+    *countOfContainers += 1;
+  }
+  return GECOBitmapIntegerSetAlignedSize(sizeof(GECOBitmapIntegerSet) + *countOfContainers * sizeof(GECOBitmapContainer)) + payloadBytes;
+}
+
+//
+
+GECOBitmapIntegerSet*
+__GECOBitmapIntegerSetAllocBare(
+  size_t            byteSize,
+  unsigned int      containerCount
+)
+{
+  GECOBitmapIntegerSet  *newSet = NULL;
+  
+  if ( posix_memalign((void**)&newSet, GECOBITMAPINTEGERSET_ALIGNMENT, byteSize) == 0 ) {
+    __GECOIntegerSetInit((GECOIntegerSet*)newSet, &GECOBitmapIntegerSetImpl, true);
+    newSet->byteSize = byteSize;
+    newSet->containerCount = containerCount;
+    newSet->containers = ((void*)newSet) + sizeof(GECOBitmapIntegerSet);
+    newSet->payload = ((void*)newSet) + GECOBitmapIntegerSetAlignedSize(sizeof(GECOBitmapIntegerSet) + containerCount * sizeof(GECOBitmapContainer));
+  } else {
+    newSet = NULL;
+  }
+  return newSet;
+}
+
+//
+
+GECOBitmapIntegerSet*
+__GECOBitmapIntegerSetAlloc(
+  unsigned int      count,
+  GECOInteger       *set,
+  size_t            byteSize,
+  unsigned int      countOfContainers,
+  size_t            bitmapBytes
+)
+{
+  GECOBitmapIntegerSet  *newSet = __GECOBitmapIntegerSetAllocBare(byteSize, countOfContainers);
+  
+  if ( newSet ) {
+    // Bitmap payloads come first so that they inherit the payload's alignment:
+    size_t              bitmapOffset = 0, otherOffset = bitmapBytes;
+    unsigned int        i = 0, c = 0;
+    
+    while ( i < count ) {
+      GECOBitmapContainer *container = &newSet->containers[c++];
+      unsigned int      iStart = i, runCount = 1;
+      size_t            containerBytes;
+      void              *payload;
+      
+      container->key = GECOBitmapIntegerSetKey(set[i]);
+      container->rank = i;
+      while ( (++i < count) && (GECOBitmapIntegerSetKey(set[i]) == container->key) ) {
+        if ( set[i] != set[i - 1] + 1 ) runCount++;
+      }
+      container->cardinality = i - iStart;
+      container->type = __GECOBitmapContainerChooseType(container->cardinality, runCount, &containerBytes);
+      if ( container->type == GECOBitmapContainerTypeBitmap ) {
+        container->offset = bitmapOffset;
+        bitmapOffset += containerBytes;
+      } else {
+        container->offset = otherOffset;
+        otherOffset += containerBytes;
+      }
+      payload = newSet->payload + container->offset;
+      
+      switch ( container->type ) {
+      
+        case GECOBitmapContainerTypeArray: {
+          uint16_t      *values = (uint16_t*)payload;
+          
+          container->length = container->cardinality;
+          while ( iStart < i ) *values++ = GECOBitmapIntegerSetLow(set[iStart++]);
+          break;
+        }
+        
+        case GECOBitmapContainerTypeBitmap: {
+          uint64_t      *words = (uint64_t*)payload;
+          
+          container->length = GECOBitmapContainerBitmapWords;
+          memset(words, 0, containerBytes);
+          while ( iStart < i ) {
+            uint16_t    low = GECOBitmapIntegerSetLow(set[iStart++]);
+            
+            words[low >> 6] |= (uint64_t)1 << (low & 63);
+          }
+          break;
+        }
+        
+        case GECOBitmapContainerTypeRun: {
+          uint16_t      *runs = (uint16_t*)payload;
+          
+          container->length = runCount;
+          runs[0] = GECOBitmapIntegerSetLow(set[iStart]);
+          runs[1] = 0;
+          while ( ++iStart < i ) {
+            if ( set[iStart] == set[iStart - 1] + 1 ) {
+              runs[1]++;
+            } else {
+              runs += 2;
+              runs[0] = GECOBitmapIntegerSetLow(set[iStart]);
+              runs[1] = 0;
+            }
+          }
+          break;
+        }
+        
+      }
+    }
+    newSet->base.count = count;
   }
   return newSet;
 }
@@ -795,8 +1290,21 @@ GECOIntegerSetCreateConstantCopy(
   unsigned int                  countOfRanges, countOfSingles;
   size_t                        asElements = __GECOMixedElementIntegerSetAnalyzeArray(theSet->base.count, theSet->array, &countOfSingles, &countOfRanges);
     
-  if ( (asElements < asArray) && ((double)asElements / (double)asArray < 0.8) ) {
-    return (GECOIntegerSetRef)__GECOMixedElementIntegerSetAlloc(theSet->base.count, theSet->array, countOfSingles, countOfRanges);
+  if ( theSet->base.count ) {
+    unsigned int                countOfContainers;
+    size_t                      bitmapBytes;
+    size_t                      asBitmap = __GECOBitmapIntegerSetAnalyzeArray(theSet->base.count, theSet->array, &countOfContainers, &bitmapBytes);
+    
+    //
+    // Both compressed forms are searched by bisection, so take the smaller of
+    // them if it is sufficiently smaller than the plain array:
+    //
+    if ( (asElements + sizeof(GECOMixedElementIntegerSet) <= asBitmap) && (asElements < asArray) && ((double)asElements / (double)asArray < 0.8) ) {
+      return (GECOIntegerSetRef)__GECOMixedElementIntegerSetAlloc(theSet->base.count, theSet->array, countOfSingles, countOfRanges);
+    }
+    if ( asBitmap < asArray ) {
+      return (GECOIntegerSetRef)__GECOBitmapIntegerSetAlloc(theSet->base.count, theSet->array, asBitmap, countOfContainers, bitmapBytes);
+    }
   }
   
   // Cheaper as a GECOSimpleArrayIntegerSet:
@@ -814,6 +1322,46 @@ GECOIntegerSetCreateConstantCopy(
 
 //
 
+GECOIntegerSetRef
+GECOIntegerSetCreateConstantWithRanges(
+  unsigned int        rangeCount,
+  const GECOInteger   *ranges
+)
+{
+  GECOMixedElementIntegerSet  *newSet;
+  unsigned int                i, countOfSingles = 0;
+  uint64_t                    count = 0;
+  
+  if ( rangeCount == 0 ) return (GECOIntegerSetRef)__GECOSimpleArrayIntegerSetEmpty();
+  
+  for ( i = 0; i < rangeCount; i++ ) {
+    if ( (ranges[2 * i] > ranges[2 * i + 1]) || ((i > 0) && (ranges[2 * i] <= ranges[2 * i - 1])) ) {
+      errno = EINVAL;
+      return NULL;
+    }
+    if ( ranges[2 * i] == ranges[2 * i + 1] ) countOfSingles++;
+    count += (uint64_t)(ranges[2 * i + 1] - ranges[2 * i]) + 1;
+    if ( count > UINT_MAX ) {
+      errno = EINVAL;
+      return NULL;
+    }
+  }
+  if ( (newSet = __GECOMixedElementIntegerSetAllocBare(countOfSingles, rangeCount - countOfSingles)) ) {
+    unsigned int              rank = 0;
+    
+    for ( i = 0; i < rangeCount; i++ ) {
+      newSet->elements[i].low = ranges[2 * i];
+      newSet->elements[i].high = ranges[2 * i + 1];
+      newSet->ranks[i] = rank;
+      rank += (unsigned int)(ranges[2 * i + 1] - ranges[2 * i]) + 1;
+    }
+    newSet->base.count = rank;
+  }
+  return (GECOIntegerSetRef)newSet;
+}
+
+//
+
 void
 GECOIntegerSetDestroy(
   GECOIntegerSetRef   setOfIntegers
@@ -848,6 +1396,39 @@ GECOIntegerSetGetIntegerAtIndex(
 
 //
 
+unsigned int
+GECOIntegerSetGetRanges(
+  GECOIntegerSetRef   setOfIntegers,
+  GECOInteger         *ranges,
+  unsigned int        maxRanges
+)
+{
+  GECOIntegerSetRangeCursor   cursor = { 0, 0 };
+  GECOInteger                 low, high, lastHigh = 0;
+  unsigned int                rangeCount = 0;
+  
+  //
+  // Backends may split a range (e.g. at a bitmap container boundary), so
+  // coalesce adjacent ranges as they're enumerated:
+  //
+  while ( setOfIntegers->impl.nextRange(setOfIntegers, &cursor, &low, &high) ) {
+    if ( rangeCount && (low == lastHigh + 1) ) {
+      if ( rangeCount <= maxRanges ) ranges[2 * rangeCount - 1] = high;
+      lastHigh = high;
+      continue;
+    }
+    lastHigh = high;
+    if ( rangeCount < maxRanges ) {
+      ranges[2 * rangeCount] = low;
+      ranges[2 * rangeCount + 1] = high;
+    }
+    rangeCount++;
+  }
+  return rangeCount;
+}
+
+//
+
 bool
 GECOIntegerSetContains(
   GECOIntegerSetRef   setOfIntegers,
@@ -933,6 +1514,197 @@ GECOIntegerSetRemoveIntegerRange(
 
 //
 
+bool
+__GECOIntegerSetAppendRange(
+  GECOSimpleArrayIntegerSet   *theSet,
+  GECOInteger                 low,
+  GECOInteger                 high
+)
+{
+  //
+  // Values must arrive in ascending order; anything at or below the last value
+  // already present is skipped:
+  //
+  if ( theSet->base.count && (low <= theSet->array[theSet->base.count - 1]) ) {
+    low = theSet->array[theSet->base.count - 1];
+    if ( low >= high ) return true;
+    low++;
+  }
+  if ( low > high ) return true;
+  if ( (high - low) >= (GECOInteger)(UINT_MAX - theSet->base.count) ) return false;
+  
+  unsigned int                count = (unsigned int)(high - low) + 1;
+  
+  if ( theSet->base.count + count > theSet->capacity ) {
+    unsigned int              newCapacity = theSet->capacity ? theSet->capacity : 32;
+    GECOInteger               *newPtr;
+    
+    while ( newCapacity < theSet->base.count + count ) {
+      if ( newCapacity > UINT_MAX / 2 ) {
+        newCapacity = theSet->base.count + count;
+        break;
+      }
+      newCapacity *= 2;
+    }
+    if ( ! (newPtr = realloc(theSet->array, newCapacity * sizeof(GECOInteger))) ) return false;
+    theSet->array = newPtr;
+    theSet->capacity = newCapacity;
+  }
+  while ( count-- ) theSet->array[theSet->base.count++] = low++;
+  return true;
+}
+
+//
+
+enum {
+  GECOIntegerSetOperationUnion = 0,
+  GECOIntegerSetOperationIntersection,
+  GECOIntegerSetOperationDifference
+};
+
+GECOIntegerSetRef
+__GECOIntegerSetCreateWithOperation(
+  GECOIntegerSetRef   setOfIntegers,
+  GECOIntegerSetRef   otherSetOfIntegers,
+  int                 operation
+)
+{
+  GECOSimpleArrayIntegerSet   *newSet = __GECOSimpleArrayIntegerSetAlloc(0, false);
+  GECOIntegerSetRangeCursor   cursorA = { 0, 0 }, cursorB = { 0, 0 };
+  GECOInteger                 lowA = 0, highA = 0, lowB = 0, highB = 0;
+  bool                        hasA, hasB, ok = true;
+  
+  if ( ! newSet ) return NULL;
+  
+  //
+  // Linear merge of the two range sequences:
+  //
+  hasA = setOfIntegers->impl.nextRange(setOfIntegers, &cursorA, &lowA, &highA);
+  hasB = otherSetOfIntegers->impl.nextRange(otherSetOfIntegers, &cursorB, &lowB, &highB);
+  switch ( operation ) {
+  
+    case GECOIntegerSetOperationUnion: {
+      while ( ok && (hasA || hasB) ) {
+        if ( hasA && (! hasB || (lowA <= lowB)) ) {
+          ok = __GECOIntegerSetAppendRange(newSet, lowA, highA);
+          hasA = setOfIntegers->impl.nextRange(setOfIntegers, &cursorA, &lowA, &highA);
+        } else {
+          ok = __GECOIntegerSetAppendRange(newSet, lowB, highB);
+          hasB = otherSetOfIntegers->impl.nextRange(otherSetOfIntegers, &cursorB, &lowB, &highB);
+        }
+      }
+      break;
+    }
+    
+    case GECOIntegerSetOperationIntersection: {
+      while ( ok && hasA && hasB ) {
+        GECOInteger           low = (lowA > lowB) ? lowA : lowB;
+        GECOInteger           high = (highA < highB) ? highA : highB;
+        
+        if ( low <= high ) ok = __GECOIntegerSetAppendRange(newSet, low, high);
+        if ( highA < highB ) {
+          hasA = setOfIntegers->impl.nextRange(setOfIntegers, &cursorA, &lowA, &highA);
+        } else {
+          hasB = otherSetOfIntegers->impl.nextRange(otherSetOfIntegers, &cursorB, &lowB, &highB);
+        }
+      }
+      break;
+    }
+    
+    case GECOIntegerSetOperationDifference: {
+      while ( ok && hasA ) {
+        GECOInteger           next = lowA;
+        bool                  isDone = false;
+        
+        // Carve each range of B out of the current range of A:
+        while ( ok && hasB && (lowB <= highA) ) {
+          if ( highB >= next ) {
+            if ( lowB > next ) ok = __GECOIntegerSetAppendRange(newSet, next, lowB - 1);
+            if ( highB >= highA ) {
+              isDone = true;
+              break;
+            }
+            next = highB + 1;
+          }
+          hasB = otherSetOfIntegers->impl.nextRange(otherSetOfIntegers, &cursorB, &lowB, &highB);
+        }
+        if ( ok && ! isDone ) ok = __GECOIntegerSetAppendRange(newSet, next, highA);
+        hasA = setOfIntegers->impl.nextRange(setOfIntegers, &cursorA, &lowA, &highA);
+      }
+      break;
+    }
+    
+  }
+  if ( ! ok ) {
+    GECOSimpleArrayIntegerSetDealloc((GECOIntegerSetRef)newSet);
+    return NULL;
+  }
+  return (GECOIntegerSetRef)newSet;
+}
+
+//
+
+GECOIntegerSetRef
+GECOIntegerSetCreateUnion(
+  GECOIntegerSetRef   setOfIntegers,
+  GECOIntegerSetRef   otherSetOfIntegers
+)
+{
+  return __GECOIntegerSetCreateWithOperation(setOfIntegers, otherSetOfIntegers, GECOIntegerSetOperationUnion);
+}
+
+//
+
+GECOIntegerSetRef
+GECOIntegerSetCreateIntersection(
+  GECOIntegerSetRef   setOfIntegers,
+  GECOIntegerSetRef   otherSetOfIntegers
+)
+{
+  return __GECOIntegerSetCreateWithOperation(setOfIntegers, otherSetOfIntegers, GECOIntegerSetOperationIntersection);
+}
+
+//
+
+GECOIntegerSetRef
+GECOIntegerSetCreateDifference(
+  GECOIntegerSetRef   setOfIntegers,
+  GECOIntegerSetRef   otherSetOfIntegers
+)
+{
+  return __GECOIntegerSetCreateWithOperation(setOfIntegers, otherSetOfIntegers, GECOIntegerSetOperationDifference);
+}
+
+//
+
+bool
+GECOIntegerSetIntersectsAny(
+  GECOIntegerSetRef   setOfIntegers,
+  GECOIntegerSetRef   otherSetOfIntegers,
+  GECOInteger         *commonInteger
+)
+{
+  GECOIntegerSetRangeCursor   cursorA = { 0, 0 }, cursorB = { 0, 0 };
+  GECOInteger                 lowA, highA, lowB, highB;
+  bool                        hasA, hasB;
+  
+  hasA = setOfIntegers->impl.nextRange(setOfIntegers, &cursorA, &lowA, &highA);
+  hasB = otherSetOfIntegers->impl.nextRange(otherSetOfIntegers, &cursorB, &lowB, &highB);
+  while ( hasA && hasB ) {
+    if ( highA < lowB ) {
+      hasA = setOfIntegers->impl.nextRange(setOfIntegers, &cursorA, &lowA, &highA);
+    } else if ( highB < lowA ) {
+      hasB = otherSetOfIntegers->impl.nextRange(otherSetOfIntegers, &cursorB, &lowB, &highB);
+    } else {
+      if ( commonInteger ) *commonInteger = (lowA > lowB) ? lowA : lowB;
+      return true;
+    }
+  }
+  return false;
+}
+
+//
+
 void
 GECOIntegerSetSummarizeToStream(
   GECOIntegerSetRef   setOfIntegers,
@@ -63,11 +63,28 @@ GECOIntegerSetRef GECOIntegerSetCopy(GECOIntegerSetRef setOfIntegers);
     Create an integer set that contains the integer values present in
     setOfIntegers.  The resulting set cannot have values added/removed
     from it.
+
+    The representation is chosen based on the density of the values:  a few
+    singles and ranges are scanned linearly; clustered or dense values are
+    partitioned into 16-bit-keyed array, bitmap, or run containers; and sparse
+    values are kept in a sorted array.
   @result
     Returns NULL if a new set could not be allocated.
 */
 GECOIntegerSetRef GECOIntegerSetCreateConstantCopy(GECOIntegerSetRef setOfIntegers);
 
+/*!
+  @function GECOIntegerSetCreateConstantWithRanges
+  @discussion
+    Create a constant integer set from rangeCount inclusive ranges.  The ranges
+    array holds 2 * rangeCount values as consecutive (low, high) pairs, and the
+    ranges must be in ascending order and must not overlap.
+  @result
+    Returns NULL (with errno set to EINVAL) if the ranges are not valid, or
+    if a new set could not be allocated.
+*/
+GECOIntegerSetRef GECOIntegerSetCreateConstantWithRanges(unsigned int rangeCount, const GECOInteger *ranges);
+
 /*!
   @function GECOIntegerSetDestroy
   @discussion
@@ -92,6 +109,18 @@ unsigned int GECOIntegerSetGetCount(GECOIntegerSetRef setOfIntegers);
 */
 GECOInteger GECOIntegerSetGetIntegerAtIndex(GECOIntegerSetRef setOfIntegers, unsigned int index);
 
+/*!
+  @function GECOIntegerSetGetRanges
+  @discussion
+    Copy up to maxRanges of the inclusive ranges of values in setOfIntegers
+    (in ascending order) into the ranges array as consecutive (low, high)
+    pairs.  The array must have room for 2 * maxRanges values.
+  @result
+    Returns the total number of ranges in setOfIntegers, which may exceed
+    maxRanges.
+*/
+unsigned int GECOIntegerSetGetRanges(GECOIntegerSetRef setOfIntegers, GECOInteger *ranges, unsigned int maxRanges);
+
 /*!
   @function GECOIntegerSetContains
   @result
@@ -145,6 +174,48 @@ void GECOIntegerSetRemoveIntegerArray(GECOIntegerSetRef setOfIntegers, unsigned
 */
 void GECOIntegerSetRemoveIntegerRange(GECOIntegerSetRef setOfIntegers, GECOInteger lowInteger, GECOInteger highInteger);
 
+/*!
+  @function GECOIntegerSetCreateUnion
+  @discussion
+    Create a new integer set containing every integer value present in either
+    setOfIntegers or otherSetOfIntegers.  The two sets are merged linearly as
+    sequences of ranges rather than value-by-value.
+  @result
+    Returns NULL if a new set could not be allocated.
+*/
+GECOIntegerSetRef GECOIntegerSetCreateUnion(GECOIntegerSetRef setOfIntegers, GECOIntegerSetRef otherSetOfIntegers);
+
+/*!
+  @function GECOIntegerSetCreateIntersection
+  @discussion
+    Create a new integer set containing the integer values present in both
+    setOfIntegers and otherSetOfIntegers.
+  @result
+    Returns NULL if a new set could not be allocated.
+*/
+GECOIntegerSetRef GECOIntegerSetCreateIntersection(GECOIntegerSetRef setOfIntegers, GECOIntegerSetRef otherSetOfIntegers);
+
+/*!
+  @function GECOIntegerSetCreateDifference
+  @discussion
+    Create a new integer set containing the integer values present in
+    setOfIntegers but not in otherSetOfIntegers.
+  @result
+    Returns NULL if a new set could not be allocated.
+*/
+GECOIntegerSetRef GECOIntegerSetCreateDifference(GECOIntegerSetRef setOfIntegers, GECOIntegerSetRef otherSetOfIntegers);
+
+/*!
+  @function GECOIntegerSetIntersectsAny
+  @discussion
+    Determine whether setOfIntegers and otherSetOfIntegers have at least one
+    integer value in common, stopping at the first one found.  If commonInteger
+    is not NULL, it is set to that value.
+  @result
+    Returns boolean true if the sets intersect.
+*/
+bool GECOIntegerSetIntersectsAny(GECOIntegerSetRef setOfIntegers, GECOIntegerSetRef otherSetOfIntegers, GECOInteger *commonInteger);
+
 /*!
   @function GECOIntegerSetSummarizeToStream
   @discussion
@@ -25,6 +25,16 @@
 
 //
 
+#ifndef GECOJOB_CPUSET_RETRY_INTERVAL
+#define GECOJOB_CPUSET_RETRY_INTERVAL   5
+#endif
+
+#ifndef GECOJOB_CPUSET_RETRY_COUNT
+#define GECOJOB_CPUSET_RETRY_COUNT      12
+#endif
+
+//
+
 typedef struct _GECOJob {
   //
   // Reference count:
@@ -62,6 +72,13 @@ typedef struct _GECOJob {
   //
   GECORunloopRef            scheduledInRunloop;
   //
+  // Pending asynchronous cgroup init (cpuset allocation retries):
+  //
+  GECORunloopRef            cgroupInitRunloop;
+  GECORunloopTimerRef       cgroupInitRetryTimer;
+  int                       cgroupInitRetryCount;
+  struct _GECOJobCGroupInitWaiter *cgroupInitWaiters;
+  //
   // Implemented as a linked list of active jobs:
   //
   struct _GECOJob           *link;
@@ -69,6 +86,17 @@ typedef struct _GECOJob {
 
 //
 
+//
+// Each GECOJobCGroupInitAsync() caller waiting on a pending init:
+//
+typedef struct _GECOJobCGroupInitWaiter {
+  GECOJobCGroupInitCompletionCallback completion;
+  const void                          *context;
+  struct _GECOJobCGroupInitWaiter     *link;
+} GECOJobCGroupInitWaiter;
+
+//
+
 static GECOJob  *__GECOJobPool = NULL;
 static GECOJob  *__GECOJobList = NULL;
 static bool     __GECOJobInited = false;
@@ -257,6 +285,12 @@ __GECOJobDestroy(
     theJob->scheduledInRunloop = false;
   }
   
+  if ( theJob->cgroupInitRetryTimer ) {
+    GECO_TRACE_DEBUG(theJob, "cancelling pending cpuset allocation for job %ld.%ld", theJob->jobId, theJob->taskId);
+    GECORunloopInvalidateTimer(theJob->cgroupInitRunloop, theJob->cgroupInitRetryTimer);
+    theJob->cgroupInitRetryTimer = NULL;
+  }
+  
   if ( theJob->resourceInfo ) {
 #ifdef GECO_JOB_ALWAYS_DESTROY_RESOURCE_CACHE
     // If this is the master task, then try to remove the resource file:
@@ -304,6 +338,8 @@ __GECOJobDestroy(
   }
 #else
   if ( theJob->allocatedCpuSet ) {
+    GECO_TRACE_INFO(theJob, "returning granted cpuset for job %ld.%ld", theJob->jobId, theJob->taskId);
+    GECOCGroupDeallocateCoresForJobIdentifier(theJob->jobId, theJob->taskId);
     hwloc_bitmap_free(theJob->allocatedCpuSet);
     theJob->allocatedCpuSet = NULL;
   }
@@ -362,9 +398,10 @@ GECOJobDeinit(void)
 
 GECOJobRef
 __GECOJobCreateWithJobIdentifier(
-  long int  jobId,
-  long int  taskId,
-  bool      shouldOnlyInitFromResourceCache
+  long int            jobId,
+  long int            taskId,
+  bool                shouldOnlyInitFromResourceCache,
+  GECOResourceSetRef  loadedResources
 )
 {
   GECOJob                 *newJob = __GECOJobList, *prev = NULL;
@@ -396,9 +433,18 @@ __GECOJobCreateWithJobIdentifier(
     pathLen = snprintf(path, sizeof(path), "%s/resources/%ld.%ld", GECOGetStateDir(), jobId, taskId);
     if ( pathLen >= sizeof(path) ) {
       GECO_ERROR("__GECOJobCreateWithJobIdentifier: path exceeds PATH_MAX (%d >= %d)", pathLen, (int)sizeof(path));
+      if ( loadedResources ) GECOResourceSetDestroy(loadedResources);
       return NULL;
     }
-    if ( GECOIsFile(path) ) {
+    if ( loadedResources ) {
+      //
+      // Resource information was already fetched by the caller (e.g. on a
+      // worker thread); take ownership of it:
+      //
+      jobResources = loadedResources;
+      loadedResources = NULL;
+      shouldExportResourceFile = true;
+    } else if ( GECOIsFile(path) ) {
       int       try = 0;
       
 retry:
@@ -487,6 +533,7 @@ retry:
     // Increase reference count:
     GECOJobRetain(newJob);
   }
+  if ( loadedResources ) GECOResourceSetDestroy(loadedResources);
   return newJob;
 }
 
@@ -498,7 +545,7 @@ GECOJobCreateWithJobIdentifier(
   long int  taskId
 )
 {
-  return __GECOJobCreateWithJobIdentifier(jobId, taskId, false);
+  return __GECOJobCreateWithJobIdentifier(jobId, taskId, false, NULL);
 }
 
 //
@@ -509,7 +556,19 @@ GECOJobCreateWithJobIdentifierFromResourceCache(
   long int  taskId
 )
 {
-  return __GECOJobCreateWithJobIdentifier(jobId, taskId, true);
+  return __GECOJobCreateWithJobIdentifier(jobId, taskId, true, NULL);
+}
+
+//
+
+GECOJobRef
+GECOJobCreateWithJobIdentifierAndResourceSet(
+  long int            jobId,
+  long int            taskId,
+  GECOResourceSetRef  jobResources
+)
+{
+  return __GECOJobCreateWithJobIdentifier(jobId, taskId, false, jobResources);
 }
 
 //
@@ -616,8 +675,122 @@ GECOJobGetTaskId(
 typedef struct {
   GECOJobRef      theJob;
   GECORunloopRef  theRunloop;
+  bool            shouldDeferRetries;
+  bool            isDeferred;
 } GECOJobCGroupInitCallbackContext;
 
+bool
+__GECOJobCGroupInitAddWaiter(
+  GECOJobRef                          theJob,
+  GECOJobCGroupInitCompletionCallback completion,
+  const void                          *context
+)
+{
+  GECOJobCGroupInitWaiter             *waiter = malloc(sizeof(GECOJobCGroupInitWaiter));
+  GECOJobCGroupInitWaiter             **tail = &theJob->cgroupInitWaiters;
+  
+  if ( ! waiter ) return false;
+  waiter->completion = completion;
+  waiter->context = context;
+  waiter->link = NULL;
+  
+  // Completions are run in the order they were requested:
+  while ( *tail ) tail = &(*tail)->link;
+  *tail = waiter;
+  
+  //
+  // Each waiter holds a reference so the job outlives any deferred completion:
+  //
+  GECOJobRetain(theJob);
+  return true;
+}
+
+void
+__GECOJobCGroupInitComplete(
+  GECOJobRef      theJob,
+  bool            success
+)
+{
+  GECOJobCGroupInitWaiter *waiter = theJob->cgroupInitWaiters;
+  
+  //
+  // Detach the list first; a completion is free to start another init:
+  //
+  theJob->cgroupInitWaiters = NULL;
+  theJob->cgroupInitRunloop = NULL;
+  while ( waiter ) {
+    GECOJobCGroupInitWaiter *next = waiter->link;
+    
+    if ( waiter->completion ) waiter->completion(theJob, success, waiter->context);
+    free((void*)waiter);
+    
+    //
+    // Drop the reference this waiter held while the init was pending:
+    //
+    GECOJobRelease(theJob);
+    waiter = next;
+  }
+}
+
+#ifndef LIBGECO_PRE_V101
+
+bool
+__GECOJobCGroupAllocateAndBindCpuset(
+  GECOJobRef      theJob
+)
+{
+  GECOResourcePerNodeData rsrcLimits;
+  
+  GECOResourcePerNodeGetNodeData(theJob->hostResourceInfo, &rsrcLimits);
+  if ( GECOCGroupAllocateCoresForJobIdentifier(theJob->jobId, theJob->taskId, rsrcLimits.slotCount, &theJob->allocatedCpuSet) ) {
+    if ( ! GECOCGroupSetCpusetCpus(theJob->jobId, theJob->taskId, theJob->allocatedCpuSet) ) {
+      GECOCGroupDeallocateCoresForJobIdentifier(theJob->jobId, theJob->taskId);
+      hwloc_bitmap_free(theJob->allocatedCpuSet);
+      theJob->allocatedCpuSet = NULL;
+    }
+  } else {
+    GECO_TRACE_ERROR(theJob, "GECOJobCGroupInit: unable to allocate %ld core%s for %ld.%ld", rsrcLimits.slotCount, ((rsrcLimits.slotCount == 1) ? "" : "s"), theJob->jobId, theJob->taskId);
+  }
+  if ( theJob->allocatedCpuSet ) {
+    char        *cpulist_str = NULL;
+    
+    hwloc_bitmap_list_asprintf(&cpulist_str, theJob->allocatedCpuSet);
+    if ( cpulist_str ) {
+      GECO_TRACE_INFO(theJob, "%ld.%ld successfully bound to cpuset %s", theJob->jobId, theJob->taskId, cpulist_str);
+      free(cpulist_str);
+    } else {
+      GECO_TRACE_INFO(theJob, "%ld.%ld successfully bound to allocated cpuset", theJob->jobId, theJob->taskId);
+    }
+    return true;
+  }
+  return false;
+}
+
+//
+
+void
+__GECOJobCGroupInitRetryTimerFired(
+  GECORunloopTimerRef theTimer,
+  GECORunloopRef      theRunloop,
+  const void          *context
+)
+{
+  GECOJob             *theJob = (GECOJob*)context;
+  bool                success = __GECOJobCGroupAllocateAndBindCpuset(theJob);
+  
+  if ( ! success && (++theJob->cgroupInitRetryCount < GECOJOB_CPUSET_RETRY_COUNT) ) {
+    GECO_TRACE_WARN(theJob, "GECOJobCGroupInit: %ld.%ld will retry in %d seconds (%d of %d)", theJob->jobId, theJob->taskId, GECOJOB_CPUSET_RETRY_INTERVAL, theJob->cgroupInitRetryCount + 1, GECOJOB_CPUSET_RETRY_COUNT);
+    return;
+  }
+  if ( ! success ) GECO_TRACE_ERROR(theJob, "GECOJobCGroupInit: %ld.%ld failed all retries", theJob->jobId, theJob->taskId);
+  
+  GECORunloopInvalidateTimer(theRunloop, theTimer);
+  theJob->cgroupInitRetryTimer = NULL;
+  __GECOJobCGroupInitComplete(theJob, success);
+}
+
+#endif
+
 bool
 __GECOJobCGroupInitCallback(
   long int              jobId,
@@ -764,49 +937,46 @@ cpuset_tryagain:
           //
           // Version 1.0.1 and later:
           //
-          // Ask for a cpuset, try to bind it, retry after 5 seconds if it fails, and do that for ~ 1 minute.
+          // Ask for a cpuset, try to bind it, retry every GECOJOB_CPUSET_RETRY_INTERVAL seconds if it
+          // fails, and do that up to GECOJOB_CPUSET_RETRY_COUNT times.  When the caller asked for the
+          // asynchronous variant, the retries are driven by a runloop timer rather than sleep():
           //
-          int         retryNumber = 0, maxRetryCount = 12;
-
           if ( GECOFLAGS_ISSET(theJob->cgroupInitStates, (1 << GECOCGroupSubsystem_cpuset)) ) {
             //
             // Cleanup from previous run that exited and caused the subgroup to be destroyed:
             //
             if ( theJob->allocatedCpuSet ) {
+              GECOCGroupDeallocateCoresForJobIdentifier(theJob->jobId, theJob->taskId);
               hwloc_bitmap_free(theJob->allocatedCpuSet);
               theJob->allocatedCpuSet = NULL;
             }
           }
           GECOFLAGS_SET(theJob->cgroupInitStates, (1 << GECOCGroupSubsystem_cpuset));
-cpuset_tryagain:
-          if ( GECOCGroupAllocateCores(rsrcLimits.slotCount, &theJob->allocatedCpuSet) ) {
-            if ( ! GECOCGroupSetCpusetCpus(theJob->jobId, theJob->taskId, theJob->allocatedCpuSet) ) {
-              GECOCGroupDeallocateCores(theJob->allocatedCpuSet);
-              theJob->allocatedCpuSet = NULL;
-            }
-          } else {
-            GECO_TRACE_ERROR(theJob, "GECOJobCGroupInit: unable to allocate %ld core%s for %ld.%ld", rsrcLimits.slotCount, ((rsrcLimits.slotCount == 1) ? "" : "s"), theJob->jobId, theJob->taskId);
-          }
-          if ( ! theJob->allocatedCpuSet ) {
-            if ( retryNumber++ < maxRetryCount ) {
-              GECO_TRACE_WARN(theJob, "GECOJobCGroupInit: %ld.%ld will retry in 5 seconds (%d of %d)", theJob->jobId, theJob->taskId, retryNumber, maxRetryCount);
-              sleep(5);
-              goto cpuset_tryagain;
-            } else {
-              GECO_TRACE_ERROR(theJob, "GECOJobCGroupInit: %ld.%ld failed all retries", theJob->jobId, theJob->taskId);
-              rc = false;
-            }
-          } else {
-            char        *cpulist_str = NULL;
-            
-            hwloc_bitmap_list_asprintf(&cpulist_str, theJob->allocatedCpuSet);
-            if ( cpulist_str ) {
-              GECO_TRACE_INFO(theJob, "%ld.%ld successfully bound to cpuset %s", theJob->jobId, theJob->taskId, cpulist_str);
-              free(cpulist_str);
+          if ( ! __GECOJobCGroupAllocateAndBindCpuset(theJob) ) {
+            if ( CONTEXT->shouldDeferRetries && CONTEXT->theRunloop ) {
+              theJob->cgroupInitRetryCount = 0;
+              theJob->cgroupInitRetryTimer = GECORunloopAddTimer(CONTEXT->theRunloop, GECOJOB_CPUSET_RETRY_INTERVAL, true, __GECOJobCGroupInitRetryTimerFired, theJob);
+              if ( theJob->cgroupInitRetryTimer ) {
+                GECO_TRACE_WARN(theJob, "GECOJobCGroupInit: %ld.%ld will retry in %d seconds (1 of %d)", theJob->jobId, theJob->taskId, GECOJOB_CPUSET_RETRY_INTERVAL, GECOJOB_CPUSET_RETRY_COUNT);
+                theJob->cgroupInitRunloop = CONTEXT->theRunloop;
+                CONTEXT->isDeferred = true;
+              } else {
+                GECO_TRACE_ERROR(theJob, "GECOJobCGroupInit: unable to schedule cpuset retry for %ld.%ld", theJob->jobId, theJob->taskId);
+                rc = false;
+              }
             } else {
-              GECO_TRACE_INFO(theJob, "%ld.%ld successfully bound to allocated cpuset", theJob->jobId, theJob->taskId);
+              int         retryNumber = 0;
+              
+              while ( retryNumber++ < GECOJOB_CPUSET_RETRY_COUNT ) {
+                GECO_TRACE_WARN(theJob, "GECOJobCGroupInit: %ld.%ld will retry in %d seconds (%d of %d)", theJob->jobId, theJob->taskId, GECOJOB_CPUSET_RETRY_INTERVAL, retryNumber, GECOJOB_CPUSET_RETRY_COUNT);
+                sleep(GECOJOB_CPUSET_RETRY_INTERVAL);
+                if ( __GECOJobCGroupAllocateAndBindCpuset(theJob) ) break;
+              }
+              if ( ! theJob->allocatedCpuSet ) {
+                GECO_TRACE_ERROR(theJob, "GECOJobCGroupInit: %ld.%ld failed all retries", theJob->jobId, theJob->taskId);
+                rc = false;
+              }
             }
-            rc = true;
           }
 #endif
         }
@@ -840,6 +1010,62 @@ GECOJobCGroupInit(
 
 //
 
+void
+GECOJobCGroupInitAsync(
+  GECOJobRef                          theJob,
+  GECORunloopRef                      theRunloop,
+  GECOJobCGroupInitCompletionCallback completion,
+  const void                          *context
+)
+{
+  bool                              rc = false;
+  GECOJobCGroupInitCallbackContext  callbackContext = {
+                                        .theJob = theJob,
+                                        .theRunloop = theRunloop,
+                                        .shouldDeferRetries = true,
+                                        .isDeferred = false
+                                      };
+  
+  if ( ! __GECOJobCGroupInitAddWaiter(theJob, completion, context) ) {
+    GECO_TRACE_ERROR(theJob, "GECOJobCGroupInitAsync: unable to allocate completion record for %ld.%ld", theJob->jobId, theJob->taskId);
+    if ( completion ) completion(theJob, false, context);
+    return;
+  }
+  if ( theJob->cgroupInitRetryTimer ) {
+    //
+    // An earlier init is still waiting on a cpuset; this caller gets the same
+    // outcome when it finishes or runs out of retries:
+    //
+    GECO_TRACE_DEBUG(theJob, "GECOJobCGroupInitAsync: cgroup init already pending for %ld.%ld, completion queued", theJob->jobId, theJob->taskId);
+    return;
+  }
+  
+  rc = GECOCGroupInitForJobIdentifier(theJob->jobId, theJob->taskId, __GECOJobCGroupInitCallback, &callbackContext);
+  if ( ! rc ) {
+    GECO_TRACE_ERROR(theJob, "GECOJobCGroupInitAsync: unable to initialize cgroup support for %ld.%ld", theJob->jobId, theJob->taskId);
+    if ( theJob->cgroupInitRetryTimer ) {
+      GECORunloopInvalidateTimer(theRunloop, theJob->cgroupInitRetryTimer);
+      theJob->cgroupInitRetryTimer = NULL;
+    }
+  } else if ( callbackContext.isDeferred ) {
+    GECO_TRACE_INFO(theJob, "cgroup init for %ld.%ld deferred until a cpuset can be allocated", theJob->jobId, theJob->taskId);
+    return;
+  }
+  __GECOJobCGroupInitComplete(theJob, rc);
+}
+
+//
+
+bool
+GECOJobCGroupInitIsPending(
+  GECOJobRef      theJob
+)
+{
+  return ( theJob->cgroupInitRetryTimer != NULL );
+}
+
+//
+
 bool
 GECOJobCGroupDeinit(
   GECOJobRef    theJob
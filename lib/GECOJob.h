@@ -43,6 +43,20 @@ void GECOJobDeinit(void);
 GECOJobRef GECOJobCreateWithJobIdentifier(long int jobId, long int taskId);
 GECOJobRef GECOJobCreateWithJobIdentifierFromResourceCache(long int jobId, long int taskId);
 
+/*!
+  @function GECOJobCreateWithJobIdentifierAndResourceSet
+  @discussion
+    Like GECOJobCreateWithJobIdentifier(), but the job's resource information
+    has already been obtained by the caller (e.g. via GECOResourceSetCreate()
+    on a thread other than the main thread) rather than being loaded from the
+    resource cache or qstat.
+
+    Ownership of jobResources passes to this function:  it becomes the job's
+    resource information or is destroyed (e.g. if the job object already
+    exists or could not be created).
+*/
+GECOJobRef GECOJobCreateWithJobIdentifierAndResourceSet(long int jobId, long int taskId, GECOResourceSetRef jobResources);
+
 GECOJobRef GECOJobGetExistingObjectForJobIdentifier(long int jobId, long int taskId);
 
 bool GECOJobIdentiferExistsInResourceCache(long int jobId, long int taskId);
@@ -57,6 +71,37 @@ long int GECOJobGetTaskId(GECOJobRef theJob);
 bool GECOJobHasExited(GECOJobRef theJob);
 
 bool GECOJobCGroupInit(GECOJobRef theJob, GECORunloopRef theRunloop);
+
+/*!
+  @typedef GECOJobCGroupInitCompletionCallback
+  @discussion
+    Type of the function invoked when an asynchronous cgroup init of theJob
+    has finished; success indicates whether all subsystems were set up.
+*/
+typedef void (*GECOJobCGroupInitCompletionCallback)(GECOJobRef theJob, bool success, const void *context);
+
+/*!
+  @function GECOJobCGroupInitAsync
+  @discussion
+    Variant of GECOJobCGroupInit that never blocks waiting on a cpuset.  If
+    cores cannot be allocated immediately, the allocation is retried from a
+    timer on theRunloop until it succeeds or the retries are exhausted.
+
+    The completion callback is invoked exactly once:  before this function
+    returns if nothing had to be deferred, otherwise from theRunloop.  If an
+    init of theJob is already pending, the completion is queued and invoked
+    with that init's outcome.  A reference to theJob is held until the
+    completion callback returns.
+*/
+void GECOJobCGroupInitAsync(GECOJobRef theJob, GECORunloopRef theRunloop, GECOJobCGroupInitCompletionCallback completion, const void *context);
+
+/*!
+  @function GECOJobCGroupInitIsPending
+  @result
+    Returns boolean true if an asynchronous cgroup init of theJob is still
+    waiting on a cpuset allocation.
+*/
+bool GECOJobCGroupInitIsPending(GECOJobRef theJob);
 bool GECOJobCGroupDeinit(GECOJobRef theJob);
 
 bool GECOJobCGroupAddPid(GECOJobRef theJob, pid_t aPid);
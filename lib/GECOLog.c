@@ -260,6 +260,10 @@ GECOLogVPrintf(
       localtime_r(&now, &dateAndTime);
       strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S%z", &dateAndTime);
     }
+    
+    // Hold the stream lock across the whole line so that lines logged from
+    // multiple threads do not interleave:
+    flockfile(theLog->logFPtr);
     switch ( theLog->logFormat & (GECOLogFormatTimestamp | GECOLogFormatPid | GECOLogFormatLevelLabel) ) {
     
       case (GECOLogFormatTimestamp | GECOLogFormatPid | GECOLogFormatLevelLabel):
@@ -294,6 +298,7 @@ GECOLogVPrintf(
     vfprintf(theLog->logFPtr, format, argv);
     
     fputc('\n', theLog->logFPtr);
+    funlockfile(theLog->logFPtr);
   }
   if ( logAtLevel == GECOLogLevelEmergency ) exit(1);
 }
@@ -20,49 +20,55 @@ __GECOPidToJobIdMapPidHashFunction(
   pid_t   aPid
 )
 {
-  uint32_t  hashVal = 0;
-  uint8_t   *pidAsBytes = (uint8_t*)&aPid;
-  int       pidByteSize = sizeof(pid_t);
+  uint32_t  hashVal = (uint32_t)aPid;
   
-  // CRC-style hash:
-  hashVal = pidAsBytes[0];
-  hashVal = ((hashVal << 5) ^ ((hashVal & 0xf8000000) >> 27)) ^ pidAsBytes[1];
-  hashVal = ((hashVal << 5) ^ ((hashVal & 0xf8000000) >> 27)) ^ pidAsBytes[2];
-  hashVal = ((hashVal << 5) ^ ((hashVal & 0xf8000000) >> 27)) ^ pidAsBytes[3];
+  // Finalizer from MurmurHash3; every input bit affects every output bit:
+  hashVal ^= hashVal >> 16;
+  hashVal *= 0x85ebca6b;
+  hashVal ^= hashVal >> 13;
+  hashVal *= 0xc2b2ae35;
+  hashVal ^= hashVal >> 16;
   return hashVal;
 }
 
 //
 
+uint32_t
+__GECOPidToJobIdMapJobHashFunction(
+  long int  jobId,
+  long int  taskId
+)
+{
+  uint64_t  hashVal = ((uint64_t)jobId * 0x9e3779b97f4a7c15ULL) ^ (uint64_t)taskId;
+  
+  // Finalizer from MurmurHash3 (64-bit variant):
+  hashVal ^= hashVal >> 33;
+  hashVal *= 0xff51afd7ed558ccdULL;
+  hashVal ^= hashVal >> 33;
+  hashVal *= 0xc4ceb9fe1a85ec53ULL;
+  hashVal ^= hashVal >> 33;
+  return (uint32_t)hashVal;
+}
+
+//
+
 typedef struct _GECOPidToJobIdMapNode {
   pid_t                           thePid;
+  unsigned int                    jobPidIndex;
   long int                        jobId, taskId;
-  struct _GECOPidToJobIdMapNode   *link;
+  long long int                   startTime;
 } GECOPidToJobIdMapNode;
 
 //
-
-GECOPidToJobIdMapNode*
-__GECOPidToJobIdMapNodeInit(
-  GECOPidToJobIdMapNode *aNode
-)
-{
-  if ( aNode ) {
-    aNode->thePid = -1;
-    aNode->jobId = -1;
-    aNode->taskId = -1;
-    aNode->link = NULL;
-  }
-  return aNode;
-}
-
+// Secondary index:  each (jobId, taskId) with at least one mapped pid has a node
+// holding the list of its pids.  Every pid node records its position in that list
+// (jobPidIndex) so it can be removed from it in constant time.
 //
-
-GECOPidToJobIdMapNode*
-__GECOPidToJobIdMapNodeAlloc(void)
-{
-  return __GECOPidToJobIdMapNodeInit(malloc(sizeof(GECOPidToJobIdMapNode)));
-}
+typedef struct _GECOPidToJobIdMapJobNode {
+  long int                        jobId, taskId;
+  unsigned int                    pidCount, pidCapacity;
+  pid_t                           *pids;
+} GECOPidToJobIdMapJobNode;
 
 //
 #if 0
@@ -75,48 +81,123 @@ __GECOPidToJobIdMapNodeAlloc(void)
 #endif
 const unsigned int GECOPidToJobIdMapHashSize = GECOPIDTOJOBIDMAP_HASH_SIZE;
 
-#ifndef GECOPIDTOJOBIDMAP_POOL_SIZE
-#define GECOPIDTOJOBIDMAP_POOL_SIZE 8
+#ifndef GECOPIDTOJOBIDMAP_JOB_HASH_SIZE
+#define GECOPIDTOJOBIDMAP_JOB_HASH_SIZE 16
+#endif
+
+//
+// The tables grow (doubling) once they're more than GECOPIDTOJOBIDMAP_MAX_LOAD percent full:
+//
+#ifndef GECOPIDTOJOBIDMAP_MAX_LOAD
+#define GECOPIDTOJOBIDMAP_MAX_LOAD  70
 #endif
-const unsigned int GECOPidToJobIdMapPoolSize = GECOPIDTOJOBIDMAP_POOL_SIZE;
 
 //
 
 typedef struct _GECOPidToJobIdMap {
-  unsigned int              tableSize, nodeCount;
-  GECOPidToJobIdMapNode     *nodePool, *staticPoolStart, *staticPoolEnd;
-  GECOPidToJobIdMapNode*    nodeTable[0];
+  unsigned int              tableSize, tableMask, nodeCount, growThreshold;
+  GECOPidToJobIdMapNode     *nodeTable;
+  //
+  unsigned int              jobTableSize, jobTableMask, jobNodeCount, jobGrowThreshold;
+  GECOPidToJobIdMapJobNode  *jobNodeTable;
 } GECOPidToJobIdMap;
 
 //
 
+bool
+__GECOPidToJobIdMapSetTableSize(
+  GECOPidToJobIdMap     *aMap,
+  unsigned int          tableSize
+)
+{
+  GECOPidToJobIdMapNode *newTable = calloc(tableSize, sizeof(GECOPidToJobIdMapNode));
+  
+  if ( newTable ) {
+    GECOPidToJobIdMapNode *oldTable = aMap->nodeTable;
+    unsigned int          i = aMap->tableSize, tableMask = tableSize - 1;
+    
+    //
+    // Rehash the existing mappings into the new table:
+    //
+    while ( i-- ) {
+      if ( oldTable[i].thePid > 0 ) {
+        unsigned int      j = __GECOPidToJobIdMapPidHashFunction(oldTable[i].thePid) & tableMask;
+        
+        while ( newTable[j].thePid > 0 ) j = (j + 1) & tableMask;
+        newTable[j] = oldTable[i];
+      }
+    }
+    if ( oldTable ) free((void*)oldTable);
+    aMap->nodeTable = newTable;
+    aMap->tableSize = tableSize;
+    aMap->tableMask = tableMask;
+    aMap->growThreshold = (unsigned int)(((uint64_t)tableSize * GECOPIDTOJOBIDMAP_MAX_LOAD) / 100);
+    GECO_DEBUG("pid mapping table resized to %u slots (%u mappings)", tableSize, aMap->nodeCount);
+    return true;
+  }
+  return false;
+}
+
+//
+
+bool
+__GECOPidToJobIdMapSetJobTableSize(
+  GECOPidToJobIdMap         *aMap,
+  unsigned int              tableSize
+)
+{
+  GECOPidToJobIdMapJobNode  *newTable = calloc(tableSize, sizeof(GECOPidToJobIdMapJobNode));
+  
+  if ( newTable ) {
+    GECOPidToJobIdMapJobNode  *oldTable = aMap->jobNodeTable;
+    unsigned int              i = aMap->jobTableSize, tableMask = tableSize - 1;
+    
+    while ( i-- ) {
+      if ( oldTable[i].pids ) {
+        unsigned int          j = __GECOPidToJobIdMapJobHashFunction(oldTable[i].jobId, oldTable[i].taskId) & tableMask;
+        
+        while ( newTable[j].pids ) j = (j + 1) & tableMask;
+        newTable[j] = oldTable[i];
+      }
+    }
+    if ( oldTable ) free((void*)oldTable);
+    aMap->jobNodeTable = newTable;
+    aMap->jobTableSize = tableSize;
+    aMap->jobTableMask = tableMask;
+    aMap->jobGrowThreshold = (unsigned int)(((uint64_t)tableSize * GECOPIDTOJOBIDMAP_MAX_LOAD) / 100);
+    GECO_DEBUG("job mapping table resized to %u slots (%u jobs)", tableSize, aMap->jobNodeCount);
+    return true;
+  }
+  return false;
+}
+
+//
+
 GECOPidToJobIdMap*
 __GECOPidToJobIdMapAlloc(
   unsigned int      tableSize
 )
 {
   GECOPidToJobIdMap     *newMap;
+  unsigned int          actualSize = 16;
   
   if ( tableSize <= 1 ) tableSize = GECOPidToJobIdMapHashSize;
+  //
+  // Table sizes are always a power of two:
+  //
+  while ( actualSize < tableSize ) actualSize <<= 1;
   
-  newMap = malloc(sizeof(GECOPidToJobIdMap) + tableSize * sizeof(GECOPidToJobIdMapNode*) + GECOPidToJobIdMapPoolSize * sizeof(GECOPidToJobIdMapNode));
+  newMap = malloc(sizeof(GECOPidToJobIdMap));
   if ( newMap ) {
-    newMap->tableSize = tableSize;
-    newMap->nodeCount = 0;
-    if ( GECOPidToJobIdMapPoolSize > 0 ) {
-      GECOPidToJobIdMapNode *node;
-      
-      newMap->staticPoolStart = node = (GECOPidToJobIdMapNode*)(((void*)newMap) + sizeof(GECOPidToJobIdMap) + tableSize * sizeof(GECOPidToJobIdMapNode*));
-      newMap->staticPoolEnd = newMap->staticPoolStart + GECOPidToJobIdMapPoolSize;
-      newMap->nodePool = NULL;
-      while ( node < newMap->staticPoolEnd ) {
-        __GECOPidToJobIdMapNodeInit(node);
-        node->link = newMap->nodePool;
-        newMap->nodePool = node;
-        node++;
-      }
+    newMap->tableSize = newMap->tableMask = newMap->nodeCount = newMap->growThreshold = 0;
+    newMap->nodeTable = NULL;
+    newMap->jobTableSize = newMap->jobTableMask = newMap->jobNodeCount = newMap->jobGrowThreshold = 0;
+    newMap->jobNodeTable = NULL;
+    if ( ! __GECOPidToJobIdMapSetTableSize(newMap, actualSize) || ! __GECOPidToJobIdMapSetJobTableSize(newMap, GECOPIDTOJOBIDMAP_JOB_HASH_SIZE) ) {
+      if ( newMap->nodeTable ) free((void*)newMap->nodeTable);
+      free((void*)newMap);
+      newMap = NULL;
     }
-    while ( tableSize-- ) newMap->nodeTable[tableSize] = NULL;
   }
   return newMap;
 }
@@ -128,59 +209,182 @@ __GECOPidToJobIdMapDealloc(
   GECOPidToJobIdMap     *aMap
 )
 {
-  GECOPidToJobIdMapNode *node, *next;
-  unsigned int          i = 0;
+  unsigned int          i = aMap->jobTableSize;
+  
+  while ( i-- ) if ( aMap->jobNodeTable[i].pids ) free((void*)aMap->jobNodeTable[i].pids);
+  if ( aMap->jobNodeTable ) free((void*)aMap->jobNodeTable);
+  if ( aMap->nodeTable ) free((void*)aMap->nodeTable);
+  free((void*)aMap);
+}
+
+//
+
+int
+__GECOPidToJobIdMapIndexForPid(
+  GECOPidToJobIdMap     *aMap,
+  pid_t                 aPid
+)
+{
+  unsigned int          i = __GECOPidToJobIdMapPidHashFunction(aPid) & aMap->tableMask;
+  
+  while ( aMap->nodeTable[i].thePid > 0 ) {
+    if ( aMap->nodeTable[i].thePid == aPid ) return i;
+    i = (i + 1) & aMap->tableMask;
+  }
+  return -1;
+}
+
+//
+
+void
+__GECOPidToJobIdMapDeleteAtIndex(
+  GECOPidToJobIdMap     *aMap,
+  unsigned int          i
+)
+{
+  unsigned int          hole = i, j = i;
   
-  // Drop all nodes in the table:
-  while ( i < aMap->tableSize ) {
-    node = aMap->nodeTable[i++];
-    while ( node ) {
-      next = node->link;
-      if ( node < aMap->staticPoolStart || node >= aMap->staticPoolEnd ) free((void*)node);
-      node = next;
+  //
+  // Backward-shift deletion:  pull any displaced entries in the same cluster back
+  // into the hole so that lookups never need tombstones:
+  //
+  while ( true ) {
+    unsigned int        home;
+    
+    j = (j + 1) & aMap->tableMask;
+    if ( aMap->nodeTable[j].thePid <= 0 ) break;
+    home = __GECOPidToJobIdMapPidHashFunction(aMap->nodeTable[j].thePid) & aMap->tableMask;
+    //
+    // Entry j can move into the hole only if its home slot does not lie
+    // cyclically within (hole, j]:
+    //
+    if ( ((j - home) & aMap->tableMask) >= ((j - hole) & aMap->tableMask) ) {
+      aMap->nodeTable[hole] = aMap->nodeTable[j];
+      hole = j;
     }
   }
+  aMap->nodeTable[hole].thePid = 0;
+  aMap->nodeCount--;
+}
+
+//
+
+int
+__GECOPidToJobIdMapIndexForJob(
+  GECOPidToJobIdMap     *aMap,
+  long int              jobId,
+  long int              taskId
+)
+{
+  unsigned int          i = __GECOPidToJobIdMapJobHashFunction(jobId, taskId) & aMap->jobTableMask;
   
-  // Drop all nodes in the pool:
-  node = aMap->nodePool;
-  while ( node ) {
-    next = node->link;
-    if ( node < aMap->staticPoolStart || node >= aMap->staticPoolEnd ) free((void*)node);
-    node = next;
+  while ( aMap->jobNodeTable[i].pids ) {
+    if ( (aMap->jobNodeTable[i].jobId == jobId) && (aMap->jobNodeTable[i].taskId == taskId) ) return i;
+    i = (i + 1) & aMap->jobTableMask;
   }
+  return -1;
+}
+
+//
+
+void
+__GECOPidToJobIdMapDeleteJobAtIndex(
+  GECOPidToJobIdMap     *aMap,
+  unsigned int          i
+)
+{
+  unsigned int          hole = i, j = i;
   
-  free((void*)aMap);
+  free((void*)aMap->jobNodeTable[i].pids);
+  while ( true ) {
+    unsigned int        home;
+    
+    j = (j + 1) & aMap->jobTableMask;
+    if ( ! aMap->jobNodeTable[j].pids ) break;
+    home = __GECOPidToJobIdMapJobHashFunction(aMap->jobNodeTable[j].jobId, aMap->jobNodeTable[j].taskId) & aMap->jobTableMask;
+    if ( ((j - home) & aMap->jobTableMask) >= ((j - hole) & aMap->jobTableMask) ) {
+      aMap->jobNodeTable[hole] = aMap->jobNodeTable[j];
+      hole = j;
+    }
+  }
+  aMap->jobNodeTable[hole].pids = NULL;
+  aMap->jobNodeTable[hole].pidCount = aMap->jobNodeTable[hole].pidCapacity = 0;
+  aMap->jobNodeCount--;
 }
 
 //
 
-GECOPidToJobIdMapNode*
-__GECOPidToJobIdMapAllocNode(
-  GECOPidToJobIdMap     *aMap
+bool
+__GECOPidToJobIdMapJobAddPid(
+  GECOPidToJobIdMap         *aMap,
+  long int                  jobId,
+  long int                  taskId,
+  pid_t                     aPid,
+  unsigned int              *jobPidIndex
 )
 {
-  GECOPidToJobIdMapNode *newNode;
+  int                       i = __GECOPidToJobIdMapIndexForJob(aMap, jobId, taskId);
+  GECOPidToJobIdMapJobNode  *jobNode;
   
-  if ( aMap->nodePool ) {
-    newNode = aMap->nodePool;
-    aMap->nodePool = newNode->link;
+  if ( i < 0 ) {
+    pid_t                   *pids;
+    
+    if ( (aMap->jobNodeCount >= aMap->jobGrowThreshold) && ! __GECOPidToJobIdMapSetJobTableSize(aMap, 2 * aMap->jobTableSize) ) {
+      if ( aMap->jobNodeCount + 1 >= aMap->jobTableSize ) return false;
+    }
+    if ( ! (pids = malloc(4 * sizeof(pid_t))) ) return false;
+    i = __GECOPidToJobIdMapJobHashFunction(jobId, taskId) & aMap->jobTableMask;
+    while ( aMap->jobNodeTable[i].pids ) i = (i + 1) & aMap->jobTableMask;
+    jobNode = &aMap->jobNodeTable[i];
+    jobNode->jobId = jobId;
+    jobNode->taskId = taskId;
+    jobNode->pidCount = 0;
+    jobNode->pidCapacity = 4;
+    jobNode->pids = pids;
+    aMap->jobNodeCount++;
   } else {
-    newNode = __GECOPidToJobIdMapNodeAlloc();
+    jobNode = &aMap->jobNodeTable[i];
+    if ( jobNode->pidCount == jobNode->pidCapacity ) {
+      pid_t                 *pids = realloc(jobNode->pids, 2 * jobNode->pidCapacity * sizeof(pid_t));
+      
+      if ( ! pids ) return false;
+      jobNode->pids = pids;
+      jobNode->pidCapacity *= 2;
+    }
   }
-  return newNode;
+  *jobPidIndex = jobNode->pidCount;
+  jobNode->pids[jobNode->pidCount++] = aPid;
+  return true;
 }
 
 //
 
 void
-__GECOPidToJobIdMapDeallocNode(
-  GECOPidToJobIdMap     *aMap,
-  GECOPidToJobIdMapNode *aNode
+__GECOPidToJobIdMapJobRemovePid(
+  GECOPidToJobIdMap         *aMap,
+  long int                  jobId,
+  long int                  taskId,
+  unsigned int              jobPidIndex
 )
 {
-  __GECOPidToJobIdMapNodeInit(aNode);
-  aNode->link = aMap->nodePool;
-  aMap->nodePool = aNode;
+  int                       i = __GECOPidToJobIdMapIndexForJob(aMap, jobId, taskId);
+  
+  if ( i >= 0 ) {
+    GECOPidToJobIdMapJobNode  *jobNode = &aMap->jobNodeTable[i];
+    
+    if ( --jobNode->pidCount == 0 ) {
+      __GECOPidToJobIdMapDeleteJobAtIndex(aMap, i);
+    } else if ( jobPidIndex < jobNode->pidCount ) {
+      //
+      // Move the last pid in the list into the vacated position:
+      //
+      pid_t                 movedPid = jobNode->pids[jobNode->pidCount];
+      int                   j = __GECOPidToJobIdMapIndexForPid(aMap, movedPid);
+      
+      jobNode->pids[jobPidIndex] = movedPid;
+      if ( j >= 0 ) aMap->nodeTable[j].jobPidIndex = jobPidIndex;
+    }
+  }
 }
 
 //
@@ -209,6 +413,16 @@ GECOPidToJobIdMapDestroy(
 
 //
 
+unsigned int
+GECOPidToJobIdMapGetCount(
+  GECOPidToJobIdMapRef  aMap
+)
+{
+  return aMap->nodeCount;
+}
+
+//
+
 bool
 GECOPidToJobIdMapHasJobAndTaskId(
   GECOPidToJobIdMapRef  aMap,
@@ -216,16 +430,104 @@ GECOPidToJobIdMapHasJobAndTaskId(
   long int              taskId
 )
 {
-  GECOPidToJobIdMapNode *node, *next;
-  unsigned int          i = 0;
+  return ( __GECOPidToJobIdMapIndexForJob(aMap, jobId, taskId) >= 0 );
+}
+
+//
+
+unsigned int
+GECOPidToJobIdMapGetPidCountForJobAndTaskId(
+  GECOPidToJobIdMapRef  aMap,
+  long int              jobId,
+  long int              taskId
+)
+{
+  int                   i = __GECOPidToJobIdMapIndexForJob(aMap, jobId, taskId);
   
-  // Drop all nodes in the table:
-  while ( i < aMap->tableSize ) {
-    node = aMap->nodeTable[i++];
-    while ( node ) {
-      if ( (node->jobId == jobId) && (node->taskId == taskId) ) return true;
-      node = node->link;
+  return ( i >= 0 ) ? aMap->jobNodeTable[i].pidCount : 0;
+}
+
+//
+
+unsigned int
+GECOPidToJobIdMapGetPidsForJobAndTaskId(
+  GECOPidToJobIdMapRef  aMap,
+  long int              jobId,
+  long int              taskId,
+  pid_t                 *pids,
+  unsigned int          maxPids
+)
+{
+  int                   i = __GECOPidToJobIdMapIndexForJob(aMap, jobId, taskId);
+  
+  if ( i >= 0 ) {
+    unsigned int        pidCount = aMap->jobNodeTable[i].pidCount;
+    
+    if ( pids && maxPids ) memcpy(pids, aMap->jobNodeTable[i].pids, ((pidCount < maxPids) ? pidCount : maxPids) * sizeof(pid_t));
+    return pidCount;
+  }
+  return 0;
+}
+
+//
+
+unsigned int
+GECOPidToJobIdMapGetPids(
+  GECOPidToJobIdMapRef  aMap,
+  unsigned int          *cursor,
+  pid_t                 *pids,
+  unsigned int          maxPids
+)
+{
+  unsigned int          i = *cursor, pidCount = 0;
+  
+  while ( (i < aMap->tableSize) && (pidCount < maxPids) ) {
+    if ( aMap->nodeTable[i].thePid > 0 ) pids[pidCount++] = aMap->nodeTable[i].thePid;
+    i++;
+  }
+  *cursor = ( i < aMap->tableSize ) ? i : 0;
+  return pidCount;
+}
+
+//
+
+unsigned int
+GECOPidToJobIdMapGetJobs(
+  GECOPidToJobIdMapRef      aMap,
+  unsigned int              *cursor,
+  GECOPidToJobIdMapJobCount *jobCounts,
+  unsigned int              maxJobCounts
+)
+{
+  unsigned int              i = *cursor, jobCount = 0;
+  
+  while ( (i < aMap->jobTableSize) && (jobCount < maxJobCounts) ) {
+    if ( aMap->jobNodeTable[i].pids ) {
+      jobCounts[jobCount].jobId = aMap->jobNodeTable[i].jobId;
+      jobCounts[jobCount].taskId = aMap->jobNodeTable[i].taskId;
+      jobCounts[jobCount].pidCount = aMap->jobNodeTable[i].pidCount;
+      jobCount++;
     }
+    i++;
+  }
+  *cursor = ( i < aMap->jobTableSize ) ? i : 0;
+  return jobCount;
+}
+
+//
+
+bool
+GECOPidToJobIdMapGetStartTimeForPid(
+  GECOPidToJobIdMapRef  aMap,
+  pid_t                 aPid,
+  long long int         *startTime
+)
+{
+  int                   i = ( aPid > 0 ) ? __GECOPidToJobIdMapIndexForPid(aMap, aPid) : -1;
+  
+  if ( i >= 0 ) {
+    *startTime = aMap->nodeTable[i].startTime;
+    return true;
   }
   return false;
 }
@@ -240,17 +542,12 @@ GECOPidToJobIdMapGetJobAndTaskIdForPid(
   long int              *taskId
 )
 {
-  unsigned int          i = __GECOPidToJobIdMapPidHashFunction(aPid) % aMap->tableSize;
-  GECOPidToJobIdMapNode *node = aMap->nodeTable[i];
+  int                   i = ( aPid > 0 ) ? __GECOPidToJobIdMapIndexForPid(aMap, aPid) : -1;
   
-  while ( node ) {
-    if ( node->thePid == aPid ) {
-      *jobId = node->jobId;
-      *taskId = node->taskId;
-      return true;
-    }
-    if ( node->thePid > aPid ) break;
-    node = node->link;
+  if ( i >= 0 ) {
+    *jobId = aMap->nodeTable[i].jobId;
+    *taskId = aMap->nodeTable[i].taskId;
+    return true;
   }
   return false;
 }
@@ -265,33 +562,44 @@ GECOPidToJobIdMapAddPid(
   long int              taskId
 )
 {
-  unsigned int          i = __GECOPidToJobIdMapPidHashFunction(aPid) % aMap->tableSize;
-  GECOPidToJobIdMapNode *prev = NULL, *node = aMap->nodeTable[i];
+  return GECOPidToJobIdMapAddPidWithStartTime(aMap, aPid, 0, jobId, taskId);
+}
+
+//
+
+bool
+GECOPidToJobIdMapAddPidWithStartTime(
+  GECOPidToJobIdMapRef  aMap,
+  pid_t                 aPid,
+  long long int         startTime,
+  long int              jobId,
+  long int              taskId
+)
+{
+  unsigned int          i, jobPidIndex;
   
-  while ( node ) {
-    if ( node->thePid == aPid ) return true;
-    if ( node->thePid > aPid ) break;
-    prev = node;
-    node = node->link;
+  if ( aPid <= 0 ) return false;
+  if ( (aMap->nodeCount >= aMap->growThreshold) && ! __GECOPidToJobIdMapSetTableSize(aMap, 2 * aMap->tableSize) ) {
+    //
+    // Can't grow, but so long as there's an empty slot we can keep going:
+    //
+    if ( aMap->nodeCount + 1 >= aMap->tableSize ) return false;
   }
   
-  GECOPidToJobIdMapNode *newNode = __GECOPidToJobIdMapAllocNode(aMap);
-  if ( newNode ) {
-    newNode->thePid = aPid;
-    newNode->jobId = jobId;
-    newNode->taskId = taskId;
-    
-    if ( prev ) {
-      newNode->link = prev->link;
-      prev->link = newNode;
-    } else {
-      newNode->link = aMap->nodeTable[i];
-      aMap->nodeTable[i] = newNode;
-    }
-    GECO_DEBUG("added mapping pid(%ld) => (%ld, %ld) at hash index %u", aPid, jobId, taskId, i);
-    return true;
+  i = __GECOPidToJobIdMapPidHashFunction(aPid) & aMap->tableMask;
+  while ( aMap->nodeTable[i].thePid > 0 ) {
+    if ( aMap->nodeTable[i].thePid == aPid ) return true;
+    i = (i + 1) & aMap->tableMask;
   }
-  return false;
+  if ( ! __GECOPidToJobIdMapJobAddPid(aMap, jobId, taskId, aPid, &jobPidIndex) ) return false;
+  aMap->nodeTable[i].thePid = aPid;
+  aMap->nodeTable[i].jobPidIndex = jobPidIndex;
+  aMap->nodeTable[i].jobId = jobId;
+  aMap->nodeTable[i].taskId = taskId;
+  aMap->nodeTable[i].startTime = startTime;
+  aMap->nodeCount++;
+  GECO_DEBUG("added mapping pid(%ld) => (%ld, %ld) at hash index %u", (long int)aPid, jobId, taskId, i);
+  return true;
 }
 
 //
@@ -302,22 +610,85 @@ GECOPidToJobIdMapRemovePid(
   pid_t                 aPid
 )
 {
-  unsigned int          i = __GECOPidToJobIdMapPidHashFunction(aPid) % aMap->tableSize;
-  GECOPidToJobIdMapNode *prev = NULL, *node = aMap->nodeTable[i];
+  int                   i = ( aPid > 0 ) ? __GECOPidToJobIdMapIndexForPid(aMap, aPid) : -1;
   
-  while ( node ) {
-    if ( node->thePid == aPid ) {
-      GECO_DEBUG("removed mapping pid(%ld) => (%ld, %ld) at hash index %u", aPid, node->jobId, node->taskId, i);
-      if ( prev ) {
-        prev->link = node->link;
-      } else {
-        aMap->nodeTable[i] = node->link;
+  if ( i >= 0 ) {
+    GECO_DEBUG("removed mapping pid(%ld) => (%ld, %ld) at hash index %u", (long int)aPid, aMap->nodeTable[i].jobId, aMap->nodeTable[i].taskId, i);
+    __GECOPidToJobIdMapJobRemovePid(aMap, aMap->nodeTable[i].jobId, aMap->nodeTable[i].taskId, aMap->nodeTable[i].jobPidIndex);
+    __GECOPidToJobIdMapDeleteAtIndex(aMap, i);
+  }
+}
+
+//
+
+unsigned int
+GECOPidToJobIdMapRemovePids(
+  GECOPidToJobIdMapRef      aMap,
+  unsigned int              pidCount,
+  const pid_t               *pids,
+  GECOPidToJobIdMapJobCount *jobCounts,
+  unsigned int              maxJobCounts
+)
+{
+  unsigned int              jobCount = 0, lastJob = 0;
+  
+  while ( pidCount-- ) {
+    pid_t                   aPid = *pids++;
+    int                     i = ( aPid > 0 ) ? __GECOPidToJobIdMapIndexForPid(aMap, aPid) : -1;
+    
+    if ( i >= 0 ) {
+      GECOPidToJobIdMapNode *node = &aMap->nodeTable[i];
+      
+      //
+      // Exits tend to arrive grouped by job, so check the job we saw last
+      // before searching the rest:
+      //
+      if ( (jobCount == 0) || (jobCounts[lastJob].jobId != node->jobId) || (jobCounts[lastJob].taskId != node->taskId) ) {
+        unsigned int        j = 0;
+        
+        while ( (j < jobCount) && ((jobCounts[j].jobId != node->jobId) || (jobCounts[j].taskId != node->taskId)) ) j++;
+        if ( j == jobCount ) {
+          if ( jobCount == maxJobCounts ) continue;
+          jobCounts[j].jobId = node->jobId;
+          jobCounts[j].taskId = node->taskId;
+          jobCounts[j].pidCount = 0;
+          jobCount++;
+        }
+        lastJob = j;
       }
-      __GECOPidToJobIdMapDeallocNode(aMap, node);
-      break;
+      jobCounts[lastJob].pidCount++;
+      __GECOPidToJobIdMapJobRemovePid(aMap, node->jobId, node->taskId, node->jobPidIndex);
+      __GECOPidToJobIdMapDeleteAtIndex(aMap, i);
+    }
+  }
+  GECO_DEBUG("batch removal of pid mappings affected %u job%s", jobCount, ((jobCount == 1) ? "" : "s"));
+  return jobCount;
+}
+
+//
+
+unsigned int
+GECOPidToJobIdMapRemoveJobAndTaskId(
+  GECOPidToJobIdMapRef  aMap,
+  long int              jobId,
+  long int              taskId
+)
+{
+  int                   i = __GECOPidToJobIdMapIndexForJob(aMap, jobId, taskId);
+  unsigned int          pidCount = 0;
+  
+  if ( i >= 0 ) {
+    GECOPidToJobIdMapJobNode  *jobNode = &aMap->jobNodeTable[i];
+    unsigned int              k;
+    
+    pidCount = jobNode->pidCount;
+    for ( k = 0; k < pidCount; k++ ) {
+      int                     j = __GECOPidToJobIdMapIndexForPid(aMap, jobNode->pids[k]);
+      
+      if ( j >= 0 ) __GECOPidToJobIdMapDeleteAtIndex(aMap, j);
     }
-    if ( node->thePid > aPid ) break;
-    prev = node;
-    node = node->link;
+    __GECOPidToJobIdMapDeleteJobAtIndex(aMap, i);
+    GECO_DEBUG("removed all %u mapping%s => (%ld, %ld)", pidCount, ((pidCount == 1) ? "" : "s"), jobId, taskId);
   }
+  return pidCount;
 }
@@ -22,12 +22,24 @@
 */
 typedef struct _GECOPidToJobIdMap * GECOPidToJobIdMapRef;
 
+/*!
+  @typedef GECOPidToJobIdMapJobCount
+  @discussion
+    Data structure used to report how many process ids associated with
+    (jobId, taskId) were removed by GECOPidToJobIdMapRemovePids().
+*/
+typedef struct {
+  long int          jobId, taskId;
+  unsigned int      pidCount;
+} GECOPidToJobIdMapJobCount;
+
 /*!
   @function GECOPidToJobIdMapCreate
   @discussion
     Create a new (intially empty) pid-to-job-id mapping table.  Internally, the
-    pids will be hashed into a table of the given tableSize.  If tableSize is zero,
-    the default size is used.
+    pids will be hashed into an open-addressed table of (at least) the given
+    tableSize, which grows automatically as mappings are added.  If tableSize is
+    zero, the default size is used.
   @result
     Returns NULL if a new map could not be allocated.
 */
@@ -42,14 +54,78 @@ GECOPidToJobIdMapRef GECOPidToJobIdMapCreate(unsigned int tableSize);
 */
 void GECOPidToJobIdMapDestroy(GECOPidToJobIdMapRef aMap);
 
+/*!
+  @function GECOPidToJobIdMapGetCount
+  @discussion
+    Returns the number of process ids that have a mapping in aMap.
+*/
+unsigned int GECOPidToJobIdMapGetCount(GECOPidToJobIdMapRef aMap);
+
 /*!
   @function GECOPidToJobIdMapHasJobAndTaskId
   @discussion
     If aMap contains any mapping of a process id to (jobId, taskId) then return
-    boolean true.
+    boolean true.  Mappings are indexed by (jobId, taskId) as well as by
+    process id, so this is a constant-time check.
 */
 bool GECOPidToJobIdMapHasJobAndTaskId(GECOPidToJobIdMapRef aMap, long int jobId, long int taskId);
 
+/*!
+  @function GECOPidToJobIdMapGetPidCountForJobAndTaskId
+  @discussion
+    Returns the number of process ids in aMap that are mapped to (jobId, taskId).
+*/
+unsigned int GECOPidToJobIdMapGetPidCountForJobAndTaskId(GECOPidToJobIdMapRef aMap, long int jobId, long int taskId);
+
+/*!
+  @function GECOPidToJobIdMapGetPidsForJobAndTaskId
+  @discussion
+    Copy up to maxPids of the process ids mapped to (jobId, taskId) into the
+    pids array (in no particular order).
+  @result
+    Returns the total number of process ids mapped to (jobId, taskId), which
+    may exceed maxPids.
+*/
+unsigned int GECOPidToJobIdMapGetPidsForJobAndTaskId(GECOPidToJobIdMapRef aMap, long int jobId, long int taskId, pid_t *pids, unsigned int maxPids);
+
+/*!
+  @function GECOPidToJobIdMapGetPids
+  @discussion
+    Enumerate the process ids in aMap a piece at a time.  Start with *cursor
+    set to zero; up to maxPids process ids are copied into the pids array and
+    *cursor is updated so that the next call continues where this one left
+    off.  Once the whole map has been visited *cursor is reset to zero.
+
+    Mappings may be removed between calls, but a pass during which that
+    happens may skip (or repeat) some process ids.
+  @result
+    Returns the number of process ids copied into pids.
+*/
+unsigned int GECOPidToJobIdMapGetPids(GECOPidToJobIdMapRef aMap, unsigned int *cursor, pid_t *pids, unsigned int maxPids);
+
+/*!
+  @function GECOPidToJobIdMapGetJobs
+  @discussion
+    Enumerate the distinct (jobId, taskId) pairs in aMap a piece at a time, in
+    the same fashion as GECOPidToJobIdMapGetPids().  Each entry filled-in in
+    the jobCounts array carries the number of process ids currently mapped to
+    that job.
+  @result
+    Returns the number of entries filled-in in jobCounts.
+*/
+unsigned int GECOPidToJobIdMapGetJobs(GECOPidToJobIdMapRef aMap, unsigned int *cursor, GECOPidToJobIdMapJobCount *jobCounts, unsigned int maxJobCounts);
+
+/*!
+  @function GECOPidToJobIdMapGetStartTimeForPid
+  @discussion
+    If the given process id, aPid, has a mapping in aMap then set *startTime to
+    the start time (in jiffies, as reported by GECOGetPidInfo()) recorded with
+    it.  A start time of zero means none was recorded.
+  @result
+    Returns boolean true if aPid is present.
+*/
+bool GECOPidToJobIdMapGetStartTimeForPid(GECOPidToJobIdMapRef aMap, pid_t aPid, long long int *startTime);
+
 /*!
   @function GECOPidToJobIdMapGetJobAndTaskIdForPid
   @discussion
@@ -69,6 +145,16 @@ bool GECOPidToJobIdMapGetJobAndTaskIdForPid(GECOPidToJobIdMapRef aMap, pid_t aPi
 */
 bool GECOPidToJobIdMapAddPid(GECOPidToJobIdMapRef aMap, pid_t aPid, long int jobId, long int taskId);
 
+/*!
+  @function GECOPidToJobIdMapAddPidWithStartTime
+  @discussion
+    Same as GECOPidToJobIdMapAddPid(), but also records the start time of aPid
+    so that a later reuse of the process id can be detected.
+  @result
+    Returns boolean true if the association was successfully added.
+*/
+bool GECOPidToJobIdMapAddPidWithStartTime(GECOPidToJobIdMapRef aMap, pid_t aPid, long long int startTime, long int jobId, long int taskId);
+
 /*!
   @function GECOPidToJobIdMapRemovePid
   @discussion
@@ -77,4 +163,29 @@ bool GECOPidToJobIdMapAddPid(GECOPidToJobIdMapRef aMap, pid_t aPid, long int job
 */
 void GECOPidToJobIdMapRemovePid(GECOPidToJobIdMapRef aMap, pid_t aPid);
 
+/*!
+  @function GECOPidToJobIdMapRemovePids
+  @discussion
+    Remove the associations for the pidCount process ids in the pids array in a
+    single pass.  Process ids with no association in aMap are ignored.
+
+    For each distinct (jobId, taskId) affected, an entry in the jobCounts array
+    is filled-in with the number of process ids removed for it.  Passing
+    maxJobCounts >= pidCount guarantees that every pid can be accounted for;
+    otherwise, a pid belonging to a job for which no jobCounts entry could be
+    allocated is left in aMap.
+  @result
+    Returns the number of entries filled-in in jobCounts.
+*/
+unsigned int GECOPidToJobIdMapRemovePids(GECOPidToJobIdMapRef aMap, unsigned int pidCount, const pid_t *pids, GECOPidToJobIdMapJobCount *jobCounts, unsigned int maxJobCounts);
+
+/*!
+  @function GECOPidToJobIdMapRemoveJobAndTaskId
+  @discussion
+    Remove every process id associated with (jobId, taskId) from aMap.
+  @result
+    Returns the number of process ids that were removed.
+*/
+unsigned int GECOPidToJobIdMapRemoveJobAndTaskId(GECOPidToJobIdMapRef aMap, long int jobId, long int taskId);
+
 #endif /* __GECOPIDTOJOBIDMAP_H__ */
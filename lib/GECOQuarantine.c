@@ -29,6 +29,10 @@
 #define MSG_MORE 0
 #endif
 
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
 //
 
 ssize_t
@@ -46,7 +50,10 @@ __GECOQuarantineRecv(
   while ( keepGoing && (total < fullLen) ) {
     rc = recv(sockfd, buf, len, flags | MSG_WAITALL);
     
-    if ( rc < len ) {
+    if ( rc == 0 ) {
+      // Peer closed the connection:
+      keepGoing = false;
+    } else if ( rc < len ) {
       if ( rc > 0 ) {
         buf += rc;
         len -= rc;
@@ -84,11 +91,10 @@ __GECOQuarantineSend(
   bool          keepGoing = true;
   
   while ( keepGoing && (total < fullLen) ) {
-    rc = send(sockfd, buf, len, flags);
+    rc = send(sockfd, buf, len, flags | MSG_NOSIGNAL);
     
     if ( rc < len ) {
       if ( rc > 0 ) {
-        total += rc;
         buf += rc;
         len -= rc;
         total += rc;
@@ -734,7 +740,8 @@ GECOQuarantineSocketClose(
     }
     
     case GECOQuarantineSocketTypeFilePath: {
-      if ( GECOIsSocketFile(theSocket->socketAddrInfo) ) {
+      // Only the server owns the socket file:
+      if ( isServer && GECOIsSocketFile(theSocket->socketAddrInfo) ) {
         if ( unlink(theSocket->socketAddrInfo) != 0 ) {
           GECO_ERROR("GECOQuarantineSocketClose: unable to remove socket file at path %s (errno = %d)", theSocket->socketAddrInfo, errno);
           rc = false;
@@ -12,9 +12,11 @@
  */
 
 #include "GECOResource.h"
+#include "GECOIntegerSet.h"
 
 #include <pwd.h>
 #include <grp.h>
+#include <pthread.h>
 
 //
 
@@ -30,6 +32,10 @@
 #define GECORESOURCE_PHILIST_MAX 24
 #endif
 
+#ifndef GECORESOURCE_OWNER_LOOKUP_MAX
+#define GECORESOURCE_OWNER_LOOKUP_MAX 4096
+#endif
+
 #ifndef GECORESOURCE_QSTAT_CMD
 #define GECORESOURCE_QSTAT_CMD    "qstat"
 #endif
@@ -49,7 +55,12 @@ typedef struct _GECOResourcePerNode {
   struct _GECOResourcePerNode *link;
 } GECOResourcePerNode;
 
+//
+// Resource sets may be created and destroyed on different threads (gecod runs
+// qstat lookups on worker threads), so the free list is locked:
+//
 GECOResourcePerNode           *perNodePool = NULL;
+static pthread_mutex_t        perNodePoolLock = PTHREAD_MUTEX_INITIALIZER;
 
 //
 
@@ -58,10 +69,10 @@ __GECOResourcePerNodeAlloc(void)
 {
   GECOResourcePerNode   *newRecord = NULL;
   
-  if ( perNodePool ) {
-    newRecord = perNodePool;
-    perNodePool = newRecord->link;
-  } else {
+  pthread_mutex_lock(&perNodePoolLock);
+  if ( (newRecord = perNodePool) ) perNodePool = newRecord->link;
+  pthread_mutex_unlock(&perNodePoolLock);
+  if ( ! newRecord ) {
     newRecord = malloc(sizeof(GECOResourcePerNode) + GECORESOURCE_NODENAME_MAX + GECORESOURCE_GPULIST_MAX + GECORESOURCE_PHILIST_MAX);
   }
   if ( newRecord ) {
@@ -83,8 +94,10 @@ __GECOResourcePerNodeDealloc(
   GECOResourcePerNode   *oldRecord
 )
 {
+  pthread_mutex_lock(&perNodePoolLock);
   oldRecord->link = perNodePool;
   perNodePool = oldRecord;
+  pthread_mutex_unlock(&perNodePoolLock);
 }
 
 //
@@ -186,18 +199,24 @@ __GECOResourceSetIterate(
     GECOResourceSet     *theResourceSet
   )
   {
-    struct passwd       *ownerPasswdRec = NULL;
+    struct passwd       ownerPasswd, *ownerPasswdRec = NULL;
+    struct group        ownerGroup, *ownerGroupRec = NULL;
+    char                lookupBuffer[GECORESOURCE_OWNER_LOOKUP_MAX];
     
+    //
+    // The reentrant variants are used so that resource sets can be
+    // created on threads other than the main thread:
+    //
     if ( theResourceSet->ownerUname ) {
-      if ( (ownerPasswdRec = getpwnam(theResourceSet->ownerUname)) ) {
+      if ( (getpwnam_r(theResourceSet->ownerUname, &ownerPasswd, lookupBuffer, sizeof(lookupBuffer), &ownerPasswdRec) == 0) && ownerPasswdRec ) {
         theResourceSet->ownerUid = ownerPasswdRec->pw_uid;
         theResourceSet->isOwnerUidSet = true;
+      } else {
+        ownerPasswdRec = NULL;
       }
     }
     if ( theResourceSet->ownerGname ) {
-      struct group   *ownerGroupRec = getgrnam(theResourceSet->ownerGname);
-      
-      if ( ownerGroupRec ) {
+      if ( (getgrnam_r(theResourceSet->ownerGname, &ownerGroup, lookupBuffer, sizeof(lookupBuffer), &ownerGroupRec) == 0) && ownerGroupRec ) {
         theResourceSet->ownerGid = ownerGroupRec->gr_gid;
         theResourceSet->isOwnerGidSet = true;
       } else if ( ownerPasswdRec ) {
@@ -602,41 +621,185 @@ __GECOResourceGetQstatMiscellany(
 #endif
 //
 
-bool
-GECOResourceSetIsJobRunningOnHost(
-  long int                      jobId,
-  long int                      taskId,
+FILE*
+__GECOResourceOpenQStatPipeForJobIds(
+  GECOIntegerSetRef   jobIds
+)
+{
+  FILE                *pipeFPtr = NULL;
+  unsigned int        i = 0, iMax = GECOIntegerSetGetCount(jobIds);
+  size_t              cmdBufferLen = strlen(GECOResourceQstatCmd) + 12 + iMax * 21;
+  char                *cmdBuffer = malloc(cmdBufferLen);
+  
+  if ( cmdBuffer ) {
+    int               offset = snprintf(cmdBuffer, cmdBufferLen, "%s -xml -j ", GECOResourceQstatCmd);
+    
+    while ( (i < iMax) && (offset > 0) && (offset < cmdBufferLen) ) {
+      offset += snprintf(cmdBuffer + offset, cmdBufferLen - offset, "%s%ld", (i ? "," : ""), (long int)GECOIntegerSetGetIntegerAtIndex(jobIds, i));
+      i++;
+    }
+    if ( (offset > 0) && (offset < cmdBufferLen) ) {
+      GECO_DEBUG("executing for %u job%s popen(\"%s\", \"r\")...", iMax, ((iMax == 1) ? "" : "s"), cmdBuffer);
+      pipeFPtr = popen(cmdBuffer, "r");
+    }
+    free(cmdBuffer);
+  }
+  return pipeFPtr;
+}
+
+//
+
+unsigned int
+__GECOResourceSetCheckUnknownJobs(
+  xmlDocPtr                     jobsDoc,
+  unsigned int                  jobCount,
+  const long int                *jobIds,
+  const long int                *taskIds,
+  bool                          *isRunning,
+  int                           retryCount
+)
+{
+  //
+  // qstat answers with an unknown_jobs document if any of the job ids it was
+  // given is unknown, so a batch that mixed live and stale ids says nothing
+  // about the live ones.  Only the ids it names are known not to exist; every
+  // other job is asked about on its own:
+  //
+  GECOIntegerSetRef             unknownJobIds = GECOIntegerSetCreate();
+  xmlXPathContextPtr            xpathCtx = xmlXPathNewContext(jobsDoc);
+  unsigned int                  i, runningCount = 0;
+  
+  if ( unknownJobIds && xpathCtx ) {
+    xmlXPathObjectPtr           xpathObj = xmlXPathEvalExpression((const xmlChar*)"//ST_name", xpathCtx);
+    
+    if ( xpathObj ) {
+      if ( xpathObj->nodesetval ) {
+        for ( i = 0; i < xpathObj->nodesetval->nodeNr; i++ ) {
+          xmlChar               *jobIdStr = xmlNodeGetContent(xpathObj->nodesetval->nodeTab[i]);
+          
+          if ( jobIdStr ) {
+            long int            jobId;
+            
+            if ( GECO_strtol((const char*)jobIdStr, &jobId, NULL) ) GECOIntegerSetAddInteger(unknownJobIds, jobId);
+            xmlFree(jobIdStr);
+          }
+        }
+      }
+      xmlXPathFreeObject(xpathObj);
+    }
+  }
+  for ( i = 0; i < jobCount; i++ ) {
+    if ( isRunning[i] ) continue;
+    if ( unknownJobIds && GECOIntegerSetContains(unknownJobIds, jobIds[i]) ) {
+      GECO_DEBUG("%ld.%ld is not a known job", jobIds[i], taskIds[i]);
+      continue;
+    }
+    if ( (isRunning[i] = GECOResourceSetIsJobRunningOnHost(jobIds[i], taskIds[i], retryCount)) ) runningCount++;
+  }
+  if ( xpathCtx ) xmlXPathFreeContext(xpathCtx);
+  if ( unknownJobIds ) GECOIntegerSetDestroy(unknownJobIds);
+  return runningCount;
+}
+
+//
+
+unsigned int
+GECOResourceSetAreJobsRunningOnHost(
+  unsigned int                  jobCount,
+  const long int                *jobIds,
+  const long int                *taskIds,
+  bool                          *isRunning,
   int                           retryCount
 )
 {
+  const char                    *thisHostname = GECOGetHostname();
+  GECOIntegerSetRef             pendingJobIds = NULL;
   char                          path[PATH_MAX];
   size_t                        pathLen;
-  bool                          rc = false;
+  unsigned int                  i, runningCount = 0;
+  uint64_t                      iteration = 1;
   
   //
-  // Try checking the UGE cell for an active job on this host:
+  // Try checking the UGE cell for active jobs on this host; anything not found there
+  // gets added to the set of job ids to ask qstat about:
   //
-  pathLen = snprintf(path, sizeof(path), "%s/%s/active_jobs/%ld.%ld", GECOResourceGECellPrefix, GECOGetHostname(), jobId, taskId);
-  if ( pathLen && (pathLen < sizeof(path)) ) {
-    rc = GECOIsDirectory(path);
-    if ( rc ) GECO_INFO("%ld.%ld is an active job on this host (%s exists)\n", jobId, taskId, path);
+  for ( i = 0; i < jobCount; i++ ) {
+    isRunning[i] = false;
+    pathLen = snprintf(path, sizeof(path), "%s/%s/active_jobs/%ld.%ld", GECOResourceGECellPrefix, thisHostname, jobIds[i], taskIds[i]);
+    if ( pathLen && (pathLen < sizeof(path)) && GECOIsDirectory(path) ) {
+      GECO_INFO("%ld.%ld is an active job on this host (%s exists)\n", jobIds[i], taskIds[i], path);
+      isRunning[i] = true;
+      runningCount++;
+    } else {
+      if ( ! pendingJobIds && ! (pendingJobIds = GECOIntegerSetCreate()) ) return runningCount;
+      GECOIntegerSetAddInteger(pendingJobIds, jobIds[i]);
+    }
   }
-  if ( ! rc ) {
-    GECOResourceSetCreateFailure  failureReason = 0;
-    GECOResourceSetRef            rsrcInfo = GECOResourceSetCreate(jobId, taskId, retryCount, &failureReason);
-    bool                          rc = false;
+  if ( ! pendingJobIds ) return runningCount;
+  
+  //
+  // A single qstat for all remaining job ids:
+  //
+  while ( true ) {
+    FILE                        *qstatPipe = __GECOResourceOpenQStatPipeForJobIds(pendingJobIds);
+    xmlDocPtr                   jobsDoc = NULL;
     
-    if ( rsrcInfo ) {
-      GECOResourcePerNodeRef      thisHost = GECOResourceSetGetPerNodeForHost(rsrcInfo);
+    if ( qstatPipe ) {
+      jobsDoc = xmlReadFd(fileno(qstatPipe), NULL, NULL, XML_PARSE_NOENT | XML_PARSE_NONET);
+      pclose(qstatPipe);
+    }
+    if ( jobsDoc ) {
+      xmlNodePtr                docRoot = xmlDocGetRootElement(jobsDoc);
+      xmlXPathContextPtr        xpathCtx;
       
-      if ( thisHost ) {
-        rc = true;
-        GECO_INFO("%ld.%ld is an active job on this host (per-host resource info exists)\n", jobId, taskId);
+      if ( docRoot && ! strcmp("unknown_jobs", (const char*)docRoot->name) ) {
+        if ( GECOIntegerSetGetCount(pendingJobIds) > 1 ) runningCount += __GECOResourceSetCheckUnknownJobs(jobsDoc, jobCount, jobIds, taskIds, isRunning, retryCount);
+      } else if ( docRoot && thisHostname && (xpathCtx = xmlXPathNewContext(jobsDoc)) ) {
+        for ( i = 0; i < jobCount; i++ ) {
+          xmlXPathObjectPtr     xpathObj;
+          char                  hostXPath[256 + strlen(thisHostname)];
+          
+          if ( isRunning[i] ) continue;
+          snprintf(hostXPath, sizeof(hostXPath), "//element[JB_job_number=%ld]/JB_ja_tasks/element[JAT_task_number=%ld]//JAT_granted_destin_identifier_list/element[JG_qhostname=\"%s\"]", jobIds[i], taskIds[i], thisHostname);
+          xpathObj = xmlXPathEvalExpression((const xmlChar*)hostXPath, xpathCtx);
+          if ( xpathObj ) {
+            if ( xpathObj->nodesetval && (xpathObj->nodesetval->nodeNr > 0) ) {
+              GECO_INFO("%ld.%ld is an active job on this host (per-host resource info exists)\n", jobIds[i], taskIds[i]);
+              isRunning[i] = true;
+              runningCount++;
+            }
+            xmlXPathFreeObject(xpathObj);
+          }
+        }
+        xmlXPathFreeContext(xpathCtx);
       }
-      GECOResourceSetDestroy(rsrcInfo);
+      xmlFreeDoc(jobsDoc);
+      break;
+    }
+    if ( retryCount-- <= 0 ) {
+      GECO_ERROR("GECOResourceSetAreJobsRunningOnHost: qstat failed to return job information for %u job%s", GECOIntegerSetGetCount(pendingJobIds), ((GECOIntegerSetGetCount(pendingJobIds) == 1) ? "" : "s"));
+      break;
     }
+    GECO_WARN("GECOResourceSetAreJobsRunningOnHost: qstat failed to return job information; sleeping then retrying");
+    GECOSleepForMicroseconds(iteration++ * 1000000);
   }
-  return rc;
+  GECOIntegerSetDestroy(pendingJobIds);
+  return runningCount;
+}
+
+//
+
+bool
+GECOResourceSetIsJobRunningOnHost(
+  long int                      jobId,
+  long int                      taskId,
+  int                           retryCount
+)
+{
+  bool                          isRunning = false;
+  
+  GECOResourceSetAreJobsRunningOnHost(1, &jobId, &taskId, &isRunning, retryCount);
+  return isRunning;
 }
 
 //
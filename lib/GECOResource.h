@@ -52,6 +52,22 @@ typedef enum {
 
 bool GECOResourceSetIsJobRunningOnHost(long int jobId, long int taskId, int retryCount);
 
+/*!
+  @function GECOResourceSetAreJobsRunningOnHost
+  @discussion
+    Batched form of GECOResourceSetIsJobRunningOnHost().  The jobCount jobs
+    identified by the jobIds and taskIds arrays are first checked against the
+    Grid Engine cell's active_jobs directory; any not found there are looked up
+    with a single qstat invocation (which is retried up to retryCount times if
+    it fails).  If any of those job ids is unknown to qstat the batched reply
+    says nothing about the others, so each job it does not name as unknown is
+    then looked up on its own.  On return, isRunning[i] indicates whether or
+    not job i is running on this host.
+  @result
+    Returns the number of jobs found to be running on this host.
+*/
+unsigned int GECOResourceSetAreJobsRunningOnHost(unsigned int jobCount, const long int *jobIds, const long int *taskIds, bool *isRunning, int retryCount);
+
 //
 
 GECOResourceSetRef GECOResourceSetCreate(long int jobId, long int taskId, int retryCount, GECOResourceSetCreateFailure *failureReason);
@@ -16,14 +16,21 @@
 
 #include <sys/eventfd.h>
 #include <sys/epoll.h>
+#include <sys/timerfd.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 
 //
 
+enum {
+  GECOPollingSourceRecFlagNeedsRegistration   = 1 << 14,
+  GECOPollingSourceRecFlagIsInvalidated       = 1 << 15
+};
+
 typedef struct _GECOPollingSourceRec {
   GECOPollingSource                 theSource;
   GECOFlags                         flags;
+  int                               fd;
   GECOPollingSourceCallbacks        callbacks;
   struct _GECOPollingSourceRec      *link;
 } GECOPollingSourceRec;
@@ -41,7 +48,10 @@ __GECOPollingSourceRecAlloc(void)
   } else {
     newRec = malloc(sizeof(*newRec));
   }
-  if ( newRec ) memset(newRec, 0, sizeof(*newRec));
+  if ( newRec ) {
+    memset(newRec, 0, sizeof(*newRec));
+    newRec->fd = -1;
+  }
   return newRec;
 }
 
@@ -134,16 +144,86 @@ __GECORunloopObserverRecDealloc(
 #endif
 //
 
+enum {
+  GECORunloopTimerFlagShouldRepeat    = 1 << 0,
+  GECORunloopTimerFlagIsFiring        = 1 << 1,
+  GECORunloopTimerFlagIsInvalidated   = 1 << 15
+};
+
+typedef struct _GECORunloopTimer {
+  GECOFlags                         flags;
+  uint64_t                          fireTime;
+  uint64_t                          interval;
+  int                               heapIndex;
+  GECORunloopTimerCallback          callback;
+  const void                        *context;
+  struct _GECORunloopTimer          *link;
+} GECORunloopTimer;
+
+static GECORunloopTimer             *GECORunloopTimerPool = NULL;
+
+GECORunloopTimer*
+__GECORunloopTimerAlloc(void)
+{
+  GECORunloopTimer                  *newTimer = NULL;
+  
+  if ( GECORunloopTimerPool ) {
+    newTimer = GECORunloopTimerPool;
+    GECORunloopTimerPool = newTimer->link;
+  } else {
+    newTimer = malloc(sizeof(*newTimer));
+  }
+  if ( newTimer ) {
+    memset(newTimer, 0, sizeof(*newTimer));
+    newTimer->heapIndex = -1;
+  }
+  return newTimer;
+}
+
+//
+
+void
+__GECORunloopTimerDealloc(
+  GECORunloopTimer      *theTimer
+)
+{
+  theTimer->link = GECORunloopTimerPool;
+  GECORunloopTimerPool = theTimer;
+}
+
+//
+
+uint64_t
+__GECORunloopTimerNow(void)
+{
+  struct timespec       now;
+  
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+//
+#if 0
+#pragma mark -
+#endif
+//
+
 #ifndef GECORUNLOOP_MAX_EPOLL_TIMEOUT
 #define GECORUNLOOP_MAX_EPOLL_TIMEOUT      ((INT_MAX / 1000))
 #endif
 
+#ifndef GECORUNLOOP_MAX_EPOLL_EVENTS
+#define GECORUNLOOP_MAX_EPOLL_EVENTS       64
+#endif
+
+#define GECORUNLOOP_EPOLL_EVENTS           (EPOLLIN | EPOLLHUP | EPOLLRDHUP)
+
 //
 
 enum {
   GECORunloopFlagExitRunloop          = 1 << 0,
   GECORunloopFlagHasDynamicSources    = 1 << 1,
-  GECORunloopFlagResetStaticDispatch  = 1 << 2
+  GECORunloopFlagIsDispatching        = 1 << 2
 };
 
 typedef struct _GECORunloop {
@@ -152,7 +232,14 @@ typedef struct _GECORunloop {
   int                               epoll_fd;
   unsigned int                      period_in_ms;
   unsigned int                      sourceCount;
+  unsigned int                      registeredCount;
+  unsigned int                      pollingNotifyCount;
   GECOPollingSourceRec              *sources;
+  GECOPollingSourceRec              *retiredSources;
+  int                               timer_fd;
+  GECOPollingSourceRec              timerSource;
+  unsigned int                      timerCount, timerCapacity;
+  GECORunloopTimer                  **timers;
   GECORunloopObserverRec            *observers[GECORunloopObserverActivityCount];
 } GECORunloop;
 
@@ -167,6 +254,8 @@ __GECORunloopAlloc(void)
   if ( newRunloop ) {
     memset(newRunloop, 0, sizeof(*newRunloop));
     newRunloop->epoll_fd = -1;
+    newRunloop->timer_fd = -1;
+    newRunloop->timerSource.fd = -1;
     newRunloop->state = GECORunloopStateIdle;
     newRunloop->period_in_ms = 60000;
   }
@@ -219,6 +308,13 @@ GECORunloopDestroy(
   }
   GECO_DEBUG("removed all observers from runloop %p", theRunloop);
   
+  if ( theRunloop->timers ) {
+    while ( theRunloop->timerCount-- ) __GECORunloopTimerDealloc(theRunloop->timers[theRunloop->timerCount]);
+    free((void*)theRunloop->timers);
+    GECO_DEBUG("removed all timers from runloop %p", theRunloop);
+  }
+  if ( theRunloop->timer_fd >= 0 ) close(theRunloop->timer_fd);
+  
   if ( theRunloop->epoll_fd >= 0 ) close(theRunloop->epoll_fd);
   GECO_DEBUG("closed polling fd %d for runloop %p", theRunloop->epoll_fd, theRunloop);
   
@@ -279,6 +375,126 @@ GECORunloopSetShouldExitRunloop(
   }
 }
 
+//
+#if 0
+#pragma mark -
+#endif
+//
+
+void
+__GECORunloopUnregisterSource(
+  GECORunloopRef          theRunloop,
+  GECOPollingSourceRec    *source
+)
+{
+  if ( source->fd >= 0 ) {
+    struct epoll_event    ev = {
+                              .events = GECORUNLOOP_EPOLL_EVENTS,
+                              .data.ptr = source
+                            };
+    
+    //
+    // The descriptor may have already been closed (and thus dropped from the
+    // epoll set by the kernel) so failure here is not an error:
+    //
+    epoll_ctl(theRunloop->epoll_fd, EPOLL_CTL_DEL, source->fd, &ev);
+    GECO_DEBUG("unregistered fd %d with epoll fd %d", source->fd, theRunloop->epoll_fd);
+    source->fd = -1;
+    theRunloop->registeredCount--;
+  }
+}
+
+//
+
+bool
+__GECORunloopRegisterSource(
+  GECORunloopRef          theRunloop,
+  GECOPollingSourceRec    *source
+)
+{
+  int                     fdOfInterest = source->callbacks.fileDescriptorForPolling(source->theSource);
+  
+  if ( (fdOfInterest == source->fd) && ! GECOFLAGS_ISSET(source->flags, GECOPollingSourceRecFlagNeedsRegistration) ) return true;
+  
+  if ( fdOfInterest != source->fd ) __GECORunloopUnregisterSource(theRunloop, source);
+  GECOFLAGS_UNSET(source->flags, GECOPollingSourceRecFlagNeedsRegistration);
+  if ( fdOfInterest >= 0 ) {
+    struct epoll_event    ev = {
+                              .events = GECORUNLOOP_EPOLL_EVENTS,
+                              .data.ptr = source
+                            };
+    
+    if ( epoll_ctl(theRunloop->epoll_fd, EPOLL_CTL_ADD, fdOfInterest, &ev) == 0 ) {
+      GECO_DEBUG("registered fd %d with epoll fd %d", fdOfInterest, theRunloop->epoll_fd);
+    } else if ( (errno == EEXIST) && (source->fd == fdOfInterest) ) {
+      //
+      // Same descriptor as before and still in the epoll set:
+      //
+      return true;
+    } else {
+      GECO_WARN("__GECORunloopRegisterSource: failed to register fd %d with epoll fd %d (errno = %d)", fdOfInterest, theRunloop->epoll_fd, errno);
+      if ( source->fd >= 0 ) {
+        source->fd = -1;
+        theRunloop->registeredCount--;
+      }
+      return false;
+    }
+    if ( source->fd < 0 ) theRunloop->registeredCount++;
+    source->fd = fdOfInterest;
+  }
+  return true;
+}
+
+//
+
+void
+__GECORunloopRetireSource(
+  GECORunloopRef          theRunloop,
+  GECOPollingSourceRec    *source
+)
+{
+  __GECORunloopUnregisterSource(theRunloop, source);
+  if ( source->callbacks.didBeginPolling || source->callbacks.didEndPolling ) theRunloop->pollingNotifyCount--;
+  GECO_DEBUG("  notifying source %p -- didRemoveAsSource", source->theSource);
+  GECORUNLOOP_NOTIFY_POLLINGSOURCE(theRunloop, source, didRemoveAsSource);
+  if ( source->callbacks.destroySource ) {
+    GECO_DEBUG("  source %p.destroySource()", source->theSource);
+    source->callbacks.destroySource(source->theSource);
+  }
+  //
+  // Events already returned by epoll_wait() may still reference this record, so
+  // while dispatching it cannot go back into the pool:
+  //
+  if ( GECOFLAGS_ISSET(theRunloop->flags, GECORunloopFlagIsDispatching) ) {
+    GECOFLAGS_SET(source->flags, GECOPollingSourceRecFlagIsInvalidated);
+    source->link = theRunloop->retiredSources;
+    theRunloop->retiredSources = source;
+  } else {
+    __GECOPollingSourceRecDealloc(source);
+  }
+}
+
+//
+
+void
+__GECORunloopDeallocRetiredSources(
+  GECORunloopRef          theRunloop
+)
+{
+  GECOPollingSourceRec    *source = theRunloop->retiredSources, *next;
+  
+  while ( source ) {
+    next = source->link;
+    __GECOPollingSourceRecDealloc(source);
+    source = next;
+  }
+  theRunloop->retiredSources = NULL;
+}
+
+//
+#if 0
+#pragma mark -
+#endif
 //
 
 unsigned int
@@ -335,14 +551,7 @@ GECORunloopRemovePollingSourceAtIndex(
     } else {
       theRunloop->sources = node->link;
     }
-    GECO_DEBUG("  notifying source %p -- didRemoveAsSource", node->theSource);
-    GECORUNLOOP_NOTIFY_POLLINGSOURCE(theRunloop, node, didRemoveAsSource);
-    if ( node->callbacks.destroySource ) {
-      GECO_DEBUG("  source %p.destroySource()", node->theSource);
-      node->callbacks.destroySource(node->theSource);
-    }
-    __GECOPollingSourceRecDealloc(node);
-    GECOFLAGS_SET(theRunloop->flags, GECORunloopFlagResetStaticDispatch);
+    __GECORunloopRetireSource(theRunloop, node);
     exitVal = true;
     theRunloop->sourceCount--;
     node = next;
@@ -385,7 +594,12 @@ GECORunloopAddPollingSource(
     newRec->theSource   = theSource;
     newRec->callbacks   = *callbacks;
     newRec->flags       = flags;
-        
+    
+    if ( ! __GECORunloopRegisterSource(theRunloop, newRec) ) {
+      __GECOPollingSourceRecDealloc(newRec);
+      return false;
+    }
+    
     while ( node && ((node->flags & GECOPollingSourceFlagPriority) > myPriority) ) {
       prev = node;
       node = node->link;
@@ -399,12 +613,12 @@ GECORunloopAddPollingSource(
     }
     
     theRunloop->sourceCount++;
+    if ( callbacks->didBeginPolling || callbacks->didEndPolling ) theRunloop->pollingNotifyCount++;
     
     if ( ! GECOFLAGS_ISSET(flags, GECOPollingSourceFlagStaticFileDescriptor) && ! GECOFLAGS_ISSET(theRunloop->flags, GECORunloopFlagHasDynamicSources) ) {
       GECO_DEBUG("runloop %p has changed to dynamic", theRunloop);
       GECOFLAGS_SET(theRunloop->flags, GECORunloopFlagHasDynamicSources);
     }
-    GECOFLAGS_SET(theRunloop->flags, GECORunloopFlagResetStaticDispatch);
     if ( callbacks->didAddAsSource ) callbacks->didAddAsSource(theSource, theRunloop);
     return true;
   }
@@ -419,31 +633,28 @@ GECORunloopRemovePollingSource(
   GECOPollingSource theSource
 )
 {
-  GECOPollingSourceRec        *prev = NULL, *node = theRunloop->sources;
+  GECOPollingSourceRec        *prev = NULL, *node = theRunloop->sources, *next;
   bool                        allStatic = true, exitVal = false;
   
   while ( node ) {
+    next = node->link;
     if ( node->theSource == theSource ) {
       GECO_DEBUG("runloop %p removing source %p", theRunloop, node->theSource);
       if ( prev ) {
-        prev->link = node->link;
+        prev->link = next;
       } else {
-        theRunloop->sources = node->link;
+        theRunloop->sources = next;
       }
-      GECO_DEBUG("  notifying source %p -- didRemoveAsSource", node->theSource);
-      GECORUNLOOP_NOTIFY_POLLINGSOURCE(theRunloop, node, didRemoveAsSource);
-      if ( node->callbacks.destroySource ) {
-        GECO_DEBUG("  source %p.destroySource()", node->theSource);
-        node->callbacks.destroySource(node->theSource);
-      }
-      __GECOPollingSourceRecDealloc(node);
-      GECOFLAGS_SET(theRunloop->flags, GECORunloopFlagResetStaticDispatch);
+      __GECORunloopRetireSource(theRunloop, node);
       theRunloop->sourceCount--;
       exitVal = true;
+      node = next;
+      continue;
     } else if ( ! GECOFLAGS_ISSET(node->flags, GECOPollingSourceFlagStaticFileDescriptor) ) {
       allStatic = false;
     }
-    node = node->link;
+    prev = node;
+    node = next;
   }
   if ( exitVal && (GECOFLAGS_ISSET(theRunloop->flags, GECORunloopFlagHasDynamicSources) != (!allStatic)) ) {
     GECO_DEBUG("runloop %p has changed to %s", theRunloop, ( allStatic ? "static" : "dynamic" ));
@@ -465,14 +676,12 @@ GECORunloopRemoveAllPollingSources(
 {
   GECOPollingSourceRec        *next = NULL, *node = theRunloop->sources;
   
+  theRunloop->sources = NULL;
   while ( node ) {
     next = node->link;
-    GECORUNLOOP_NOTIFY_POLLINGSOURCE(theRunloop, node, didRemoveAsSource);
-    if ( node->callbacks.destroySource ) node->callbacks.destroySource(node->theSource);
-    __GECOPollingSourceRecDealloc(node);
+    __GECORunloopRetireSource(theRunloop, node);
     node = next;
   }
-  GECOFLAGS_SET(theRunloop->flags, GECORunloopFlagResetStaticDispatch);
   GECOFLAGS_UNSET(theRunloop->flags, GECORunloopFlagHasDynamicSources);
   GECO_DEBUG("all sources removed from runloop %p", theRunloop);
   theRunloop->sourceCount = 0;
@@ -616,6 +825,279 @@ GECORunloopRemoveAllObservers(
 
 //
 
+#if 0
+#pragma mark -
+#endif
+//
+
+void
+__GECORunloopTimerHeapSwap(
+  GECORunloopRef  theRunloop,
+  int             i,
+  int             j
+)
+{
+  GECORunloopTimer    *t = theRunloop->timers[i];
+  
+  theRunloop->timers[i] = theRunloop->timers[j];
+  theRunloop->timers[i]->heapIndex = i;
+  theRunloop->timers[j] = t;
+  t->heapIndex = j;
+}
+
+//
+
+void
+__GECORunloopTimerHeapSiftUp(
+  GECORunloopRef  theRunloop,
+  int             i
+)
+{
+  while ( i > 0 ) {
+    int           parent = (i - 1) / 2;
+    
+    if ( theRunloop->timers[parent]->fireTime <= theRunloop->timers[i]->fireTime ) break;
+    __GECORunloopTimerHeapSwap(theRunloop, i, parent);
+    i = parent;
+  }
+}
+
+//
+
+void
+__GECORunloopTimerHeapSiftDown(
+  GECORunloopRef  theRunloop,
+  int             i
+)
+{
+  int             n = theRunloop->timerCount;
+  
+  while ( 1 ) {
+    int           least = i, l = 2 * i + 1, r = l + 1;
+    
+    if ( (l < n) && (theRunloop->timers[l]->fireTime < theRunloop->timers[least]->fireTime) ) least = l;
+    if ( (r < n) && (theRunloop->timers[r]->fireTime < theRunloop->timers[least]->fireTime) ) least = r;
+    if ( least == i ) break;
+    __GECORunloopTimerHeapSwap(theRunloop, i, least);
+    i = least;
+  }
+}
+
+//
+
+bool
+__GECORunloopTimerHeapInsert(
+  GECORunloopRef    theRunloop,
+  GECORunloopTimer  *theTimer
+)
+{
+  if ( theRunloop->timerCount == theRunloop->timerCapacity ) {
+    unsigned int      newCapacity = ( theRunloop->timerCapacity ? 2 * theRunloop->timerCapacity : 8 );
+    GECORunloopTimer  **newTimers = realloc(theRunloop->timers, newCapacity * sizeof(GECORunloopTimer*));
+    
+    if ( ! newTimers ) return false;
+    theRunloop->timers = newTimers;
+    theRunloop->timerCapacity = newCapacity;
+  }
+  theTimer->heapIndex = theRunloop->timerCount++;
+  theRunloop->timers[theTimer->heapIndex] = theTimer;
+  __GECORunloopTimerHeapSiftUp(theRunloop, theTimer->heapIndex);
+  return true;
+}
+
+//
+
+void
+__GECORunloopTimerHeapRemove(
+  GECORunloopRef    theRunloop,
+  GECORunloopTimer  *theTimer
+)
+{
+  int               i = theTimer->heapIndex;
+  
+  if ( i < 0 ) return;
+  theRunloop->timerCount--;
+  if ( i < theRunloop->timerCount ) {
+    __GECORunloopTimerHeapSwap(theRunloop, i, theRunloop->timerCount);
+    __GECORunloopTimerHeapSiftDown(theRunloop, i);
+    __GECORunloopTimerHeapSiftUp(theRunloop, i);
+  }
+  theTimer->heapIndex = -1;
+}
+
+//
+
+void
+__GECORunloopTimerArm(
+  GECORunloopRef    theRunloop
+)
+{
+  struct itimerspec when;
+  
+  if ( theRunloop->timer_fd < 0 ) return;
+  
+  memset(&when, 0, sizeof(when));
+  if ( theRunloop->timerCount ) {
+    uint64_t        fireTime = theRunloop->timers[0]->fireTime;
+    
+    //
+    // An all-zero it_value would disarm the timer:
+    //
+    if ( fireTime == 0 ) fireTime = 1;
+    when.it_value.tv_sec = fireTime / 1000000000ULL;
+    when.it_value.tv_nsec = fireTime % 1000000000ULL;
+  }
+  if ( timerfd_settime(theRunloop->timer_fd, TFD_TIMER_ABSTIME, &when, NULL) != 0 ) {
+    GECO_WARN("__GECORunloopTimerArm: failed to set timer fd %d (errno = %d)", theRunloop->timer_fd, errno);
+  }
+}
+
+//
+
+int
+__GECORunloopTimerFileDescriptor(
+  GECOPollingSource theSource
+)
+{
+  return ((GECORunloopRef)theSource)->timer_fd;
+}
+
+//
+
+void
+__GECORunloopTimerDidReceiveDataAvailable(
+  GECOPollingSource theSource,
+  GECORunloopRef    theRunloop
+)
+{
+  uint64_t          expirations, now;
+  
+  if ( read(theRunloop->timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations) ) {
+    if ( errno == EAGAIN ) return;
+  }
+  
+  //
+  // Fire everything that's due.  A repeating timer is rescheduled before its
+  // callback is invoked, so it's free to invalidate itself; timers added by a
+  // callback are always due in the future, so this loop must terminate:
+  //
+  now = __GECORunloopTimerNow();
+  while ( theRunloop->timerCount && (theRunloop->timers[0]->fireTime <= now) ) {
+    GECORunloopTimer  *theTimer = theRunloop->timers[0];
+    
+    __GECORunloopTimerHeapRemove(theRunloop, theTimer);
+    if ( GECOFLAGS_ISSET(theTimer->flags, GECORunloopTimerFlagShouldRepeat) ) {
+      theTimer->fireTime += theTimer->interval;
+      if ( theTimer->fireTime <= now ) theTimer->fireTime = now + theTimer->interval;
+      __GECORunloopTimerHeapInsert(theRunloop, theTimer);
+      GECO_DEBUG("runloop %p firing repeating timer %p", theRunloop, theTimer);
+      theTimer->callback(theTimer, theRunloop, theTimer->context);
+    } else {
+      GECOFLAGS_SET(theTimer->flags, GECORunloopTimerFlagIsFiring);
+      GECO_DEBUG("runloop %p firing timer %p", theRunloop, theTimer);
+      theTimer->callback(theTimer, theRunloop, theTimer->context);
+      __GECORunloopTimerDealloc(theTimer);
+    }
+  }
+  __GECORunloopTimerArm(theRunloop);
+}
+
+//
+
+GECORunloopTimerRef
+GECORunloopAddTimer(
+  GECORunloopRef            theRunloop,
+  double                    interval,
+  bool                      shouldRepeat,
+  GECORunloopTimerCallback  callback,
+  const void                *context
+)
+{
+  GECORunloopTimer          *newTimer;
+  
+  if ( ! callback || (interval < 0.0) || (shouldRepeat && (interval <= 0.0)) ) return NULL;
+  
+  //
+  // The timer descriptor is created on first use and sits in the epoll set
+  // like any other source, though it isn't part of the sources list:
+  //
+  if ( theRunloop->timer_fd < 0 ) {
+    theRunloop->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if ( theRunloop->timer_fd < 0 ) {
+      GECO_WARN("GECORunloopAddTimer: failed in timerfd_create() (errno = %d)", errno);
+      return NULL;
+    }
+    theRunloop->timerSource.theSource = theRunloop;
+    theRunloop->timerSource.flags = GECOPollingSourceFlagStaticFileDescriptor | GECOPollingSourceFlagHighPriority;
+    theRunloop->timerSource.callbacks.fileDescriptorForPolling = __GECORunloopTimerFileDescriptor;
+    theRunloop->timerSource.callbacks.didReceiveDataAvailable = __GECORunloopTimerDidReceiveDataAvailable;
+    if ( ! __GECORunloopRegisterSource(theRunloop, &theRunloop->timerSource) ) {
+      close(theRunloop->timer_fd);
+      theRunloop->timer_fd = -1;
+      return NULL;
+    }
+    GECO_DEBUG("runloop %p using timer fd %d", theRunloop, theRunloop->timer_fd);
+  }
+  
+  newTimer = __GECORunloopTimerAlloc();
+  if ( newTimer ) {
+    newTimer->interval = (uint64_t)(interval * 1e9);
+    newTimer->fireTime = __GECORunloopTimerNow() + newTimer->interval;
+    newTimer->callback = callback;
+    newTimer->context = context;
+    if ( shouldRepeat ) GECOFLAGS_SET(newTimer->flags, GECORunloopTimerFlagShouldRepeat);
+    if ( ! __GECORunloopTimerHeapInsert(theRunloop, newTimer) ) {
+      __GECORunloopTimerDealloc(newTimer);
+      return NULL;
+    }
+    if ( newTimer->heapIndex == 0 ) __GECORunloopTimerArm(theRunloop);
+    GECO_DEBUG("runloop %p added %s timer %p with interval %lg", theRunloop, ( shouldRepeat ? "repeating" : "one-shot" ), newTimer, interval);
+  }
+  return newTimer;
+}
+
+//
+
+void
+GECORunloopInvalidateTimer(
+  GECORunloopRef            theRunloop,
+  GECORunloopTimerRef       theTimer
+)
+{
+  if ( GECOFLAGS_ISSET(theTimer->flags, GECORunloopTimerFlagIsFiring) ) {
+    //
+    // A one-shot timer invalidating itself from its callback; it will be
+    // deallocated once the callback returns:
+    //
+    GECOFLAGS_SET(theTimer->flags, GECORunloopTimerFlagIsInvalidated);
+    return;
+  }
+  if ( theTimer->heapIndex >= 0 ) {
+    bool                    wasNext = (theTimer->heapIndex == 0);
+    
+    __GECORunloopTimerHeapRemove(theRunloop, theTimer);
+    __GECORunloopTimerDealloc(theTimer);
+    if ( wasNext ) __GECORunloopTimerArm(theRunloop);
+    GECO_DEBUG("runloop %p invalidated timer %p", theRunloop, theTimer);
+  }
+}
+
+//
+
+unsigned int
+GECORunloopGetTimerCount(
+  GECORunloopRef            theRunloop
+)
+{
+  return theRunloop->timerCount;
+}
+
+//
+#if 0
+#pragma mark -
+#endif
+//
+
 int
 GECORunloopRun(
   GECORunloopRef  theRunloop
@@ -626,10 +1108,82 @@ GECORunloopRun(
 
 //
 
-typedef struct _GECORunloopDispatch {
-  int                     fd;
-  GECOPollingSourceRec    *sourceRec;
-} GECORunloopDispatch;
+void
+__GECORunloopDispatchEvents(
+  GECORunloopRef      theRunloop,
+  struct epoll_event  *events,
+  int                 eventCount
+)
+{
+  int                 eventIdx;
+  unsigned int        priority;
+
+#ifndef GECO_DEBUG_DISABLE
+  //
+  // Debugging -- show all event fds:
+  //
+  eventIdx = 0;
+  while ( eventIdx < eventCount ) {
+    GECO_DEBUG("  event %08X on fd %d", events[eventIdx].events, ((GECOPollingSourceRec*)events[eventIdx].data.ptr)->fd);
+    eventIdx++;
+  }
+#endif
+  
+  //
+  // Each event carries its source record, so there's no lookup to be done; dispatch
+  // them in order of descending source priority:
+  //
+  GECOFLAGS_SET(theRunloop->flags, GECORunloopFlagIsDispatching);
+  GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityBeforeSources);
+  priority = GECOPollingSourceFlagPriority;
+  while ( 1 ) {
+    eventIdx = 0;
+    while ( eventIdx < eventCount ) {
+      GECOPollingSourceRec  *source = (GECOPollingSourceRec*)events[eventIdx].data.ptr;
+      
+      if ( ((source->flags & GECOPollingSourceFlagPriority) == priority) && ! GECOFLAGS_ISSET(source->flags, GECOPollingSourceRecFlagIsInvalidated) ) {
+        int                 fdToMatch = source->fd;
+        
+        if ( events[eventIdx].events & EPOLLIN ) {
+          //
+          // Data present for read on file descriptor:
+          //
+          GECO_DEBUG("notifying source for fd %d -- didReceiveDataAvailable", fdToMatch);
+          GECORUNLOOP_NOTIFY_POLLINGSOURCE(theRunloop, source, didReceiveDataAvailable);
+        }
+        if ( ! GECOFLAGS_ISSET(source->flags, GECOPollingSourceRecFlagIsInvalidated) && ((events[eventIdx].events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR)) || (source->callbacks.shouldSourceClose && source->callbacks.shouldSourceClose(source->theSource, theRunloop))) ) {
+          //
+          // Cleanup after a closed descriptor.  Drop it from the epoll set while
+          // it is still open:  the source may close it, after which the number
+          // can be reused by some other source (or the open file survive in a
+          // forked child and keep delivering events to this record):
+          //
+          __GECORunloopUnregisterSource(theRunloop, source);
+          GECO_DEBUG("notifying source for closed fd %d", fdToMatch);
+          GECORUNLOOP_NOTIFY_POLLINGSOURCE(theRunloop, source, didReceiveClose);
+          if ( GECOFLAGS_ISSET(source->flags, GECOPollingSourceFlagRemoveOnClose) ) {
+            GECO_DEBUG("removing source for closed fd %d", fdToMatch);
+            GECORunloopRemovePollingSource(theRunloop, source->theSource);
+          } else if ( ! GECOFLAGS_ISSET(source->flags, GECOPollingSourceRecFlagIsInvalidated) && ! GECOFLAGS_ISSET(source->flags, GECOPollingSourceFlagStaticFileDescriptor) ) {
+            //
+            // The source may have kept or reopened its descriptor, so register
+            // whatever it reports on the next pass:
+            //
+            GECOFLAGS_SET(source->flags, GECOPollingSourceRecFlagNeedsRegistration);
+          }
+        }
+      }
+      eventIdx++;
+    }
+    if ( priority == 0 ) break;
+    priority -= GECOPollingSourceFlagMediumPriority;
+  }
+  GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityAfterSources);
+  GECOFLAGS_UNSET(theRunloop->flags, GECORunloopFlagIsDispatching);
+  __GECORunloopDeallocRetiredSources(theRunloop);
+}
+
+//
 
 int
 __GECORunloopRunUntil_Dynamic(
@@ -691,64 +1245,36 @@ __GECORunloopRunUntil_Dynamic(
     //
     // If there are no data sources then just go to sleep...
     //
-    if ( theRunloop->sourceCount == 0 ) {
+    if ( (theRunloop->sourceCount == 0) && (theRunloop->timerCount == 0) ) {
       GECO_INFO("no sources in runloop, going to sleep");
       GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityBeforeWait);
       GECOSleepForMicroseconds(timeout);
       GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityAfterWait);
       continue;
     } else {
-      unsigned int            dispatchCount = 0;
-      GECORunloopDispatch     dispatchTable[theRunloop->sourceCount];
       GECOPollingSourceRec    *source;
       
       //
-      // Ensure we have an epoll descriptor open:
-      //
-      if ( theRunloop->epoll_fd < 0 ) {
-        theRunloop->epoll_fd = epoll_create(8);
-        if ( theRunloop->epoll_fd < 0 ) {
-          GECO_WARN("__GECORunloopRunUntil_Dynamic: failure in epoll_create (errno = %d)", errno);
-          return errno;
-        }
-      }
-  
-      //
-      // Fill-in the dispatch table, registering the descriptors with epoll
-      // as we go:
+      // Sources were registered with epoll when they were added to the runloop;
+      // only the dynamic ones need to be checked for a change of descriptor:
       //
       source = theRunloop->sources;
       while ( source ) {
-        int                   fdOfInterest = source->callbacks.fileDescriptorForPolling(source->theSource);
-        
-        if ( fdOfInterest >= 0 ) {
-          struct epoll_event  ev = {
-                                  .events = EPOLLIN | EPOLLHUP | EPOLLRDHUP,
-                                  .data.fd = fdOfInterest
-                                };
-          if ( epoll_ctl(theRunloop->epoll_fd, EPOLL_CTL_ADD, fdOfInterest, &ev) == 0 ) {
-            dispatchTable[dispatchCount].fd = fdOfInterest;
-            dispatchTable[dispatchCount].sourceRec = source;
-            dispatchCount++;
-            GECO_DEBUG("registered fd %d with epoll fd %d", fdOfInterest, theRunloop->epoll_fd);
-          } else {
-            GECO_WARN("__GECORunloopRunUntil_Dynamic: failed to register fd %d with epoll fd %d (errno = %d)", fdOfInterest, theRunloop->epoll_fd, errno);
-          }
-        }
+        if ( ! GECOFLAGS_ISSET(source->flags, GECOPollingSourceFlagStaticFileDescriptor) ) __GECORunloopRegisterSource(theRunloop, source);
         source = source->link;
       }
-      GECO_DEBUG("dispatch table constructed with %u descriptors", dispatchCount);
+      GECO_DEBUG("%u of %u sources registered with epoll", theRunloop->registeredCount, theRunloop->sourceCount);
   
       //
-      // If we didn't actually register any sources, just sleep...
+      // If we don't actually have any registered sources, just sleep...
       //
-      if ( dispatchCount == 0 ) {
+      if ( theRunloop->registeredCount == 0 ) {
         GECO_INFO("no sources registered with epoll, going to sleep");
         GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityBeforeWait);
         GECOSleepForMicroseconds(timeout);
         GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityAfterWait);
       } else {
-        struct epoll_event      responseBuffer[dispatchCount];
+        struct epoll_event      responseBuffer[GECORUNLOOP_MAX_EPOLL_EVENTS];
         
         //
         // Enter polling state:
@@ -758,16 +1284,18 @@ __GECORunloopRunUntil_Dynamic(
         //
         // Let any interested sources know:
         //
-        GECO_DEBUG("notifying all sources -- didBeginPolling");
-        GECORUNLOOP_NOTIFY_POLLINGSOURCES(theRunloop, didBeginPolling);
+        if ( theRunloop->pollingNotifyCount ) {
+          GECO_DEBUG("notifying all sources -- didBeginPolling");
+          GECORUNLOOP_NOTIFY_POLLINGSOURCES(theRunloop, didBeginPolling);
+        }
         
         //
         // Go to sleep and await an event or two:
         //
-        GECO_DEBUG("entering epoll_wait(%d, %p, %u, %d)...", theRunloop->epoll_fd, responseBuffer, dispatchCount, timeout);
+        GECO_DEBUG("entering epoll_wait(%d, %p, %d, %d)...", theRunloop->epoll_fd, responseBuffer, GECORUNLOOP_MAX_EPOLL_EVENTS, timeout);
         GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityBeforeWait);
-        int eventCount = epoll_wait(theRunloop->epoll_fd, responseBuffer, dispatchCount, timeout);
-        GECO_DEBUG("...exited epoll_wait(%d, %p, %u, %d) = %d", theRunloop->epoll_fd, responseBuffer, dispatchCount, timeout, eventCount);
+        int eventCount = epoll_wait(theRunloop->epoll_fd, responseBuffer, GECORUNLOOP_MAX_EPOLL_EVENTS, timeout);
+        GECO_DEBUG("...exited epoll_wait(%d, %p, %d, %d) = %d", theRunloop->epoll_fd, responseBuffer, GECORUNLOOP_MAX_EPOLL_EVENTS, timeout, eventCount);
         GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityAfterWait);
         
         //
@@ -778,8 +1306,10 @@ __GECORunloopRunUntil_Dynamic(
         //
         // Let any interested sources know we've exited epoll:
         //
-        GECO_DEBUG("notifying all sources -- didEndPolling");
-        GECORUNLOOP_NOTIFY_POLLINGSOURCES(theRunloop, didEndPolling);
+        if ( theRunloop->pollingNotifyCount ) {
+          GECO_DEBUG("notifying all sources -- didEndPolling");
+          GECORUNLOOP_NOTIFY_POLLINGSOURCES(theRunloop, didEndPolling);
+        }
         
         if ( eventCount < 0 ) {
           //
@@ -794,68 +1324,7 @@ __GECORunloopRunUntil_Dynamic(
             GECO_DEBUG("polling loopus interruptus (errno = %d)", errno);
           }
         } else if ( (eventCount > 0) && ! GECOFLAGS_ISSET(theRunloop->flags, GECORunloopFlagExitRunloop) ) {
-          int           dispatchIdx, eventIdx;
-
-#ifndef GECO_DEBUG_DISABLE
-          //
-          // Debugging -- show all event fds:
-          //
-          eventIdx = 0;
-          while ( eventIdx < eventCount ) {
-            GECO_DEBUG("  event %08X on fd %d", responseBuffer[eventIdx].events, responseBuffer[eventIdx].data.fd);
-            eventIdx++;
-          }
-#endif
-          
-          //
-          // Walk the dispatch table:
-          //
-          dispatchIdx = 0;
-          GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityBeforeSources);
-          while ( dispatchIdx < dispatchCount ) {
-            int                     fdToMatch = dispatchTable[dispatchIdx].fd;
-            GECOPollingSourceRec    *source = dispatchTable[dispatchIdx].sourceRec;
-            
-            eventIdx = 0;
-            while ( eventIdx < eventCount ) {
-              if ( fdToMatch == responseBuffer[eventIdx].data.fd ) {
-                if ( responseBuffer[eventIdx].events & EPOLLIN ) {
-                  //
-                  // Data present for read on file descriptor:
-                  //
-                  GECO_DEBUG("notifying source for fd %d -- didReceiveDataAvailable", fdToMatch);
-                  GECORUNLOOP_NOTIFY_POLLINGSOURCE(theRunloop, source, didReceiveDataAvailable);
-                }
-                if ( (responseBuffer[eventIdx].events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR)) || (source->callbacks.shouldSourceClose && source->callbacks.shouldSourceClose(source->theSource, theRunloop)) ) {
-                  //
-                  // Cleanup after a closed descriptor:
-                  //
-                  GECO_DEBUG("notifying source for closed fd %d", fdToMatch);
-                  GECORUNLOOP_NOTIFY_POLLINGSOURCE(theRunloop, source, didReceiveClose);
-                  if ( GECOFLAGS_ISSET(source->flags, GECOPollingSourceFlagRemoveOnClose) ) {
-                    GECO_DEBUG("removing source for closed fd %d", fdToMatch);
-                    GECORunloopRemovePollingSource(theRunloop, source->theSource);
-                  }
-                }
-                break;
-              }
-              eventIdx++;
-            }
-            dispatchIdx++;
-          }
-          GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityAfterSources);
-        }
-        
-        //
-        // Unregister all the polling fds:
-        //
-        GECO_DEBUG("clearing %d sources from the dispatch table", dispatchCount);
-        while ( dispatchCount-- ) {
-          struct epoll_event  ev = {
-                                  .events = EPOLLIN | EPOLLHUP | EPOLLRDHUP,
-                                  .data.fd = dispatchTable[dispatchCount].fd
-                                };
-          epoll_ctl(theRunloop->epoll_fd, EPOLL_CTL_DEL, dispatchTable[dispatchCount].fd, &ev);
+          __GECORunloopDispatchEvents(theRunloop, responseBuffer, eventCount);
         }
       }
     }
@@ -874,8 +1343,6 @@ __GECORunloopRunUntil_Static(
 {
   int                   rc = 0;
   bool                  running = true;
-  unsigned int          dispatchCount = 0, dispatchCapacity = 0;
-  GECORunloopDispatch   *dispatchTable = NULL;
   
   GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityEntry);
   
@@ -928,202 +1395,74 @@ __GECORunloopRunUntil_Static(
     //
     // If there are no data sources then just go to sleep...
     //
-    if ( theRunloop->sourceCount == 0 ) {
+    if ( (theRunloop->sourceCount == 0) && (theRunloop->timerCount == 0) ) {
       GECO_INFO("no sources in runloop, going to sleep");
       GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityBeforeWait);
       GECOSleepForMicroseconds(timeout);
       GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityAfterWait);
       continue;
+    } else if ( theRunloop->registeredCount == 0 ) {
+      //
+      // If we don't actually have any registered sources, just sleep...
+      //
+      GECO_INFO("no sources registered with epoll, going to sleep");
+      GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityBeforeWait);
+      GECOSleepForMicroseconds(timeout);
+      GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityAfterWait);
     } else {
-      GECOPollingSourceRec    *source;
+      struct epoll_event      responseBuffer[GECORUNLOOP_MAX_EPOLL_EVENTS];
       
       //
-      // Ensure we have an epoll descriptor open:
+      // Enter polling state:
       //
-      if ( theRunloop->epoll_fd < 0 ) {
-        theRunloop->epoll_fd = epoll_create(8);
-        if ( theRunloop->epoll_fd < 0 ) {
-          GECO_WARN("__GECORunloopRunUntil_Static: failure in epoll_create (errno = %d)", errno);
-          return errno;
-        }
-      }
-  
+      theRunloop->state = GECORunloopStatePolling;
+      
       //
-      // Fill-in the dispatch table, registering the descriptors with epoll
-      // as we go:
+      // Let any interested sources know:
       //
-      if ( ! dispatchTable || (theRunloop->sourceCount > dispatchCapacity) ) {
-        GECORunloopDispatch   *newDispatchTable = realloc(dispatchTable, theRunloop->sourceCount * sizeof(GECORunloopDispatch));
-        
-        if ( ! newDispatchTable ) {
-          if ( dispatchTable ) free((void*)dispatchTable);
-          GECO_WARN("__GECORunloopRunUntil_Static: failed to allocate dispatch table (errno = %d)", errno);
-          return ENOMEM;
-        }
-        dispatchTable = newDispatchTable;
-        dispatchCapacity = theRunloop->sourceCount;
-      }
-      if ( ! dispatchCount ) {
-        GECO_DEBUG("reconstructing dispatch table using %u sources", theRunloop->sourceCount);
-        source = theRunloop->sources;
-        while ( source ) {
-          int                   fdOfInterest = source->callbacks.fileDescriptorForPolling(source->theSource);
-          
-          if ( fdOfInterest >= 0 ) {
-            struct epoll_event  ev = {
-                                    .events = EPOLLIN | EPOLLHUP | EPOLLRDHUP,
-                                    .data.fd = fdOfInterest
-                                  };
-            if ( epoll_ctl(theRunloop->epoll_fd, EPOLL_CTL_ADD, fdOfInterest, &ev) == 0 ) {
-              dispatchTable[dispatchCount].fd = fdOfInterest;
-              dispatchTable[dispatchCount].sourceRec = source;
-              dispatchCount++;
-              GECO_DEBUG("registered fd %d with epoll fd %d", fdOfInterest, theRunloop->epoll_fd);
-            } else {
-              GECO_WARN("__GECORunloopRunUntil_Static: failed to register fd %d with epoll fd %d (errno = %d)", fdOfInterest, theRunloop->epoll_fd, errno);
-            }
-          }
-          source = source->link;
-        }
-        GECOFLAGS_UNSET(theRunloop->flags, GECORunloopFlagResetStaticDispatch);
+      if ( theRunloop->pollingNotifyCount ) {
+        GECO_DEBUG("notifying all sources -- didBeginPolling");
+        GECORUNLOOP_NOTIFY_POLLINGSOURCES(theRunloop, didBeginPolling);
       }
-      GECO_DEBUG("dispatch table constructed with %u descriptors", dispatchCount);
       
       //
-      // If we didn't actually register any sources, just sleep...
+      // Go to sleep and await an event or two:
       //
-      if ( dispatchCount == 0 ) {
-        GECO_INFO("no sources registered with epoll, going to sleep");
-        GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityBeforeWait);
-        GECOSleepForMicroseconds(timeout);
-        GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityAfterWait);
-      } else {
-        struct epoll_event      responseBuffer[dispatchCount];
-        
-        //
-        // Enter polling state:
-        //
-        theRunloop->state = GECORunloopStatePolling;
-        
-        //
-        // Let any interested sources know:
-        //
-        GECO_DEBUG("notifying all sources -- didBeginPolling");
-        GECORUNLOOP_NOTIFY_POLLINGSOURCES(theRunloop, didBeginPolling);
-        
-        //
-        // Go to sleep and await an event or two:
-        //
-        GECO_DEBUG("entering epoll_wait(%d, %p, %u, %d)...", theRunloop->epoll_fd, responseBuffer, dispatchCount, timeout);
-        GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityBeforeWait);
-        int eventCount = epoll_wait(theRunloop->epoll_fd, responseBuffer, dispatchCount, timeout);
-        GECO_DEBUG("...exited epoll_wait(%d, %p, %u, %d) = %d", theRunloop->epoll_fd, responseBuffer, dispatchCount, timeout, eventCount);
-        GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityAfterWait);
-        
-        //
-        // Back to idle state:
-        //
-        theRunloop->state = GECORunloopStateIdle;
-        
-        //
-        // Let any interested sources know we've exited epoll:
-        //
+      GECO_DEBUG("entering epoll_wait(%d, %p, %d, %d)...", theRunloop->epoll_fd, responseBuffer, GECORUNLOOP_MAX_EPOLL_EVENTS, timeout);
+      GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityBeforeWait);
+      int eventCount = epoll_wait(theRunloop->epoll_fd, responseBuffer, GECORUNLOOP_MAX_EPOLL_EVENTS, timeout);
+      GECO_DEBUG("...exited epoll_wait(%d, %p, %d, %d) = %d", theRunloop->epoll_fd, responseBuffer, GECORUNLOOP_MAX_EPOLL_EVENTS, timeout, eventCount);
+      GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityAfterWait);
+      
+      //
+      // Back to idle state:
+      //
+      theRunloop->state = GECORunloopStateIdle;
+      
+      //
+      // Let any interested sources know we've exited epoll:
+      //
+      if ( theRunloop->pollingNotifyCount ) {
         GECO_DEBUG("notifying all sources -- didEndPolling");
         GECORUNLOOP_NOTIFY_POLLINGSOURCES(theRunloop, didEndPolling);
-        
-        if ( eventCount < 0 ) {
-          //
-          // If we were interrupted by a signal we can keep going, otherwise
-          // it's time to get outta here:
-          //
-          if ( errno != EINTR ) {
-            GECO_WARN("__GECORunloopRunUntil_Static: error during runloop causing early exit (errno = %d)", errno);
-            rc = errno;
-            running = false;
-          }
-        } else if ( (eventCount > 0) && ! GECOFLAGS_ISSET(theRunloop->flags, GECORunloopFlagExitRunloop) ) {
-          int           dispatchIdx, eventIdx;
-
-#ifndef GECO_DEBUG_DISABLE
-          //
-          // Debugging -- show all event fds:
-          //
-          eventIdx = 0;
-          while ( eventIdx < eventCount ) {
-            GECO_DEBUG("  event %08X on fd %d", responseBuffer[eventIdx].events, responseBuffer[eventIdx].data.fd);
-            eventIdx++;
-          }
-#endif
-
-          //
-          // Walk the dispatch table:
-          //
-          dispatchIdx = 0;
-          GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityBeforeSources);
-          while ( dispatchIdx < dispatchCount ) {
-            int                     fdToMatch = dispatchTable[dispatchIdx].fd;
-            GECOPollingSourceRec    *source = dispatchTable[dispatchIdx].sourceRec;
-            
-            eventIdx = 0;
-            while ( eventIdx < eventCount ) {
-              if ( fdToMatch == responseBuffer[eventIdx].data.fd ) {
-                if ( responseBuffer[eventIdx].events & EPOLLIN ) {
-                  //
-                  // Data present for read on file descriptor:
-                  //
-                  GECO_DEBUG("notifying source for fd %d -- didReceiveDataAvailable", fdToMatch);
-                  GECORUNLOOP_NOTIFY_POLLINGSOURCE(theRunloop, source, didReceiveDataAvailable);
-                }
-                if ( (responseBuffer[eventIdx].events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR)) || (source->callbacks.shouldSourceClose && source->callbacks.shouldSourceClose(source->theSource, theRunloop)) ) {
-                  //
-                  // Cleanup after a closed descriptor:
-                  //
-                  GECO_DEBUG("notifying source for closed fd %d", fdToMatch);
-                  GECORUNLOOP_NOTIFY_POLLINGSOURCE(theRunloop, source, didReceiveClose);
-                  if ( GECOFLAGS_ISSET(source->flags, GECOPollingSourceFlagRemoveOnClose) ) {
-                    GECO_DEBUG("removing source for closed fd %d", fdToMatch);
-                    GECORunloopRemovePollingSource(theRunloop, source->theSource);
-                  }
-                }
-                break;
-              }
-              eventIdx++;
-            }
-            dispatchIdx++;
-          }
-          GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityAfterSources);
-        }
       }
       
-      //
-      // Do we need to redo the dispatch table?
-      //
-      if ( GECOFLAGS_ISSET(theRunloop->flags, GECORunloopFlagResetStaticDispatch) ) {
-        GECO_DEBUG("clearing %d sources from the dispatch table", dispatchCount);
-        while ( dispatchCount-- ) {
-          struct epoll_event  ev = {
-                                  .events = EPOLLIN | EPOLLHUP | EPOLLRDHUP,
-                                  .data.fd = dispatchTable[dispatchCount].fd
-                                };
-          epoll_ctl(theRunloop->epoll_fd, EPOLL_CTL_DEL, dispatchTable[dispatchCount].fd, &ev);
+      if ( eventCount < 0 ) {
+        //
+        // If we were interrupted by a signal we can keep going, otherwise
+        // it's time to get outta here:
+        //
+        if ( errno != EINTR ) {
+          GECO_WARN("__GECORunloopRunUntil_Static: error during runloop causing early exit (errno = %d)", errno);
+          rc = errno;
+          running = false;
         }
-        dispatchCount = 0;
+      } else if ( (eventCount > 0) && ! GECOFLAGS_ISSET(theRunloop->flags, GECORunloopFlagExitRunloop) ) {
+        __GECORunloopDispatchEvents(theRunloop, responseBuffer, eventCount);
       }
     }
   }
   
-  if ( dispatchTable ) {
-    GECO_DEBUG("clearing %d sources from the dispatch table", dispatchCount);
-    while ( dispatchCount-- ) {
-      struct epoll_event  ev = {
-                              .events = EPOLLIN | EPOLLHUP | EPOLLRDHUP,
-                              .data.fd = dispatchTable[dispatchCount].fd
-                            };
-      epoll_ctl(theRunloop->epoll_fd, EPOLL_CTL_DEL, dispatchTable[dispatchCount].fd, &ev);
-    }
-    free((void*)dispatchTable);
-  }
-  
   GECORUNLOOP_INVOKE_OBSERVERS(theRunloop, GECORunloopActivityExit);
   
   return rc;
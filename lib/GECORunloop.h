@@ -93,6 +93,17 @@ typedef void (*GECORunloopObserverCallback)(GECORunloopObserver theObserver, GEC
 
 //
 
+/*!
+  @typedef GECORunloopTimerRef
+  @discussion
+    Type of a reference to a timer scheduled on a runloop.
+*/
+typedef struct _GECORunloopTimer * GECORunloopTimerRef;
+
+typedef void (*GECORunloopTimerCallback)(GECORunloopTimerRef theTimer, GECORunloopRef theRunloop, const void *context);
+
+//
+
 GECORunloopRef GECORunloopCreate(void);
 void GECORunloopDestroy(GECORunloopRef theRunloop);
 
@@ -119,6 +130,37 @@ void GECORunloopRemoveObserver(GECORunloopRef theRunloop, GECORunloopObserver th
 void GECORunloopRemoveObservers(GECORunloopRef theRunloop, GECORunloopActivity theActivities);
 void GECORunloopRemoveAllObservers(GECORunloopRef theRunloop);
 
+/*!
+  @function GECORunloopAddTimer
+  @discussion
+    Schedule callback to be invoked on theRunloop after interval seconds have
+    elapsed and, if shouldRepeat is true, every interval seconds thereafter.
+    All of a runloop's timers share a single timerfd, so timers fire at their
+    deadlines regardless of the runloop's granularity.
+
+    A one-shot timer is deallocated once its callback returns; the reference
+    must not be used after that point.
+  @result
+    Returns NULL if the timer could not be scheduled (or if shouldRepeat is
+    true and interval is not positive).
+*/
+GECORunloopTimerRef GECORunloopAddTimer(GECORunloopRef theRunloop, double interval, bool shouldRepeat, GECORunloopTimerCallback callback, const void *context);
+
+/*!
+  @function GECORunloopInvalidateTimer
+  @discussion
+    Unschedule theTimer and deallocate it.  May be called from within the
+    timer's own callback.
+*/
+void GECORunloopInvalidateTimer(GECORunloopRef theRunloop, GECORunloopTimerRef theTimer);
+
+/*!
+  @function GECORunloopGetTimerCount
+  @result
+    Returns the number of timers scheduled on theRunloop.
+*/
+unsigned int GECORunloopGetTimerCount(GECORunloopRef theRunloop);
+
 int GECORunloopRun(GECORunloopRef theRunloop);
 int GECORunloopRunUntil(GECORunloopRef theRunloop, time_t endTime);
 
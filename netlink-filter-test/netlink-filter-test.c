@@ -0,0 +1,224 @@
+/*
+ *  GECO — Grid Engine Cgroup Orchestrator
+ *  netlink-filter-test.c
+ *
+ *  Standalone program that benchmarks the rate at which proc connector
+ *  events reach a netlink socket with and without gecod's BPF filter
+ *  attached.  Must be run as root.
+ *
+ *  Copyright © 2015
+ *  Dr. Jeffrey Frey, University of Delaware
+ *
+ *  $Id$
+ */
+
+#include "GECO.h"
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include "GECODNetlinkFilter.c"
+
+//
+
+#ifndef NETLINKFILTERTEST_DEFAULT_SECONDS
+#define NETLINKFILTERTEST_DEFAULT_SECONDS     5
+#endif
+
+#ifndef NETLINKFILTERTEST_DEFAULT_WATERMARK
+#define NETLINKFILTERTEST_DEFAULT_WATERMARK   300
+#endif
+
+//
+
+typedef enum {
+  netlinkfiltertest_mode_none = 0,
+  netlinkfiltertest_mode_exit_only,
+  netlinkfiltertest_mode_exit_watermark
+} netlinkfiltertest_mode;
+
+static const char *netlinkfiltertest_mode_labels[] = { "unfiltered", "exit-only", "exit+watermark" };
+
+//
+
+double
+netlinkfiltertest_elapsed(
+  struct timeval    *t0,
+  struct timeval    *t1
+)
+{
+  return (t1->tv_sec - t0->tv_sec) + 1e-6 * (t1->tv_usec - t0->tv_usec);
+}
+
+//
+
+int
+netlinkfiltertest_open(
+  netlinkfiltertest_mode  mode,
+  pid_t                   pidWatermark
+)
+{
+  struct sockaddr_nl      nlAddr;
+  char                    msgBuffer[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op))];
+  struct nlmsghdr         *nl_hdr = (struct nlmsghdr*)msgBuffer;
+  struct cn_msg           *cn_hdr = (struct cn_msg*)NLMSG_DATA(nl_hdr);
+  struct timeval          timeout = { .tv_sec = 0, .tv_usec = 100000 };
+  int                     fd, rc;
+  
+  fd = socket(PF_NETLINK, SOCK_DGRAM, NETLINK_CONNECTOR);
+  if ( fd < 0 ) {
+    fprintf(stderr, "ERROR:  unable to create netlink socket (errno = %d)\n", errno);
+    return -1;
+  }
+  if ( mode != netlinkfiltertest_mode_none ) {
+    rc = GECODNetlinkFilterAttach(fd, (mode == netlinkfiltertest_mode_exit_watermark) ? pidWatermark : 0);
+    if ( rc != 0 ) {
+      fprintf(stderr, "ERROR:  unable to attach filter (errno = %d)\n", rc);
+      close(fd);
+      return -1;
+    }
+  }
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  
+  memset(&nlAddr, 0, sizeof(nlAddr));
+  nlAddr.nl_family = AF_NETLINK;
+  nlAddr.nl_groups = CN_IDX_PROC;
+  nlAddr.nl_pid = getpid();
+  if ( bind(fd, (struct sockaddr*)&nlAddr, sizeof(nlAddr)) != 0 ) {
+    fprintf(stderr, "ERROR:  unable to bind netlink socket (errno = %d)\n", errno);
+    close(fd);
+    return -1;
+  }
+  
+  memset(msgBuffer, 0, sizeof(msgBuffer));
+  nl_hdr->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op));
+  nl_hdr->nlmsg_type = NLMSG_DONE;
+  nl_hdr->nlmsg_pid = getpid();
+  cn_hdr->id.idx = CN_IDX_PROC;
+  cn_hdr->id.val = CN_VAL_PROC;
+  cn_hdr->len = sizeof(enum proc_cn_mcast_op);
+  *((enum proc_cn_mcast_op*)&cn_hdr->data[0]) = PROC_CN_MCAST_LISTEN;
+  if ( send(fd, nl_hdr, nl_hdr->nlmsg_len, 0) != nl_hdr->nlmsg_len ) {
+    fprintf(stderr, "ERROR:  unable to subscribe to proc connector (errno = %d)\n", errno);
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+//
+
+pid_t
+netlinkfiltertest_workload(
+  int               seconds
+)
+{
+  pid_t             worker = fork();
+  
+  if ( worker == 0 ) {
+    time_t          stopTime = time(NULL) + seconds;
+  
+    //
+    // Each iteration generates a fork and an exit event; only the latter is
+    // of any interest to gecod:
+    //
+    while ( time(NULL) < stopTime ) {
+      pid_t         child = fork();
+  
+      if ( child == 0 ) _exit(0);
+      if ( child > 0 ) waitpid(child, NULL, 0);
+    }
+    _exit(0);
+  }
+  return worker;
+}
+
+//
+
+bool
+netlinkfiltertest_run(
+  netlinkfiltertest_mode  mode,
+  int                     seconds,
+  pid_t                   pidWatermark
+)
+{
+  char                    msgBuffer[4096];
+  long int                messages = 0, exits = 0, overruns = 0;
+  struct rusage           r0, r1;
+  struct timeval          t0, t1;
+  double                  wallTime, cpuTime;
+  pid_t                   worker;
+  int                     fd, status;
+  bool                    isRunning = true;
+  
+  fd = netlinkfiltertest_open(mode, pidWatermark);
+  if ( fd < 0 ) return false;
+  
+  gettimeofday(&t0, NULL);
+  getrusage(RUSAGE_SELF, &r0);
+  worker = netlinkfiltertest_workload(seconds);
+  if ( worker < 0 ) {
+    fprintf(stderr, "ERROR:  unable to fork workload (errno = %d)\n", errno);
+    close(fd);
+    return false;
+  }
+  while ( isRunning ) {
+    ssize_t               count = recv(fd, msgBuffer, sizeof(msgBuffer), 0);
+  
+    if ( count > 0 ) {
+      struct nlmsghdr     *nl_hdr = (struct nlmsghdr*)msgBuffer;
+  
+      while ( NLMSG_OK(nl_hdr, count) ) {
+        if ( nl_hdr->nlmsg_type != NLMSG_NOOP && nl_hdr->nlmsg_type != NLMSG_ERROR ) {
+          struct cn_msg     *cn_hdr = (struct cn_msg*)NLMSG_DATA(nl_hdr);
+          struct proc_event *ev = (struct proc_event*)cn_hdr->data;
+  
+          messages++;
+          if ( ev->what == PROC_EVENT_EXIT ) exits++;
+        }
+        nl_hdr = NLMSG_NEXT(nl_hdr, count);
+      }
+    } else if ( count < 0 && errno == ENOBUFS ) {
+      overruns++;
+    }
+    if ( waitpid(worker, &status, WNOHANG) == worker ) isRunning = false;
+  }
+  getrusage(RUSAGE_SELF, &r1);
+  gettimeofday(&t1, NULL);
+  close(fd);
+  
+  wallTime = netlinkfiltertest_elapsed(&t0, &t1);
+  cpuTime = netlinkfiltertest_elapsed(&r0.ru_utime, &r1.ru_utime) + netlinkfiltertest_elapsed(&r0.ru_stime, &r1.ru_stime);
+  printf("%-16s %10ld events %10.0lf events/s %10ld exits %10.0lf exits/s %6ld overruns %8.3lf s cpu\n",
+      netlinkfiltertest_mode_labels[mode],
+      messages, messages / wallTime,
+      exits, exits / wallTime,
+      overruns, cpuTime
+    );
+  return true;
+}
+
+//
+
+int
+main(
+  int         argc,
+  char        **argv
+)
+{
+  long int              seconds = NETLINKFILTERTEST_DEFAULT_SECONDS;
+  long int              pidWatermark = NETLINKFILTERTEST_DEFAULT_WATERMARK;
+  
+  if ( ((argc > 1) && (! GECO_strtol(argv[1], &seconds, NULL) || (seconds <= 0))) || ((argc > 2) && (! GECO_strtol(argv[2], &pidWatermark, NULL) || (pidWatermark < 0))) ) {
+    fprintf(stderr, "usage:\n\n  %s {<seconds> {<pid-watermark>}}\n\n  (defaults are %d seconds per mode and a pid watermark of %d)\n\n",
+        argv[0], NETLINKFILTERTEST_DEFAULT_SECONDS, NETLINKFILTERTEST_DEFAULT_WATERMARK
+      );
+    return EINVAL;
+  }
+  
+  if ( ! netlinkfiltertest_run(netlinkfiltertest_mode_none, seconds, pidWatermark) ) return 1;
+  if ( ! netlinkfiltertest_run(netlinkfiltertest_mode_exit_only, seconds, pidWatermark) ) return 1;
+  if ( ! netlinkfiltertest_run(netlinkfiltertest_mode_exit_watermark, seconds, pidWatermark) ) return 1;
+  
+  return 0;
+}
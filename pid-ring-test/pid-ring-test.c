@@ -0,0 +1,144 @@
+/*
+ *  GECO — Grid Engine Cgroup Orchestrator
+ *  pid-ring-test.c
+ *
+ *  Standalone program that pushes a sequence of pids through gecod's
+ *  single-producer, single-consumer pid ring from one thread to another,
+ *  checking that every pid arrives once and in order, and reports the
+ *  throughput.
+ *
+ *  Copyright © 2015
+ *  Dr. Jeffrey Frey, University of Delaware
+ *
+ *  $Id$
+ */
+
+#include "GECO.h"
+#include <pthread.h>
+#include <sched.h>
+#include <sys/time.h>
+
+#include "GECODPidRing.c"
+
+//
+
+#ifndef PIDRINGTEST_DEFAULT_COUNT
+#define PIDRINGTEST_DEFAULT_COUNT     50000000
+#endif
+
+#ifndef PIDRINGTEST_DEFAULT_CAPACITY
+#define PIDRINGTEST_DEFAULT_CAPACITY  4096
+#endif
+
+#ifndef PIDRINGTEST_BATCH_SIZE
+#define PIDRINGTEST_BATCH_SIZE        64
+#endif
+
+//
+
+typedef struct {
+  GECODPidRing      *ring;
+  long int          count;
+  long int          fullCount;
+} pidringtest_producer;
+
+//
+
+void*
+pidringtest_produce(
+  void              *context
+)
+{
+  pidringtest_producer  *producer = (pidringtest_producer*)context;
+  pid_t                 pids[PIDRINGTEST_BATCH_SIZE];
+  long int              next = 0;
+  
+  while ( next < producer->count ) {
+    unsigned int        pidCount = 0, pushCount = 0;
+  
+    while ( (pidCount < PIDRINGTEST_BATCH_SIZE) && (next + pidCount < producer->count) ) {
+      pids[pidCount] = (pid_t)(next + pidCount);
+      pidCount++;
+    }
+    while ( pushCount < pidCount ) {
+      unsigned int      n = GECODPidRingPush(producer->ring, pids + pushCount, pidCount - pushCount);
+  
+      if ( n == 0 ) {
+        // Let the consumer run if it's sharing our cpu:
+        producer->fullCount++;
+        sched_yield();
+      }
+      pushCount += n;
+    }
+    next += pidCount;
+  }
+  return NULL;
+}
+
+//
+
+int
+main(
+  int         argc,
+  char        **argv
+)
+{
+  long int              count = PIDRINGTEST_DEFAULT_COUNT;
+  long int              capacity = PIDRINGTEST_DEFAULT_CAPACITY;
+  pidringtest_producer  producer;
+  pthread_t             producerThread;
+  pid_t                 pids[PIDRINGTEST_BATCH_SIZE];
+  long int              expected = 0, emptyCount = 0;
+  struct timeval        t0, t1;
+  double                wallTime;
+  
+  if ( ((argc > 1) && (! GECO_strtol(argv[1], &count, NULL) || (count <= 0))) || ((argc > 2) && (! GECO_strtol(argv[2], &capacity, NULL) || (capacity <= 0))) ) {
+    fprintf(stderr, "usage:\n\n  %s {<pid-count> {<ring-capacity>}}\n\n  (defaults are %d pids through a ring of %d)\n\n",
+        argv[0], PIDRINGTEST_DEFAULT_COUNT, PIDRINGTEST_DEFAULT_CAPACITY
+      );
+    return EINVAL;
+  }
+  
+  producer.ring = GECODPidRingCreate((unsigned int)capacity);
+  if ( ! producer.ring ) {
+    fprintf(stderr, "ERROR:  unable to create ring of capacity %ld\n", capacity);
+    return ENOMEM;
+  }
+  producer.count = count;
+  producer.fullCount = 0;
+  
+  gettimeofday(&t0, NULL);
+  if ( pthread_create(&producerThread, NULL, pidringtest_produce, &producer) != 0 ) {
+    fprintf(stderr, "ERROR:  unable to create producer thread (errno = %d)\n", errno);
+    return 1;
+  }
+  while ( expected < count ) {
+    unsigned int        pidCount = GECODPidRingPop(producer.ring, pids, PIDRINGTEST_BATCH_SIZE), i;
+  
+    if ( pidCount == 0 ) {
+      emptyCount++;
+      sched_yield();
+    }
+    for ( i = 0; i < pidCount; i++ ) {
+      if ( pids[i] != (pid_t)expected ) {
+        fprintf(stderr, "ERROR:  expected pid %ld, popped %ld\n", expected, (long int)pids[i]);
+        return 1;
+      }
+      expected++;
+    }
+  }
+  pthread_join(producerThread, NULL);
+  gettimeofday(&t1, NULL);
+  
+  if ( GECODPidRingPop(producer.ring, pids, PIDRINGTEST_BATCH_SIZE) != 0 ) {
+    fprintf(stderr, "ERROR:  ring not empty after all pids were popped\n");
+    return 1;
+  }
+  
+  wallTime = (t1.tv_sec - t0.tv_sec) + 1e-6 * (t1.tv_usec - t0.tv_usec);
+  printf("%ld pids through a ring of %u in %.3lf s (%.0lf pids/s); producer found it full %ld times, consumer found it empty %ld times\n",
+      count, producer.ring->capacity, wallTime, count / wallTime, producer.fullCount, emptyCount
+    );
+  GECODPidRingDestroy(producer.ring);
+  return 0;
+}
@@ -0,0 +1,226 @@
+/*
+ *  GECO — Grid Engine Cgroup Orchestrator
+ *  pidmap-test.c
+ *  
+ *  Standalone program that tests/benchmarks the GECOPidToJobIdMap
+ *  functionality.
+ *
+ *  Copyright © 2015
+ *  Dr. Jeffrey Frey, University of Delaware
+ *
+ *  $Id$
+ */
+
+#include "GECOPidToJobIdMap.h"
+
+//
+
+#ifndef PIDMAPTEST_DEFAULT_COUNT
+#define PIDMAPTEST_DEFAULT_COUNT    1000000
+#endif
+
+#ifndef PIDMAPTEST_BATCH_SIZE
+#define PIDMAPTEST_BATCH_SIZE       64
+#endif
+
+//
+// Each (jobId, taskId) owns 16 consecutive pids:
+//
+#define PIDMAPTEST_JOBID(P)         ((long int)(P) / 64)
+#define PIDMAPTEST_TASKID(P)        ((long int)(P) % 4)
+#define PIDMAPTEST_STARTTIME(P)     (3 * (long long int)(P))
+
+//
+
+double
+pidmaptest_elapsed(
+  struct timespec   *t0,
+  struct timespec   *t1
+)
+{
+  return (t1->tv_sec - t0->tv_sec) + 1e-9 * (t1->tv_nsec - t0->tv_nsec);
+}
+
+//
+
+int
+main(
+  int         argc,
+  char        **argv
+)
+{
+  long int              pidCount = PIDMAPTEST_DEFAULT_COUNT;
+  GECOPidToJobIdMapRef  theMap;
+  pid_t                 *pids;
+  long int              i, errors = 0;
+  struct timespec       t0, t1;
+  
+  if ( (argc > 1) && (! GECO_strtol(argv[1], &pidCount, NULL) || (pidCount <= 0)) ) {
+    fprintf(stderr, "usage:\n\n  %s {<pid-count>}\n\n  (default pid count is %d)\n\n", argv[0], PIDMAPTEST_DEFAULT_COUNT);
+    return EINVAL;
+  }
+  
+  //
+  // Sequential pids (as the kernel hands them out), visited in shuffled order:
+  //
+  if ( ! (pids = malloc(pidCount * sizeof(pid_t))) ) return ENOMEM;
+  for ( i = 0; i < pidCount; i++ ) pids[i] = 1000 + i;
+  for ( i = pidCount - 1; i > 0; i-- ) {
+    long int            j = random() % (i + 1);
+    pid_t               tmp = pids[i];
+    
+    pids[i] = pids[j];
+    pids[j] = tmp;
+  }
+  
+  if ( ! (theMap = GECOPidToJobIdMapCreate(0)) ) {
+    free((void*)pids);
+    return ENOMEM;
+  }
+  
+  printf("%10s %10s %14s %14s\n", "operation", "pids", "total (s)", "per op (ns)");
+  
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for ( i = 0; i < pidCount; i++ ) {
+    if ( ! GECOPidToJobIdMapAddPidWithStartTime(theMap, pids[i], PIDMAPTEST_STARTTIME(pids[i]), PIDMAPTEST_JOBID(pids[i]), PIDMAPTEST_TASKID(pids[i])) ) errors++;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  printf("%10s %10ld %14.6f %14.1f\n", "add", pidCount, pidmaptest_elapsed(&t0, &t1), 1e9 * pidmaptest_elapsed(&t0, &t1) / pidCount);
+  if ( GECOPidToJobIdMapGetCount(theMap) != pidCount ) errors++;
+  
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for ( i = 0; i < pidCount; i++ ) {
+    long int            jobId, taskId;
+    long long int       startTime;
+    
+    if ( ! GECOPidToJobIdMapGetJobAndTaskIdForPid(theMap, pids[i], &jobId, &taskId) || (jobId != PIDMAPTEST_JOBID(pids[i])) || (taskId != PIDMAPTEST_TASKID(pids[i])) ) errors++;
+    if ( ! GECOPidToJobIdMapGetStartTimeForPid(theMap, pids[i], &startTime) || (startTime != PIDMAPTEST_STARTTIME(pids[i])) ) errors++;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  printf("%10s %10ld %14.6f %14.1f\n", "lookup", pidCount, pidmaptest_elapsed(&t0, &t1), 1e9 * pidmaptest_elapsed(&t0, &t1) / pidCount);
+  
+  //
+  // A full enumeration must visit every pid exactly once (pids are 1000 + i,
+  // so a simple bitmap catches duplicates):
+  //
+  {
+    char                *seen = calloc(pidCount, 1);
+    pid_t               batch[PIDMAPTEST_BATCH_SIZE];
+    unsigned int        cursor = 0, n;
+    long int            visited = 0;
+    
+    if ( ! seen ) return ENOMEM;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    do {
+      n = GECOPidToJobIdMapGetPids(theMap, &cursor, batch, PIDMAPTEST_BATCH_SIZE);
+      while ( n-- ) {
+        long int        k = batch[n] - 1000;
+        
+        if ( (k < 0) || (k >= pidCount) || seen[k]++ ) errors++;
+        visited++;
+      }
+    } while ( cursor != 0 );
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("%10s %10ld %14.6f %14.1f\n", "enumerate", visited, pidmaptest_elapsed(&t0, &t1), 1e9 * pidmaptest_elapsed(&t0, &t1) / (visited ? visited : 1));
+    if ( visited != pidCount ) errors++;
+    free((void*)seen);
+  }
+  
+  //
+  // Enumerating by job must account for every pid, too:
+  //
+  {
+    GECOPidToJobIdMapJobCount jobCounts[PIDMAPTEST_BATCH_SIZE];
+    unsigned int              cursor = 0, n;
+    long int                  jobCount = 0, visited = 0;
+    
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    do {
+      n = GECOPidToJobIdMapGetJobs(theMap, &cursor, jobCounts, PIDMAPTEST_BATCH_SIZE);
+      jobCount += n;
+      while ( n-- ) {
+        if ( jobCounts[n].pidCount != GECOPidToJobIdMapGetPidCountForJobAndTaskId(theMap, jobCounts[n].jobId, jobCounts[n].taskId) ) errors++;
+        visited += jobCounts[n].pidCount;
+      }
+    } while ( cursor != 0 );
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("%10s %10ld %14.6f %14.1f\n", "enum-jobs", jobCount, pidmaptest_elapsed(&t0, &t1), 1e9 * pidmaptest_elapsed(&t0, &t1) / (jobCount ? jobCount : 1));
+    if ( visited != pidCount ) errors++;
+  }
+  
+  //
+  // Remove the first half (one quarter individually, one quarter in batches), then
+  // make sure exactly the second half remains:
+  //
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for ( i = 0; i < pidCount / 4; i++ ) GECOPidToJobIdMapRemovePid(theMap, pids[i]);
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  printf("%10s %10ld %14.6f %14.1f\n", "remove", pidCount / 4, pidmaptest_elapsed(&t0, &t1), 1e9 * pidmaptest_elapsed(&t0, &t1) / (pidCount / 4 ? pidCount / 4 : 1));
+  {
+    GECOPidToJobIdMapJobCount jobCounts[PIDMAPTEST_BATCH_SIZE];
+    long int                  removed = 0;
+    
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for ( i = pidCount / 4; i < pidCount / 2; i += PIDMAPTEST_BATCH_SIZE ) {
+      unsigned int            n = ( pidCount / 2 - i < PIDMAPTEST_BATCH_SIZE ) ? (pidCount / 2 - i) : PIDMAPTEST_BATCH_SIZE;
+      unsigned int            j = GECOPidToJobIdMapRemovePids(theMap, n, &pids[i], jobCounts, PIDMAPTEST_BATCH_SIZE);
+      
+      while ( j-- ) removed += jobCounts[j].pidCount;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("%10s %10ld %14.6f %14.1f\n", "batch-rm", pidCount / 2 - pidCount / 4, pidmaptest_elapsed(&t0, &t1), 1e9 * pidmaptest_elapsed(&t0, &t1) / (pidCount / 2 - pidCount / 4 ? pidCount / 2 - pidCount / 4 : 1));
+    if ( removed != pidCount / 2 - pidCount / 4 ) errors++;
+  }
+  for ( i = 0; i < pidCount; i++ ) {
+    long int            jobId, taskId;
+    bool                found = GECOPidToJobIdMapGetJobAndTaskIdForPid(theMap, pids[i], &jobId, &taskId);
+    
+    if ( found != (i >= pidCount / 2) ) errors++;
+  }
+  if ( GECOPidToJobIdMapGetCount(theMap) != pidCount - pidCount / 2 ) errors++;
+  
+  //
+  // Every remaining pid must show up in its job's pid list:
+  //
+  for ( i = pidCount / 2; i < pidCount; i++ ) {
+    pid_t               jobPids[16];
+    unsigned int        n = GECOPidToJobIdMapGetPidsForJobAndTaskId(theMap, PIDMAPTEST_JOBID(pids[i]), PIDMAPTEST_TASKID(pids[i]), jobPids, 16);
+    
+    if ( (n == 0) || (n > 16) || (n != GECOPidToJobIdMapGetPidCountForJobAndTaskId(theMap, PIDMAPTEST_JOBID(pids[i]), PIDMAPTEST_TASKID(pids[i]))) ) {
+      errors++;
+    } else {
+      while ( n-- && (jobPids[n] != pids[i]) );
+      if ( n == (unsigned int)-1 ) errors++;
+    }
+  }
+  
+  //
+  // Drop the remaining pids job-by-job:
+  //
+  {
+    long int            jobCount = 0, removed = 0;
+    
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for ( i = pidCount / 2; i < pidCount; i++ ) {
+      unsigned int      n = GECOPidToJobIdMapRemoveJobAndTaskId(theMap, PIDMAPTEST_JOBID(pids[i]), PIDMAPTEST_TASKID(pids[i]));
+      
+      if ( n ) {
+        jobCount++;
+        removed += n;
+      }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("%10s %10ld %14.6f %14.1f\n", "drop-job", jobCount, pidmaptest_elapsed(&t0, &t1), 1e9 * pidmaptest_elapsed(&t0, &t1) / (jobCount ? jobCount : 1));
+    if ( removed != pidCount - pidCount / 2 ) errors++;
+    if ( GECOPidToJobIdMapGetCount(theMap) != 0 ) errors++;
+    for ( i = 0; i < pidCount; i++ ) {
+      if ( GECOPidToJobIdMapHasJobAndTaskId(theMap, PIDMAPTEST_JOBID(pids[i]), PIDMAPTEST_TASKID(pids[i])) ) errors++;
+    }
+  }
+  
+  GECOPidToJobIdMapDestroy(theMap);
+  free((void*)pids);
+  
+  printf("%ld error%s\n", errors, ((errors == 1) ? "" : "s"));
+  return ( errors ? 1 : 0 );
+}
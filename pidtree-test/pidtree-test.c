@@ -11,6 +11,72 @@
  */
 
 #include "GECO.h"
+#include <getopt.h>
+
+const struct option pidtreetest_options[] = {
+                  { "help",                 no_argument,          NULL,         'h' },
+                  { "benchmark",            required_argument,    NULL,         'b' },
+                  { NULL,                   0,                    0,             0  }
+                };
+
+//
+
+int
+pidtreetest_benchmark(
+  unsigned int        rounds
+)
+{
+  struct timespec     t0, t1;
+  double              buildTime = 0.0, destroyTime = 0.0;
+  unsigned long       nodeCount = 0;
+  unsigned int        round;
+  
+  for ( round = 0; round < rounds; round++ ) {
+    GECOPidTree       *theTree;
+    
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    theTree = GECOPidTreeCreate(true);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if ( ! theTree ) {
+      printf("failed to create process tree (errno = %d)\n", errno);
+      return errno;
+    }
+    buildTime += (t1.tv_sec - t0.tv_sec) + 1e-9 * (t1.tv_nsec - t0.tv_nsec);
+    nodeCount += GECOPidTreeGetNodeCount(theTree);
+    
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    GECOPidTreeDestroy(theTree);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    destroyTime += (t1.tv_sec - t0.tv_sec) + 1e-9 * (t1.tv_nsec - t0.tv_nsec);
+  }
+  printf("%10s %10s %14s %14s %16s %16s\n", "rounds", "nodes", "build (s)", "destroy (s)", "build (nodes/s)", "destroy (nodes/s)");
+  printf("%10u %10lu %14.6f %14.6f %16.0f %16.0f\n", rounds, nodeCount / rounds, buildTime, destroyTime, nodeCount / buildTime, nodeCount / destroyTime);
+  return 0;
+}
+
+//
+
+void
+usage(
+  const char    *exe
+)
+{
+  printf(
+      "usage:\n\n"
+      "  %s {options} [pid]\n\n"
+      " options:\n\n"
+      "  -h/--help                    show this information\n"
+      "  -b/--benchmark <rounds>      build and destroy the process tree <rounds>\n"
+      "                               times and report nodes/sec for each\n"
+      "\n"
+      "  With no options, the process tree (or the subtree rooted at [pid]) is\n"
+      "  displayed.\n"
+      "\n",
+      exe
+    );
+}
+
+//
 
 int
 main(
@@ -18,15 +84,41 @@ main(
   char        **argv
 )
 {
+  int           optch;
+  
+  while ( (optch = getopt_long(argc, argv, "hb:", pidtreetest_options, NULL)) != -1 ) {
+    switch ( optch ) {
+    
+      case 'h':
+        usage(argv[0]);
+        exit(0);
+      
+      case 'b': {
+        long int  rounds;
+        
+        if ( ! GECO_strtol(optarg, &rounds, NULL) || (rounds <= 0) ) {
+          fprintf(stderr, "ERROR:  invalid round count: %s\n", optarg);
+          exit(EINVAL);
+        }
+        exit(pidtreetest_benchmark((unsigned int)rounds));
+      }
+      
+      default:
+        usage(argv[0]);
+        exit(EINVAL);
+    
+    }
+  }
+  
   GECOPidTree   *theTree = GECOPidTreeCreate(true);
   
   if ( theTree ) {
     GECOPidTree *searchFrom = theTree;
     
-    if ( argc > 1 ) {
+    if ( optind < argc ) {
       long int  thePid;
       
-      if ( GECO_strtol(argv[1], &thePid, NULL) ) {
+      if ( GECO_strtol(argv[optind], &thePid, NULL) ) {
         searchFrom = GECOPidTreeGetNodeWithPid(theTree, (pid_t)thePid);
       }
     }
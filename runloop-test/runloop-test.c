@@ -13,11 +13,16 @@
 #include "GECORunloop.h"
 #include "GECOLog.h"
 #include <getopt.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
 
 const struct option geco_cli_options[] = {
                   { "help",                 no_argument,          NULL,         'h' },
                   { "verbose",              no_argument,          NULL,         'v' },
                   { "quiet",                no_argument,          NULL,         'q' },
+                  { "benchmark",            required_argument,    NULL,         'b' },
+                  { "rounds",               required_argument,    NULL,         'n' },
+                  { "timer",                required_argument,    NULL,         't' },
                   { NULL,                   0,                    0,             0  }
                 };
 
@@ -105,6 +110,178 @@ GECOPollingSourceCallbacks    ourCallbacks = {
                                             .didRemoveAsSource = NULL
                                           };
 
+void
+runlooptest_timerFired(
+  GECORunloopTimerRef theTimer,
+  GECORunloopRef      theRunloop,
+  const void          *context
+)
+{
+  struct timespec     now;
+  
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  printf("...%s timer %p fired at %ld.%09ld\n", (const char*)context, theTimer, (long)now.tv_sec, now.tv_nsec);
+}
+
+//
+#if 0
+#pragma mark -
+#endif
+//
+
+typedef struct {
+  int                 fd;
+  unsigned long       hits;
+} runlooptest_benchmarkSource;
+
+//
+
+void
+runlooptest_benchmarkDestroySource(
+  GECOPollingSource   theSource
+)
+{
+  runlooptest_benchmarkSource *src = (runlooptest_benchmarkSource*)theSource;
+  
+  if ( src->fd >= 0 ) close(src->fd);
+  free((void*)src);
+}
+
+//
+
+int
+runlooptest_benchmarkFileDescriptorForPolling(
+  GECOPollingSource   theSource
+)
+{
+  return ((runlooptest_benchmarkSource*)theSource)->fd;
+}
+
+//
+
+void
+runlooptest_benchmarkDidReceiveDataAvailable(
+  GECOPollingSource   theSource,
+  GECORunloopRef      theRunloop
+)
+{
+  runlooptest_benchmarkSource *src = (runlooptest_benchmarkSource*)theSource;
+  uint64_t                    counter;
+  
+  if ( read(src->fd, &counter, sizeof(counter)) == sizeof(counter) ) src->hits++;
+}
+
+//
+
+GECOPollingSourceCallbacks    benchmarkCallbacks = {
+                                            .destroySource = runlooptest_benchmarkDestroySource,
+                                            .fileDescriptorForPolling = runlooptest_benchmarkFileDescriptorForPolling,
+                                            .didReceiveDataAvailable = runlooptest_benchmarkDidReceiveDataAvailable
+                                          };
+
+//
+
+void
+runlooptest_benchmarkObserver(
+  GECORunloopObserver theObserver,
+  GECORunloopRef      theRunloop,
+  GECORunloopActivity theActivity
+)
+{
+  //
+  // Leave the runloop after each dispatch pass so every round times
+  // exactly one wakeup:
+  //
+  GECORunloopSetShouldExitRunloop(theRunloop, true);
+}
+
+//
+
+int
+runlooptest_benchmark(
+  unsigned int        maxSources,
+  unsigned int        rounds
+)
+{
+  struct rlimit       fdLimit;
+  unsigned int        sourceCount = 1;
+  
+  //
+  // Each source is an eventfd, so make sure we're allowed enough descriptors:
+  //
+  if ( getrlimit(RLIMIT_NOFILE, &fdLimit) == 0 ) {
+    if ( fdLimit.rlim_cur < maxSources + 64 ) {
+      fdLimit.rlim_cur = ( (fdLimit.rlim_max == RLIM_INFINITY) || (fdLimit.rlim_max >= maxSources + 64) ) ? (maxSources + 64) : fdLimit.rlim_max;
+      setrlimit(RLIMIT_NOFILE, &fdLimit);
+      if ( fdLimit.rlim_cur < maxSources + 64 ) {
+        maxSources = fdLimit.rlim_cur - 64;
+        printf("descriptor limit allows at most %u sources\n", maxSources);
+      }
+    }
+  }
+  
+  printf("%10s %10s %14s %14s\n", "sources", "rounds", "total (s)", "per wakeup (us)");
+  while ( sourceCount <= maxSources ) {
+    GECORunloopRef              theRunloop = GECORunloopCreate();
+    runlooptest_benchmarkSource **sources;
+    unsigned int                i, round;
+    unsigned long               hits = 0;
+    struct timespec             t0, t1;
+    double                      elapsed;
+    
+    if ( ! theRunloop ) return ENOMEM;
+    sources = malloc(sourceCount * sizeof(runlooptest_benchmarkSource*));
+    if ( ! sources ) {
+      GECORunloopDestroy(theRunloop);
+      return ENOMEM;
+    }
+    for ( i = 0; i < sourceCount; i++ ) {
+      sources[i] = malloc(sizeof(runlooptest_benchmarkSource));
+      if ( ! sources[i] ) break;
+      sources[i]->hits = 0;
+      sources[i]->fd = eventfd(0, EFD_NONBLOCK);
+      if ( (sources[i]->fd < 0) || ! GECORunloopAddPollingSource(theRunloop, sources[i], &benchmarkCallbacks, GECOPollingSourceFlagStaticFileDescriptor) ) {
+        printf("failed to create source %u (errno = %d)\n", i, errno);
+        if ( sources[i]->fd >= 0 ) close(sources[i]->fd);
+        free((void*)sources[i]);
+        break;
+      }
+    }
+    if ( i < sourceCount ) {
+      GECORunloopDestroy(theRunloop);
+      free((void*)sources);
+      return EMFILE;
+    }
+    GECORunloopAddObserver(theRunloop, NULL, GECORunloopActivityAfterSources, runlooptest_benchmarkObserver, 0, true);
+    
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for ( round = 0; round < rounds; round++ ) {
+      uint64_t                  one = 1;
+      
+      if ( write(sources[random() % sourceCount]->fd, &one, sizeof(one)) != sizeof(one) ) continue;
+      GECORunloopSetShouldExitRunloop(theRunloop, false);
+      GECORunloopRun(theRunloop);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    elapsed = (t1.tv_sec - t0.tv_sec) + 1e-9 * (t1.tv_nsec - t0.tv_nsec);
+    
+    for ( i = 0; i < sourceCount; i++ ) hits += sources[i]->hits;
+    printf("%10u %10u %14.6f %14.3f%s\n", sourceCount, rounds, elapsed, 1e6 * elapsed / rounds, ( (hits == rounds) ? "" : "  [missed events]" ));
+    
+    GECORunloopDestroy(theRunloop);
+    free((void*)sources);
+    
+    if ( sourceCount == maxSources ) break;
+    sourceCount *= 10;
+    if ( sourceCount > maxSources ) sourceCount = maxSources;
+  }
+  return 0;
+}
+
+//
+#if 0
+#pragma mark -
+#endif
 //
 
 void
@@ -121,6 +298,12 @@ usage(
       "                                 multiple times)\n"
       "  -q/--quiet                   decrease the verbosity level (may be used\n"
       "                                 multiple times)\n"
+      "  -b/--benchmark <#>           time the dispatch of a single event with 1, 10,\n"
+      "                                 100, ... eventfd sources, up to <#> sources\n"
+      "  -n/--rounds <#>              number of wakeups timed per benchmark step\n"
+      "                                 (default: 10000)\n"
+      "  -t/--timer <#.#>             add a repeating timer with the given period (in\n"
+      "                                 seconds) and a one-shot timer at twice that\n"
       "\n"
       " $Id$\n"
       "\n"
@@ -145,9 +328,11 @@ main(
   GECORunloopRef              ourRunloop = GECORunloopCreate();
   time_t                      expire = time(NULL) + 30;
   int                         rc = 0;
+  long                        benchmarkSources = 0, benchmarkRounds = 10000;
+  double                      timerPeriod = 0.0;
   
   // Check for arguments:
-  while ( (optch = getopt_long(argc, argv, "hvq", geco_cli_options, NULL)) != -1 ) {
+  while ( (optch = getopt_long(argc, argv, "hvqb:n:t:", geco_cli_options, NULL)) != -1 ) {
     switch ( optch ) {
       
       case 'h':
@@ -161,10 +346,40 @@ main(
       case 'q':
         GECOLogDecLevel(GECOLogGetDefault());
         break;
+      
+      case 'b':
+        if ( ! GECO_strtol(optarg, &benchmarkSources, NULL) || (benchmarkSources <= 0) ) {
+          fprintf(stderr, "ERROR:  invalid source count: %s\n", optarg);
+          exit(EINVAL);
+        }
+        break;
+      
+      case 'n':
+        if ( ! GECO_strtol(optarg, &benchmarkRounds, NULL) || (benchmarkRounds <= 0) ) {
+          fprintf(stderr, "ERROR:  invalid round count: %s\n", optarg);
+          exit(EINVAL);
+        }
+        break;
+      
+      case 't': {
+        char    *endPtr = NULL;
+        
+        timerPeriod = strtod(optarg, &endPtr);
+        if ( ! endPtr || *endPtr || (timerPeriod <= 0.0) ) {
+          fprintf(stderr, "ERROR:  invalid timer period: %s\n", optarg);
+          exit(EINVAL);
+        }
+        break;
+      }
     
     }
   }
   
+  if ( benchmarkSources > 0 ) {
+    GECORunloopDestroy(ourRunloop);
+    return runlooptest_benchmark((unsigned int)benchmarkSources, (unsigned int)benchmarkRounds);
+  }
+  
   argn = optind;
   while ( argn < argc ) {
     runlooptest_pollingSource   *src = malloc(sizeof(runlooptest_pollingSource));
@@ -186,6 +401,11 @@ main(
     argn++;
   }
   
+  if ( timerPeriod > 0.0 ) {
+    if ( ! GECORunloopAddTimer(ourRunloop, timerPeriod, true, runlooptest_timerFired, "repeating") ) printf("failed to add repeating timer\n");
+    if ( ! GECORunloopAddTimer(ourRunloop, 2 * timerPeriod, false, runlooptest_timerFired, "one-shot") ) printf("failed to add one-shot timer\n");
+  }
+  
   GECORunloopRunUntil(ourRunloop, expire);
   
   GECORunloopDestroy(ourRunloop);
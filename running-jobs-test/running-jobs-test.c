@@ -0,0 +1,142 @@
+/*
+ *  GECO — Grid Engine Cgroup Orchestrator
+ *  running-jobs-test.c
+ *
+ *  Standalone program that checks GECOResourceSetAreJobsRunningOnHost()
+ *  against a stand-in qstat:  a mix of live and stale job ids must never
+ *  cause a live job to be reported as not running.
+ *
+ *  Copyright © 2015
+ *  Dr. Jeffrey Frey, University of Delaware
+ *
+ *  $Id$
+ */
+
+#include "GECO.h"
+#include "GECOResource.h"
+
+//
+
+#define RUNNINGJOBSTEST_JOB_COUNT   6
+
+static const long int   runningjobstest_jobIds[RUNNINGJOBSTEST_JOB_COUNT] = { 900001, 900002, 900003, 900004, 900005, 900006 };
+static const long int   runningjobstest_taskIds[RUNNINGJOBSTEST_JOB_COUNT] = { 1, 1, 1, 1, 1, 1 };
+
+//
+// Odd job ids are running on this host, even ones are unknown to qstat.  With
+// any unknown id on the command line the stand-in answers the way qstat does,
+// with an unknown_jobs document; it names the unknown ids unless
+// RUNNINGJOBSTEST_ANONYMOUS is set in the environment:
+//
+static const char       *runningjobstest_qstatScript =
+                              "#!/bin/sh\n"
+                              "echo x >> \"$0.calls\"\n"
+                              "ids=$(echo \"$3\" | tr ',' ' ')\n"
+                              "stale=''\n"
+                              "for id in $ids; do [ $((id %% 2)) -eq 0 ] && stale=\"$stale $id\"; done\n"
+                              "echo \"<?xml version='1.0'?>\"\n"
+                              "if [ -n \"$stale\" ]; then\n"
+                              "  echo '<unknown_jobs>'\n"
+                              "  if [ -z \"$RUNNINGJOBSTEST_ANONYMOUS\" ]; then\n"
+                              "    for id in $stale; do echo \"<element><ST_name>$id</ST_name></element>\"; done\n"
+                              "  fi\n"
+                              "  echo '</unknown_jobs>'\n"
+                              "  exit 0\n"
+                              "fi\n"
+                              "echo '<detailed_job_info><djob_info>'\n"
+                              "for id in $ids; do\n"
+                              "  echo \"<element><JB_job_number>$id</JB_job_number><JB_ja_tasks><element><JAT_task_number>1</JAT_task_number>"
+                                      "<JAT_granted_destin_identifier_list><element><JG_qhostname>%s</JG_qhostname></element></JAT_granted_destin_identifier_list>"
+                                      "</element></JB_ja_tasks></element>\"\n"
+                              "done\n"
+                              "echo '</djob_info></detailed_job_info>'\n";
+
+//
+
+int
+runningjobstest_check(
+  const char      *label,
+  const char      *callsPath,
+  unsigned int    jobCount,
+  unsigned int    firstJob
+)
+{
+  bool            isRunning[RUNNINGJOBSTEST_JOB_COUNT];
+  unsigned int    i, runningCount, expectedCount = 0, callCount = 0;
+  int             rc = 0;
+  FILE            *callsFPtr;
+  
+  unlink(callsPath);
+  runningCount = GECOResourceSetAreJobsRunningOnHost(jobCount, runningjobstest_jobIds + firstJob, runningjobstest_taskIds + firstJob, isRunning, 0);
+  if ( (callsFPtr = fopen(callsPath, "r")) ) {
+    int           c;
+  
+    while ( (c = fgetc(callsFPtr)) != EOF ) if ( c == '\n' ) callCount++;
+    fclose(callsFPtr);
+  }
+  for ( i = 0; i < jobCount; i++ ) {
+    bool          shouldBeRunning = ( (runningjobstest_jobIds[firstJob + i] % 2) == 1 );
+  
+    if ( shouldBeRunning ) expectedCount++;
+    if ( isRunning[i] != shouldBeRunning ) {
+      fprintf(stderr, "ERROR:  %s:  %ld.%ld reported as%s running\n", label, runningjobstest_jobIds[firstJob + i], runningjobstest_taskIds[firstJob + i], ( isRunning[i] ? "" : " not" ));
+      rc = 1;
+    }
+  }
+  if ( runningCount != expectedCount ) {
+    fprintf(stderr, "ERROR:  %s:  %u jobs counted as running, expected %u\n", label, runningCount, expectedCount);
+    rc = 1;
+  }
+  printf("%-32s %u of %u running, %u qstat call%s  %s\n", label, runningCount, jobCount, callCount, ((callCount == 1) ? "" : "s"), ( rc ? "FAILED" : "ok" ));
+  return rc;
+}
+
+//
+
+int
+main(
+  int         argc,
+  char        **argv
+)
+{
+  char        workDir[] = "/tmp/running-jobs-test.XXXXXX";
+  char        qstatPath[PATH_MAX], callsPath[PATH_MAX], *searchPath;
+  const char  *oldPath = getenv("PATH");
+  FILE        *scriptFPtr;
+  int         rc = 0;
+  
+  if ( ! mkdtemp(workDir) ) {
+    fprintf(stderr, "ERROR:  unable to create work directory (errno = %d)\n", errno);
+    return 1;
+  }
+  snprintf(qstatPath, sizeof(qstatPath), "%s/qstat", workDir);
+  snprintf(callsPath, sizeof(callsPath), "%s/qstat.calls", workDir);
+  if ( ! (scriptFPtr = fopen(qstatPath, "w")) ) {
+    fprintf(stderr, "ERROR:  unable to create %s (errno = %d)\n", qstatPath, errno);
+    return 1;
+  }
+  fprintf(scriptFPtr, runningjobstest_qstatScript, GECOGetHostname());
+  fclose(scriptFPtr);
+  chmod(qstatPath, 0755);
+  
+  //
+  // The library runs "qstat" through the shell, so the stand-in just has to
+  // come first on the PATH:
+  //
+  if ( ! oldPath ) oldPath = "/usr/bin:/bin";
+  if ( ! (searchPath = malloc(strlen(workDir) + strlen(oldPath) + 2)) ) return ENOMEM;
+  sprintf(searchPath, "%s:%s", workDir, oldPath);
+  setenv("PATH", searchPath, 1);
+  free(searchPath);
+  
+  rc |= runningjobstest_check("single live", callsPath, 1, 0);
+  rc |= runningjobstest_check("single stale", callsPath, 1, 1);
+  rc |= runningjobstest_check("mixed live/stale", callsPath, RUNNINGJOBSTEST_JOB_COUNT, 0);
+  setenv("RUNNINGJOBSTEST_ANONYMOUS", "1", 1);
+  rc |= runningjobstest_check("mixed live/stale, unnamed", callsPath, RUNNINGJOBSTEST_JOB_COUNT, 0);
+  
+  unlink(callsPath);
+  unlink(qstatPath);
+  rmdir(workDir);
+  return rc;
+}